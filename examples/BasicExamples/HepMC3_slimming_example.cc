@@ -0,0 +1,81 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+/**
+ *  @example HepMC3_slimming_example.cc
+ *  @brief Test of particle filtering while reading
+ *
+ *  Reads HepMC3 file keeping only beams and final state particles, once
+ *  with a particle filter applied by the reader and once completely with
+ *  the event slimmed afterwards. Both give the same events.
+ *
+ */
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/ReaderAscii.h"
+#include "HepMC/EventSlimmer.h"
+#include "HepMC/EventFingerprint.h"
+
+#include <iostream>
+using namespace HepMC;
+using std::cout;
+using std::endl;
+
+/** Main program */
+int main(int argc, char **argv) {
+
+    if( argc<2 ) {
+        cout << "Usage: " << argv[0] << " <HepMC3_input_file>" << endl;
+        exit(-1);
+    }
+
+    ReadOptions options;
+    options.set_particle_filter( [](const GenParticleData &p) { return p.status == 1 || p.status == 4; } );
+
+    ReaderAscii filtered_file(argv[1]);
+    ReaderAscii input_file   (argv[1]);
+
+    filtered_file.set_read_options(options);
+
+    EventSlimmer slimmer( [](const GenParticlePtr &p) { return p->status() == 1 || p->status() == 4; } );
+
+    int events_parsed    = 0;
+    int events_different = 0;
+
+    while(!input_file.failed()) {
+        GenEvent evt(Units::GEV,Units::MM);
+        GenEvent filtered(Units::GEV,Units::MM);
+        GenEvent slimmed(Units::GEV,Units::MM);
+
+        // Read event from both files
+        input_file.read_event(evt);
+        filtered_file.read_event(filtered);
+
+        // If reading failed - exit loop
+        if( input_file.failed() || filtered_file.failed() ) break;
+
+        slimmer.slim(evt,slimmed);
+
+        if( EventFingerprint(filtered) != EventFingerprint(slimmed) ) {
+            cout << " Event " << evt.event_number() << " differs after filtering and slimming" << endl;
+            ++events_different;
+        }
+
+        ++events_parsed;
+        if( events_parsed%100 == 0 ) cout<<"Events parsed: "<<events_parsed<<endl;
+    }
+
+    if( input_file.failed() != filtered_file.failed() ) {
+        cout << " Files ended after different numbers of events" << endl;
+        ++events_different;
+    }
+
+    input_file.close();
+    filtered_file.close();
+
+    cout << " Events parsed: " << events_parsed << ", different: " << events_different << endl;
+
+    return events_different ? 1 : 0;
+}
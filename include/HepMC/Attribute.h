@@ -25,6 +25,8 @@
 #include <sstream>
 #include <iomanip>
 #include "HepMC/Common.h"
+#include "HepMC/Formatter.h"
+#include "HepMC/MemoryUsage.h"
 using std::string;
 
 namespace HepMC {
@@ -86,12 +88,21 @@ public:
     /** @brief Fill string from class content */
     virtual bool to_string(string &att) const = 0;
 
+    /** @brief Memory used by this attribute in bytes
+     *
+     *  Used by GenEvent::memory_usage(). Attributes holding memory
+     *  besides their fields should overload it
+     */
+    virtual size_t memory_usage() const {
+        return sizeof(Attribute) + string_memory(m_string);
+    }
+
 //
 // Accessors
 //
 public:
     /** @brief Check if this attribute is parsed */
-    bool is_parsed() { return m_is_parsed; }
+    bool is_parsed() const { return m_is_parsed; }
 
     /** @brief Get unparsed string */
     const string& unparsed_string() const { return m_string; }
@@ -148,6 +159,11 @@ public:
         return true;
     }
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief get the value associated to this Attribute. */
     int value() const {
 	return m_val;
@@ -199,6 +215,11 @@ public:
         return true;
     }
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief get the value associated to this Attribute. */
     long value() const {
 	return m_val;
@@ -242,13 +263,15 @@ public:
 
     /** @brief Implementation of Attribute::to_string */
     bool to_string(string &att) const {
-      std::ostringstream oss;
-      oss << std::setprecision(std::numeric_limits<double>::digits10)
-	  << m_val;
-      att = oss.str();
+      att = Formatter::to_string(m_val);
       return true;
     }
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief get the value associated to this Attribute. */
     double value() const {
 	return m_val;
@@ -298,6 +321,11 @@ public:
       return true;
     }
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief get the value associated to this Attribute. */
     float value() const {
 	return m_val;
@@ -349,6 +377,11 @@ public:
         return true;
     }
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief get the value associated to this Attribute. */
     string value() const {
 	return unparsed_string();
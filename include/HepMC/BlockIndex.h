@@ -0,0 +1,98 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_BLOCKINDEX_H
+#define HEPMC_BLOCKINDEX_H
+///
+/// @file  BlockIndex.h
+/// @brief Definition of class \b BlockIndex
+///
+/// @class HepMC::BlockIndex
+/// @brief Offsets of independently compressed blocks for random access
+///
+/// Files compressed in parallel consist of blocks which are compressed
+/// independently, e.g. gzip members. The index gives for each block its
+/// offset in the uncompressed data and in the compressed file, so that
+/// decompression can start at the block containing a position:
+///
+/// @code{.cpp}
+///     WriterAscii writer("events.hepmc.gz");
+///     writer.set_parallel_compression(4);
+///     writer.set_block_index_filename( BlockIndex::sidecar_filename("events.hepmc.gz") );
+///
+///     ReaderAscii reader("events.hepmc.gz");
+///     reader.load_block_index( BlockIndex::sidecar_filename("events.hepmc.gz") );
+///     reader.load_index( EventIndex::sidecar_filename("events.hepmc.gz") );
+///     reader.seek_event(100000);
+/// @endcode
+///
+/// Sidecar files are binary, little-endian, with 16 bytes per block.
+/// They store the size of the compressed file, so that readers can reject
+/// an index that does not belong to their input.
+///
+/// @ingroup IO
+///
+#include <string>
+#include <vector>
+#if !defined(__CINT__)
+#include <stdint.h>
+#endif
+
+namespace HepMC {
+
+class BlockIndex {
+public:
+
+    /// @brief Block of the compressed file
+    struct Entry {
+        uint64_t offset;            //!< Offset of the first byte of the block in the uncompressed data
+        uint64_t compressed_offset; //!< Offset of the block in the compressed file
+    };
+
+    /// @brief Default constructor creating empty index
+    BlockIndex(): m_file_size(0) {}
+
+    /// @brief Read index from sidecar file
+    bool read(const std::string &filename);
+
+    /// @brief Write index to sidecar file
+    bool write(const std::string &filename) const;
+
+    /// @brief Default name of the sidecar file of @a filename
+    static std::string sidecar_filename(const std::string &filename) { return filename + ".blocks"; }
+
+    /// @brief Add block, blocks have to be added in order of their offsets
+    void add(uint64_t offset, uint64_t compressed_offset);
+
+    /// @brief Remove all blocks
+    void clear();
+
+    /// @brief Size of the compressed file in bytes
+    uint64_t file_size() const { return m_file_size; }
+
+    /// @brief Set size of the compressed file in bytes
+    void set_file_size(uint64_t size) { m_file_size = size; }
+
+    /// @brief Number of blocks
+    size_t size() const { return m_entries.size(); }
+
+    /// @brief Check if there are no blocks
+    bool empty() const { return m_entries.empty(); }
+
+    /// @brief Block at position @a i in the file
+    const Entry& operator[](size_t i) const { return m_entries[i]; }
+
+    /// @brief Position of the block containing uncompressed @a offset, size() if there is none
+    size_t find(uint64_t offset) const;
+
+private:
+
+    uint64_t           m_file_size; //!< Size of the compressed file in bytes
+    std::vector<Entry> m_entries;   //!< Blocks in order of their offsets
+};
+
+} // namespace HepMC
+
+#endif
@@ -0,0 +1,118 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_CODEC_H
+#define HEPMC_CODEC_H
+///
+/// @file  Codec.h
+/// @brief Definition of classes \b Codec and \b CodecStream
+///
+/// @class HepMC::Codec
+/// @brief Compression format of input and output files
+///
+/// Codecs are registered by name. Input files are decompressed by the
+/// codec that recognizes their first bytes, output files are compressed
+/// by the codec selected by name or by the extension of the file name.
+/// gzip is registered when HepMC is built with zlib. Other formats are
+/// added by registering a subclass:
+///
+/// @code{.cpp}
+///     Codec::add( make_shared<MyCodec>() );
+///     WriterAscii writer("events.hepmc.my");
+/// @endcode
+///
+/// @see CompressedInputStream, CompressedOutputStream
+///
+/// @ingroup IO
+///
+#include "HepMC/Common.h"
+#include <string>
+#include <cstddef>
+
+namespace HepMC {
+
+/// @brief Compression or decompression of one stream in progress
+///
+/// Created by a Codec for each file, used by one thread at a time.
+///
+/// @ingroup IO
+class CodecStream {
+public:
+
+    /// @brief Destructor
+    virtual ~CodecStream() {}
+
+    /// @brief Process input, writing output
+    ///
+    /// Consumes input from [@a in, @a in_end) and writes output to
+    /// [@a out, @a out_end), moving @a in and @a out past the bytes
+    /// consumed and written. Input that is not consumed and output that
+    /// does not fit is kept for the next call.
+    ///
+    /// Decompressors continue with the next stream when one ends and more
+    /// input follows, so concatenated streams are decompressed as one.
+    ///
+    /// @param finish No more input follows, compressors write the end of the stream
+    /// @return false on invalid input or internal failure, see error()
+    virtual bool process(const char *&in, const char *in_end, char *&out, char *out_end, bool finish) = 0;
+
+    /// @brief Check if the end of a stream has been reached or written
+    ///
+    /// Input that ends while this is false is truncated.
+    virtual bool finished() const = 0;
+
+    /// @brief Description of the last failure
+    virtual std::string error() const = 0;
+};
+
+
+class Codec {
+public:
+
+    /// @brief Number of bytes at the start of a file passed to matches()
+    static const size_t magic_size = 8;
+
+    /// @brief Destructor
+    virtual ~Codec() {}
+
+    /// @brief Name of the codec, e.g. "gzip"
+    virtual std::string name() const = 0;
+
+    /// @brief Extension of file names, including the dot, e.g. ".gz"
+    virtual std::string extension() const = 0;
+
+    /// @brief Check if data starting with @a size bytes at @a data is compressed by this codec
+    ///
+    /// @a size is at most magic_size, and less for shorter files
+    virtual bool matches(const char *data, size_t size) const = 0;
+
+    /// @brief New compressor
+    ///
+    /// @param level Compression level of the codec, negative for its default
+    virtual CodecStream* make_compressor(int level) const = 0;
+
+    /// @brief New decompressor
+    virtual CodecStream* make_decompressor() const = 0;
+
+    /// @name Registry of codecs
+    //@{
+
+    /// @brief Register @a codec, replacing a registered codec with the same name
+    static void add(shared_ptr<Codec> codec);
+
+    /// @brief Codec named @a name, NULL if there is none
+    static shared_ptr<Codec> find(const std::string &name);
+
+    /// @brief Codec for the extension of @a filename, NULL if there is none
+    static shared_ptr<Codec> find_extension(const std::string &filename);
+
+    /// @brief Codec which recognizes @a size bytes at @a data, NULL if there is none
+    static shared_ptr<Codec> find_magic(const char *data, size_t size);
+    //@}
+};
+
+} // namespace HepMC
+
+#endif
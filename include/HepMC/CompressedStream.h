@@ -0,0 +1,178 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_COMPRESSEDSTREAM_H
+#define HEPMC_COMPRESSEDSTREAM_H
+///
+/// @file  CompressedStream.h
+/// @brief Definition of classes \b CompressedInputStream and \b CompressedOutputStream
+///
+/// File streams which decompress and compress transparently. They replace
+/// std::ifstream and std::ofstream in the readers and writers, so that
+/// compressed files can be used as plain ones:
+///
+/// @code{.cpp}
+///     WriterAscii writer("events.hepmc.gz"); // gzip selected by the extension
+///     ReaderAscii reader("events.hepmc.gz"); // gzip detected from the first bytes
+/// @endcode
+///
+/// @ingroup IO
+///
+#include "HepMC/Codec.h"
+#include "HepMC/BlockIndex.h"
+#include <string>
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+namespace HepMC {
+
+class DecompressingBuffer;
+class CompressingBuffer;
+
+
+/// @class HepMC::CompressedInputStream
+/// @brief Input file stream decompressing files recognized by a codec
+///
+/// Compressed files are decompressed on a background thread ahead of
+/// reading, which overlaps with parsing. Plain regular files are read as
+/// by std::ifstream, plain pipes and devices on the background thread.
+///
+/// Positions are offsets in the decompressed data. Seeking forward
+/// decompresses up to the position, seeking backward decompresses again
+/// from the start of the file, or with a block index from the start of
+/// the block containing the position. The end of compressed files is
+/// unknown, so seeking relative to it fails.
+///
+/// Invalid or truncated compressed data set badbit.
+///
+/// @ingroup IO
+class CompressedInputStream : public std::istream {
+public:
+
+    /// @brief Default constructor, no file is opened
+    CompressedInputStream();
+
+    /// @brief Constructor opening @a filename
+    explicit CompressedInputStream(const std::string &filename);
+
+    /// @brief Destructor
+    ~CompressedInputStream();
+
+    /// @brief Open @a filename, detecting its codec
+    ///
+    /// Sets failbit if the file cannot be opened
+    void open(const std::string &filename);
+
+    /// @brief Check if a file is open
+    bool is_open() const { return m_file.is_open(); }
+
+    /// @brief Close file
+    void close();
+
+    /// @brief Codec of the file, NULL if it is not compressed
+    shared_ptr<Codec> codec() const { return m_codec; }
+
+    /// @brief Use index of independently compressed blocks for seeking
+    ///
+    /// @return false if the file is not compressed, the index cannot be
+    ///         read or it does not belong to the file
+    /// @see BlockIndex
+    bool load_block_index(const std::string &filename);
+
+private:
+
+    CompressedInputStream(const CompressedInputStream&);            //!< Non-copyable
+    CompressedInputStream& operator=(const CompressedInputStream&); //!< Non-copyable
+
+    std::filebuf         m_file;         //!< Input file
+    DecompressingBuffer *m_decompressor; //!< Data read on the background thread, NULL if the file is read directly
+    shared_ptr<Codec>    m_codec;        //!< Codec of the file, NULL if it is not compressed
+    std::streamoff       m_file_size;    //!< Size of the file, -1 if unknown
+};
+
+
+/// @class HepMC::CompressedOutputStream
+/// @brief Output file stream compressing with a codec
+///
+/// The codec is selected by name or by the extension of the file name.
+/// Without a codec the file is written as by std::ofstream.
+///
+/// The compressed stream is complete when the file is closed, flushing
+/// only passes data which has been compressed so far to the file.
+/// tellp() gives the offset in the uncompressed data.
+///
+/// Data can be compressed on worker threads in blocks, which are
+/// compressed independently and written in order, see set_parallel().
+/// For gzip the blocks are members of the file, which is read by
+/// standard tools as one stream.
+///
+/// @ingroup IO
+class CompressedOutputStream : public std::ostream {
+public:
+
+    /// @brief Default constructor, no file is opened
+    CompressedOutputStream();
+
+    /// @brief Constructor opening @a filename
+    /// @see open()
+    explicit CompressedOutputStream(const std::string &filename, const std::string &codec = "", int level = -1);
+
+    /// @brief Destructor closing the file
+    ~CompressedOutputStream();
+
+    /// @brief Open @a filename for writing, truncating it
+    ///
+    /// Sets failbit if the file cannot be opened or the codec is unknown
+    ///
+    /// @param filename Output file
+    /// @param codec    Name of codec, empty to select it by the extension of @a filename, "none" for no compression
+    /// @param level    Compression level, negative for the default of the codec
+    void open(const std::string &filename, const std::string &codec = "", int level = -1);
+
+    /// @brief Check if a file is open
+    bool is_open() const { return m_file.is_open(); }
+
+    /// @brief Finish compressed stream and close file
+    ///
+    /// Sets badbit if writing fails
+    void close();
+
+    /// @brief Codec of the file, NULL if it is not compressed
+    shared_ptr<Codec> codec() const { return m_codec; }
+
+    /// @brief Compress blocks of data on worker threads
+    ///
+    /// Data is cut into blocks of @a block_size bytes, which are compressed
+    /// as independent streams on @a threads worker threads and written in
+    /// their original order. Has to be called before the first block is
+    /// compressed, i.e. before more than one block of data is written.
+    ///
+    /// @param threads    Number of worker threads, 0 to compress a single stream on the calling thread
+    /// @param block_size Size of uncompressed blocks in bytes, 0 for the default of 1 MiB
+    /// @return false if the file is not compressed or data has already been compressed
+    bool set_parallel(unsigned int threads, size_t block_size = 0);
+
+    /// @brief Write index of the compressed blocks to @a filename when closing
+    ///
+    /// Without worker threads the file is a single block.
+    /// @return false if the file is not compressed
+    /// @see BlockIndex
+    bool set_block_index_filename(const std::string &filename);
+
+private:
+
+    CompressedOutputStream(const CompressedOutputStream&);            //!< Non-copyable
+    CompressedOutputStream& operator=(const CompressedOutputStream&); //!< Non-copyable
+
+    std::filebuf       m_file;                 //!< Output file
+    CompressingBuffer *m_compressor;           //!< Data compressed before writing, NULL if the file is written directly
+    shared_ptr<Codec>  m_codec;                //!< Codec of the file, NULL if it is not compressed
+    std::string        m_block_index_filename; //!< File to write the block index to, empty if none
+};
+
+} // namespace HepMC
+
+#endif
@@ -0,0 +1,105 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_EVENTFINGERPRINT_H
+#define HEPMC_EVENTFINGERPRINT_H
+///
+/// @file  EventFingerprint.h
+/// @brief Definition of class \b EventFingerprint
+///
+/// @class HepMC::EventFingerprint
+/// @brief 128-bit hash of the content of an event
+///
+/// The fingerprint depends on the topology, on PDG IDs, status codes,
+/// momenta, masses and vertex positions, and optionally on weights and
+/// attributes. It does not depend on the order of particles and vertices,
+/// on their ids or on the event number, so events can be compared after
+/// conversion between formats, e.g. to validate round trips:
+///
+/// @code{.cpp}
+///     if( EventFingerprint(original) != EventFingerprint(converted) ) ...
+/// @endcode
+///
+/// Momenta and positions are converted to GEV and MM and rounded to
+/// a given number of significant bits of the mantissa. Default of 40 bits
+/// corresponds to about 12 decimal digits. Attributes are compared in their
+/// serialized form, attributes of particles and vertices as part of them.
+///
+/// Topology enters through each vertex, which is hashed together with the
+/// unordered sets of its incoming and outgoing particles. Computation takes
+/// linear time in the size of the event.
+///
+/// @note Values close to a rounding boundary may round differently after
+///       conversion of units, giving different fingerprints
+///
+/// @note Like any hash, the fingerprint can be equal for different events,
+///       although it is very unlikely
+///
+#include <string>
+#if !defined(__CINT__)
+#include <stdint.h>
+#include <functional>
+#endif
+
+namespace HepMC {
+
+class GenEvent;
+
+class EventFingerprint {
+public:
+
+    /// @brief Parts of the event included in the fingerprint besides the record
+    enum Content {
+        WEIGHTS    = 1, //!< Event weights
+        ATTRIBUTES = 2  //!< Attributes of the event, its particles and vertices
+    };
+
+    /// @brief Default constructor creating null fingerprint
+    EventFingerprint(): m_high(0), m_low(0) {}
+
+    /// @brief Compute fingerprint of @a evt
+    ///
+    /// @param evt       Event
+    /// @param precision Number of significant bits of momenta and positions, [1,52]
+    /// @param content   Combination of Content flags
+    explicit EventFingerprint(const GenEvent &evt, int precision = 40, int content = WEIGHTS | ATTRIBUTES);
+
+    /// @brief Upper 64 bits
+    uint64_t high() const { return m_high; }
+
+    /// @brief Lower 64 bits
+    uint64_t low()  const { return m_low;  }
+
+    /// @brief Fingerprint as 32 hexadecimal digits
+    std::string to_string() const;
+
+    /// @name Comparison operators
+    //@{
+    bool operator==(const EventFingerprint &rhs) const { return m_high == rhs.m_high && m_low == rhs.m_low; }
+    bool operator!=(const EventFingerprint &rhs) const { return !(*this == rhs); }
+    bool operator< (const EventFingerprint &rhs) const { return m_high < rhs.m_high || ( m_high == rhs.m_high && m_low < rhs.m_low ); }
+    //@}
+
+private:
+
+    uint64_t m_high; //!< Upper 64 bits
+    uint64_t m_low;  //!< Lower 64 bits
+};
+
+} // namespace HepMC
+
+#if !defined(__CINT__)
+namespace std {
+
+/// @brief Hash of EventFingerprint for unordered containers
+template<>
+struct hash<HepMC::EventFingerprint> {
+    size_t operator()(const HepMC::EventFingerprint &f) const { return f.low(); }
+};
+
+} // namespace std
+#endif
+
+#endif
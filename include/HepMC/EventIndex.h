@@ -0,0 +1,127 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_EVENTINDEX_H
+#define HEPMC_EVENTINDEX_H
+///
+/// @file  EventIndex.h
+/// @brief Definition of class \b EventIndex
+///
+/// @class HepMC::EventIndex
+/// @brief Byte offsets of events in text files for random access
+///
+/// The index gives for each event of a HepMC3, HepMC2 or Les Houches
+/// event file the offset of its first line, its event number and its
+/// numbers of particles and vertices. It is built in a single pass over
+/// the file, which only looks at the first characters of each line,
+/// or by WriterAscii while writing, and stored in a small sidecar file:
+///
+/// @code{.cpp}
+///     EventIndex index;
+///     if( index.build("events.hepmc") ) index.write( EventIndex::sidecar_filename("events.hepmc") );
+///
+///     ReaderAscii reader("events.hepmc");
+///     reader.load_index( EventIndex::sidecar_filename("events.hepmc") );
+///     reader.skip(100000);
+/// @endcode
+///
+/// Offsets in compressed files are those of the decompressed data.
+///
+/// Sidecar files are binary, little-endian, with 20 bytes per event.
+/// They store the size of the indexed file, so that readers can reject
+/// an index that does not belong to their input.
+///
+/// @ingroup IO
+///
+#include <string>
+#include <vector>
+#if !defined(__CINT__)
+#include <stdint.h>
+#endif
+
+namespace HepMC {
+
+class EventIndex {
+public:
+
+    /// @brief Format of the indexed file
+    enum Format {
+        UNKNOWN = 0, //!< Not determined
+        HEPMC3  = 1, //!< HepMC3 ASCII
+        HEPMC2  = 2, //!< HepMC2 IO_GenEvent
+        LHEF    = 3  //!< Les Houches Event File
+    };
+
+    /// @brief Event in the indexed file
+    struct Entry {
+        uint64_t offset;       //!< Byte offset of the first line of the event
+        int      event_number; //!< Event number, position in the file for LHEF
+        int      particles;    //!< Number of particles
+        int      vertices;     //!< Number of vertices, 0 for LHEF
+    };
+
+    /// @brief Default constructor creating empty index
+    EventIndex(): m_format(UNKNOWN), m_file_size(0), m_sorted(true) {}
+
+    /// @brief Build index of @a filename
+    ///
+    /// @return false if the file cannot be read or its format is unknown
+    bool build(const std::string &filename);
+
+    /// @brief Read index from sidecar file
+    bool read(const std::string &filename);
+
+    /// @brief Write index to sidecar file
+    bool write(const std::string &filename) const;
+
+    /// @brief Default name of the sidecar file of @a filename
+    static std::string sidecar_filename(const std::string &filename) { return filename + ".idx"; }
+
+    /// @brief Add event at @a offset, events have to be added in order of their offsets
+    void add(uint64_t offset, int event_number, int particles, int vertices);
+
+    /// @brief Remove all events
+    void clear();
+
+    /// @brief Format of the indexed file
+    Format format() const { return m_format; }
+
+    /// @brief Set format of the indexed file
+    void set_format(Format format) { m_format = format; }
+
+    /// @brief Size of the indexed file in bytes
+    uint64_t file_size() const { return m_file_size; }
+
+    /// @brief Set size of the indexed file in bytes
+    void set_file_size(uint64_t size) { m_file_size = size; }
+
+    /// @brief Number of events
+    size_t size() const { return m_entries.size(); }
+
+    /// @brief Check if there are no events
+    bool empty() const { return m_entries.empty(); }
+
+    /// @brief Event at position @a i in the file
+    const Entry& operator[](size_t i) const { return m_entries[i]; }
+
+    /// @brief Position of the first event with @a event_number, size() if there is none
+    ///
+    /// Takes logarithmic time if event numbers are increasing, linear otherwise
+    size_t find(int event_number) const;
+
+    /// @brief Position of the first event starting at or after @a offset, size() if there is none
+    size_t position(uint64_t offset) const;
+
+private:
+
+    Format             m_format;    //!< Format of the indexed file
+    uint64_t           m_file_size; //!< Size of the indexed file in bytes
+    std::vector<Entry> m_entries;   //!< Events in order of their offsets
+    bool               m_sorted;    //!< Are event numbers increasing?
+};
+
+} // namespace HepMC
+
+#endif
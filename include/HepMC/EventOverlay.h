@@ -0,0 +1,116 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_EVENTOVERLAY_H
+#define HEPMC_EVENTOVERLAY_H
+///
+/// @file  EventOverlay.h
+/// @brief Definition of class \b EventOverlay
+///
+/// @class HepMC::EventOverlay
+/// @brief Merging of several collisions into one event
+///
+/// Appends whole events, e.g. minimum-bias pile-up, to a target event. Each
+/// appended event forms a sub-collision: its particles and vertices are
+/// copied as contiguous blocks, so their ids are shifted by a single offset,
+/// and positions of its vertices are shifted in space and time while they
+/// are copied. Content of the target event present when the overlay is
+/// created is sub-collision 0.
+///
+/// @code{.cpp}
+///     EventOverlay overlay( signal );
+///
+///     // pile-up loop
+///     overlay.add( minbias, FourVector(0.0, 0.0, z, t) );
+///
+///     int collision = overlay.sub_collision( p );
+/// @endcode
+///
+/// Copying takes linear time in the size of the appended event. Input can
+/// also be given as GenEventData, avoiding construction of the intermediate
+/// GenEvent.
+///
+/// @note Event number, weights, run info, event attributes and HepMC2
+///       barcodes of the target event are kept. Those of the appended events
+///       are ignored.
+///
+/// @note Attributes of particles and vertices of appended events are shared
+///       with these events, not copied.
+///
+#include "HepMC/FourVector.h"
+#include "HepMC/Data/SmartPointer.h"
+
+#include <vector>
+
+namespace HepMC {
+
+class GenEvent;
+struct GenEventData;
+
+class EventOverlay {
+public:
+
+    /// @brief Constructor appending to @a event
+    explicit EventOverlay(GenEvent &event);
+
+    /// @brief Append copy of @a in shifted by @a shift
+    ///
+    /// @a shift is given in length units of the target event. Vertices
+    /// without position of their own are placed at the shifted position of
+    /// @a in if it differs from the position of the target event.
+    /// Returns index of the new sub-collision.
+    int add(const GenEvent &in, const FourVector &shift = FourVector::ZERO_VECTOR());
+
+    /// @brief Append content of @a in shifted by @a shift
+    ///
+    /// Same as add(const GenEvent&,const FourVector&). Attributes are
+    /// added in their serialized form, as in GenEvent::read_data().
+    int add(const GenEventData &in, const FourVector &shift = FourVector::ZERO_VECTOR());
+
+    /// @brief Remove content of the target event and all sub-collisions
+    void clear();
+
+    /// @brief Target event
+    GenEvent& event() { return *m_event; }
+
+    /// @brief Number of sub-collisions
+    int sub_collisions() const { return m_first_particle.size(); }
+
+    /// @brief Get sub-collision of a particle of the target event
+    ///
+    /// Takes logarithmic time in the number of sub-collisions.
+    /// Returns -1 for particles that are not part of any sub-collision
+    int sub_collision(const GenParticlePtr &p) const;
+
+    /// @brief Get sub-collision of a vertex of the target event
+    ///
+    /// Returns -1 for vertices that are not part of any sub-collision
+    int sub_collision(const GenVertexPtr &v) const;
+
+    /// @brief Id of the first particle of sub-collision @a i
+    int first_particle(int i) const { return m_first_particle.at(i); }
+
+    /// @brief Id of the first vertex of sub-collision @a i
+    int first_vertex(int i) const { return m_first_vertex.at(i); }
+
+private:
+
+    /// @brief Start new sub-collision at the end of the target event
+    int begin_block();
+
+    /// @brief Set positions of vertices of the new sub-collision without position
+    ///
+    /// Only vertices taking their position from the event are set,
+    /// the others follow the position of their ancestors
+    void place_vertices(int first_vertex, const FourVector &pos);
+
+    GenEvent         *m_event;          //!< Target event
+    std::vector<int>  m_first_particle; //!< Id of the first particle of each sub-collision
+    std::vector<int>  m_first_vertex;   //!< Id of the first vertex of each sub-collision
+};
+
+} // namespace HepMC
+
+#endif
@@ -0,0 +1,122 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_EVENTSLIMMER_H
+#define HEPMC_EVENTSLIMMER_H
+///
+/// @file  EventSlimmer.h
+/// @brief Definition of class \b EventSlimmer
+///
+/// @class HepMC::EventSlimmer
+/// @brief Reduction of the event record to selected particles
+///
+/// Copies particles accepted by a keep-predicate into a new event and
+/// collapses the rest of the record. Ancestry is rewired through removed
+/// particles: a vertex without kept incoming particles is merged with the
+/// production vertex of its first incoming particle, so kept particles are
+/// linked to their closest kept ancestors. Merged vertices take position,
+/// status and attributes of the most upstream of them. Vertices left without
+/// kept incoming particles are dropped and their kept outgoing particles are
+/// attached to the root vertex.
+///
+/// Kept particles are grouped by their production vertex, keeping their
+/// relative order, and vertices keep the original order. If the original
+/// event lists vertices before particles they produce, so does the slimmed one.
+/// Incoming particles of vertices keep their order, so that vertices without
+/// position inherit the same one as in the original event.
+///
+/// Slimming takes linear time in the number of particles and vertices.
+///
+/// @code{.cpp}
+///     EventSlimmer slimmer( IS_STABLE );
+///
+///     GenEvent slim;
+///     slimmer.slim( event, slim );
+/// @endcode
+///
+/// Any callable object can be used as a predicate, e.g. to keep final state,
+/// beams, hard process and W/Z bosons:
+///
+/// @code{.cpp}
+///     EventSlimmer slimmer( [](const GenParticlePtr &p) {
+///         return p->status() == 1 || p->status() == 4 || abs(p->status()) == 23 ||
+///                abs(p->pid()) == 23 || abs(p->pid()) == 24;
+///     } );
+/// @endcode
+///
+/// To slim events on output use WriterSlimmer.
+///
+/// @note If removed incoming particles of a vertex come from different
+///       vertices, only ancestry through the first of them is kept, as
+///       in GenVertex::position().
+///
+/// @note Attributes of the kept particles, vertices and of the event are
+///       shared with the original event, not copied.
+///
+#include "HepMC/Search/CompiledFilter.h"
+#include "HepMC/Data/SmartPointer.h"
+
+#include <vector>
+#if !defined(__CINT__)
+#include <functional>
+#endif
+
+namespace HepMC {
+
+class GenEvent;
+
+class EventSlimmer {
+public:
+
+#if !defined(__CINT__)
+    /// Keep-predicate type
+    typedef std::function<bool(const GenParticlePtr&)> Predicate;
+#endif
+
+    /// @brief Constructor keeping particles that pass all filters
+    explicit EventSlimmer(const FilterList &keep);
+
+    /// @brief Constructor keeping particles that pass precompiled filter
+    explicit EventSlimmer(const CompiledFilter &keep);
+
+#if !defined(__CINT__)
+    /// @brief Constructor keeping particles accepted by @a keep
+    explicit EventSlimmer(const Predicate &keep);
+#endif
+
+    /// @brief Fill @a out with the slimmed copy of @a in
+    ///
+    /// Previous content of @a out is cleared. Event number, units, position,
+    /// weights, run info and HepMC2 barcodes of kept particles and vertices
+    /// are copied as well.
+    void slim(const GenEvent &in, GenEvent &out);
+
+    /// @brief Check if particle is kept
+    bool keep(const GenParticlePtr &p) const;
+
+private:
+
+    /// @brief Find vertex representing vertex @a v after merging
+    unsigned int find(unsigned int v);
+
+    CompiledFilter m_filter;    //!< Precompiled keep-predicate
+#if !defined(__CINT__)
+    Predicate      m_predicate; //!< Generic keep-predicate used if set
+#endif
+
+    /// @name Buffers reused between events
+    //@{
+    std::vector<int>            m_particle_id; //!< New id of each particle, 0 if removed
+    std::vector<int>            m_vertex_id;   //!< New id of each merged vertex, 0 if dropped
+    std::vector<unsigned int>   m_parent;      //!< Upstream vertex each vertex is merged with
+    std::vector<int>            m_offset;      //!< Particle counts and offsets per production vertex
+    std::vector<GenParticlePtr> m_particles;   //!< Kept particles of the slimmed event
+    std::vector<GenVertexPtr>   m_vertices;    //!< Vertices of the slimmed event
+    //@}
+};
+
+} // namespace HepMC
+
+#endif
@@ -0,0 +1,63 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_FORMATTER_H
+#define HEPMC_FORMATTER_H
+///
+/// @file  Formatter.h
+/// @brief Definition of class \b Formatter
+///
+/// @class HepMC::Formatter
+/// @brief Conversion of numbers to text used by ASCII writers
+///
+/// By default doubles are written with the shortest decimal representation
+/// that is read back as exactly the same value, e.g. 0.1 instead of
+/// 1.0000000000000001e-01. Alternatively the number of significant digits
+/// can be limited, which gives shorter but inexact output.
+///
+/// Output does not depend on the locale. Plain notation is used if it is
+/// not longer than the exponential notation, so small integers are written
+/// without exponent and without decimal point.
+///
+/// @ingroup IO
+///
+#include <string>
+
+namespace HepMC {
+
+class Formatter {
+public:
+
+    /// @brief Maximum length of formatted double, including the terminating null character
+    static const int max_double_length = 25;
+
+    /// @brief Write @a value to @a buf as null-terminated text
+    ///
+    /// @param buf    Buffer of at least max_double_length characters
+    /// @param value  Value to be written
+    /// @param digits Maximum number of significant digits, 0 or 17 and more
+    ///               for the shortest exact representation
+    /// @return Number of characters written, not counting the null character
+    static int format_double(char *buf, double value, int digits = 0);
+
+    /// @brief Format @a value as string
+    ///
+    /// @see format_double()
+    static std::string to_string(double value, int digits = 0);
+
+    /// @brief Significant digits equivalent to @a precision of printf "%.*e"
+    ///
+    /// Precision of 16 and more is always exact, so it is translated to
+    /// 0, the shortest exact representation
+    static int precision_digits(int precision) {
+        if( precision >= 16 ) return 0;
+        if( precision < 0 )   return 1;
+        return precision + 1;
+    }
+};
+
+} // namespace HepMC
+
+#endif
@@ -54,6 +54,11 @@ public:
     /** @brief Implementation of Attribute::to_string */
     bool to_string(string &att) const;
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief Set all fields */
   void set_cross_section(const double& xs, const double& xs_err,const long& n_acc = -1, const long& n_att = -1) {
         cross_section       = xs;
@@ -19,6 +19,10 @@
 #include "HepMC/GenPdfInfo.h"
 #include "HepMC/GenCrossSection.h"
 #include "HepMC/GenRunInfo.h"
+#include "HepMC/MemoryUsage.h"
+#if !defined(__CINT__)
+#include <unordered_map>
+#endif
 #endif // __CINT__
 
 #ifdef HEPMC_ROOTIO
@@ -36,6 +40,8 @@ struct GenEventData;
 /// Contains lists of GenParticle and GenVertex objects
 class GenEvent {
 
+friend class EventOverlay;
+
 public:
 
     /// @brief Event constructor without a run
@@ -67,6 +73,90 @@ public:
     //@}
 
 
+    /// @name Particle indexes
+    ///
+    /// Indexes are built on first use and invalidated whenever particles are
+    /// added to or removed from the event or their PDG ID or status changes.
+    /// Particles are listed in order of their id.
+    ///
+    /// Returned lists are only valid until the event is next modified.
+    /// Removed particles are released from the lists by the next lookup.
+    ///
+    /// @note Call reset_indexes() after modifying the particle list directly
+    ///       through the non-const particles() accessor
+    /// @note Building an index modifies the event. Do not query the same
+    ///       event from several threads
+    //@{
+
+    /// @brief Get particles with given PDG ID
+    const std::vector<GenParticlePtr>& particles_with_pid(int pid) const;
+
+    /// @brief Get particles with given absolute value of PDG ID
+    std::vector<GenParticlePtr> particles_with_abs_pid(int abs_pid) const;
+
+    /// @brief Get particles with given status code
+    const std::vector<GenParticlePtr>& particles_with_status(int status) const;
+
+    /// @brief Invalidate particle indexes
+    ///
+    /// Lists are kept allocated and refilled by the next lookup
+    void reset_indexes() const { m_pid_index_valid = m_status_index_valid = false; }
+
+    //@}
+
+
+    /// @name HepMC2 barcodes
+    ///
+    /// Barcodes of particles and vertices kept for compatibility with HepMC2,
+    /// set by ReaderAsciiHepMC2 and written by WriterAsciiHepMC2. They are
+    /// stored as dense columns indexed by particle or vertex id and follow
+    /// the particles and vertices when others are removed from the event.
+    /// Barcode 0 means that no barcode is set.
+    ///
+    /// Lookup by barcode uses a hash index built on first use, so it takes
+    /// constant time. Barcodes are expected to be unique.
+    ///
+    /// @note Barcodes are not stored in GenEventData
+    //@{
+
+    /// @brief Get barcode of a particle of this event
+    int barcode(const GenParticlePtr &p) const;
+
+    /// @brief Get barcode of a vertex of this event
+    int barcode(const GenVertexPtr &v) const;
+
+    /// @brief Set barcode of a particle of this event
+    void set_barcode(const GenParticlePtr &p, int barcode);
+
+    /// @brief Set barcode of a vertex of this event
+    void set_barcode(const GenVertexPtr &v, int barcode);
+
+    /// @brief Find particle by barcode
+    ///
+    /// Returns empty pointer if no particle has this barcode
+    GenParticlePtr particle_by_barcode(int barcode) const;
+
+    /// @brief Find vertex by barcode
+    ///
+    /// Returns empty pointer if no vertex has this barcode
+    GenVertexPtr vertex_by_barcode(int barcode) const;
+
+    /// @brief Check if any barcode is set
+    bool has_barcodes() const { return !m_particle_barcodes.empty() || !m_vertex_barcodes.empty(); }
+
+    /// @brief Remove all barcodes
+    void clear_barcodes();
+
+    //@}
+
+private:
+
+    /// @brief Rebuild barcode lookup indexes if needed
+    void update_barcode_indexes() const;
+
+public:
+
+
     /// @name Event weights
     //@{
 
@@ -145,6 +235,13 @@ public:
     /// @brief Set cross-section information
     void set_cross_section(const GenCrossSectionPtr &cs) { add_attribute("GenCrossSection",cs); }
 
+    /// @brief Get memory used by the event
+    ///
+    /// Breakdown into particles, vertices, their links, event weights and
+    /// attributes by name. Run info is reported separately as it is shared
+    /// between events. Takes linear time in the size of the event.
+    MemoryUsage memory_usage() const;
+
     //@}
 
 
@@ -238,6 +335,59 @@ public:
     ///       will be ignored.
     void add_tree( const std::vector<GenParticlePtr> &particles );
 
+    /// @brief Replace the part of the event below particle @a p
+    ///
+    /// End vertex of @a p and all its descendants are replaced with the
+    /// content of @a subtree, whose first particle stands for @a p. Its end
+    /// vertex becomes the end vertex of @a p and its data (momentum, PDG ID,
+    /// status, mass) is copied to @a p. Other particles and vertices of
+    /// @a subtree, with their attributes and barcodes, are moved into this
+    /// event and @a subtree is cleared.
+    ///
+    /// New particles and vertices take ids of the replaced ones and extra
+    /// ones are appended. If fewer ids are needed, the last particles and
+    /// vertices of the event are moved to the freed ids. Ids of the rest
+    /// of the event do not change. Takes time proportional to the size of
+    /// the old and new subtrees.
+    ///
+    /// @note Descendants of @a p must not have other ancestors. Otherwise
+    ///       the event is left unchanged and false is returned.
+    ///
+    /// @note As when particles are added to vertices already in the event,
+    ///       particles are no longer guaranteed to follow their production
+    ///       vertices in the order of ids, which WriterAscii relies on.
+    ///       Use reorder() to restore it.
+    ///
+    /// @see Subtree
+    bool replace_subtree( const GenParticlePtr &p, GenEvent &subtree );
+
+    /// @brief Orders of particles and vertices (see reorder())
+    enum ReorderPolicy {
+        KEEP_ORDER,    //!< Order is not changed
+        BREADTH_FIRST, //!< Generation by generation from the beams
+        DEPTH_FIRST,   //!< Each decay chain in one piece
+        BY_STATUS      //!< Particles grouped by status, breadth-first within the group
+    };
+
+    /// @brief Reorder particles and vertices following @a policy
+    ///
+    /// Particles, vertices, their attributes and barcodes get new ids.
+    /// Particles without production vertex come first. With BREADTH_FIRST
+    /// and DEPTH_FIRST each vertex comes after all its incoming particles
+    /// and is followed by its outgoing particles, which is the order
+    /// WriterAscii relies on. Vertices that cannot be reached from the
+    /// beams keep their relative order at the end.
+    ///
+    /// Takes time proportional to the size of the event, BY_STATUS adds
+    /// sorting of particles by status.
+    void reorder( ReorderPolicy policy );
+
+    /// @brief Get order of particles and vertices given by @a policy
+    ///
+    /// Fills @a particles and @a vertices with current ids in the order
+    /// reorder() would give them, without modifying the event.
+    void reorder_ids( ReorderPolicy policy, std::vector<int> &particles, std::vector<int> &vertices ) const;
+
     /// @brief Reserve memory for particles and vertices
     ///
     /// Helps optimize event creation when size of the event is known beforehand
@@ -246,6 +396,12 @@ public:
     /// @brief Remove contents of this event
     void clear();
 
+    /// @brief Exchange contents of this event and @a other
+    ///
+    /// Particles and vertices are moved to the other event without copying,
+    /// taking time proportional to their number.
+    void swap(GenEvent &other);
+
     //@}
 
     /// @name Deprecated functionality
@@ -420,6 +576,26 @@ private:
     /// Keys are name and ID (0 = event, <0 = vertex, >0 = particle)
     mutable std::map< string, std::map<int, shared_ptr<Attribute> > > m_attributes;
 
+    /// Particles by PDG ID (see particles_with_pid())
+    mutable std::map< int, std::vector<GenParticlePtr> > m_pid_index;
+    /// Particles by status code (see particles_with_status())
+    mutable std::map< int, std::vector<GenParticlePtr> > m_status_index;
+    /// Check if PDG ID index is up to date
+    mutable bool m_pid_index_valid;
+    /// Check if status index is up to date
+    mutable bool m_status_index_valid;
+
+    /// HepMC2 barcodes of particles indexed by id-1 (see barcode())
+    std::vector<int> m_particle_barcodes;
+    /// HepMC2 barcodes of vertices indexed by -id-1 (see barcode())
+    std::vector<int> m_vertex_barcodes;
+    /// Particle id by barcode (see particle_by_barcode())
+    mutable std::unordered_map<int,int> m_particle_barcode_index;
+    /// Vertex id by barcode (see vertex_by_barcode())
+    mutable std::unordered_map<int,int> m_vertex_barcode_index;
+    /// Check if barcode indexes are up to date
+    mutable bool m_barcode_index_valid;
+
     /// @brief Attribute map key type
     typedef std::map< string, std::map<int, shared_ptr<Attribute> > >::value_type att_key_t;
 
@@ -74,6 +74,11 @@ public:
     /** @brief Implementation of Attribute::to_string */
     bool to_string(string &att) const;
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief Set all fields */
     void set( int nh, int np, int nt, int nc, int ns, int nsp,
               int nnw=0, int nwn=0, int nwnw=0,
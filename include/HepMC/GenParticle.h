@@ -16,6 +16,7 @@
 #include "HepMC/Data/SmartPointer.h"
 #include "HepMC/Data/GenParticleData.h"
 #include "HepMC/FourVector.h"
+#include "HepMC/PdgProperties.h"
 #include "HepMC/Common.h"
 
 namespace HepMC {
@@ -32,6 +33,11 @@ class GenParticle {
 friend class GenEvent;
 friend class GenVertex;
 friend class SmartPointer<GenParticle>;
+friend class FindParticles;
+friend class CompiledFilter;
+friend class EventSlimmer;
+friend class EventOverlay;
+friend class ReaderAscii;
 
 //
 // Constructors
@@ -43,6 +49,20 @@ public:
     /** @brief Constructor based on particle data */
     GenParticle( const GenParticleData &data );
 
+//
+// Enums
+//
+public:
+    /** @brief Bits of flags() not derived from the PDG ID
+     *
+     *  Lower bits of flags() hold PdgProperties::Property bits of pid()
+     */
+    enum Flag {
+        FLAG_FINAL_STATE    = 0x10000, //!< status() == 1
+        FLAG_BEAM           = 0x20000, //!< status() == 4
+        FLAG_HAS_END_VERTEX = 0x40000  //!< end_vertex() exists
+    };
+
 //
 // Functions
 //
@@ -92,6 +112,13 @@ public:
     /// If not set, it will return momentum().m()
     double generated_mass() const;
 
+    /// @brief Get bitfield of particle flags
+    ///
+    /// Combination of PdgProperties::Property bits of pid() and Flag bits.
+    /// All bits except FLAG_HAS_END_VERTEX are precomputed when pid or status
+    /// is set, so that each property can be tested with a single AND-mask.
+    unsigned int flags() const { return m_end_vertex.expired() ? m_flags : ( m_flags | FLAG_HAS_END_VERTEX ); }
+
 
     void set_pid(int pid);                         //!< Set PDG ID
     void set_status(int status);                   //!< Set status code
@@ -141,15 +168,44 @@ public:
 
     //@}
 //
+// Helpers
+//
+private:
+    /** @brief Flag bits derived from status code */
+    static unsigned int status_flags(int status) {
+        return ( status == 1 ? (unsigned int)FLAG_FINAL_STATE : 0u ) | ( status == 4 ? (unsigned int)FLAG_BEAM : 0u );
+    }
+
+    /** @brief Set production vertex link */
+    void set_production_vertex(const shared_ptr<GenVertex> &v) { m_production_vertex = v; m_production_vertex_ptr = v.get(); }
+
+    /** @brief Set end vertex link */
+    void set_end_vertex(const shared_ptr<GenVertex> &v) { m_end_vertex = v; m_end_vertex_ptr = v.get(); }
+
+    /** @brief Get production vertex without taking a reference
+     *
+     *  Used by graph traversals of the search engine. Returns NULL
+     *  if the vertex does not exist.
+     */
+    const GenVertex* production_vertex_ptr() const { return m_production_vertex.expired() ? NULL : m_production_vertex_ptr; }
+
+    /** @brief Get end vertex without taking a reference
+     *  @see production_vertex_ptr()
+     */
+    const GenVertex* end_vertex_ptr() const { return m_end_vertex.expired() ? NULL : m_end_vertex_ptr; }
+//
 // Fields
 //
 private:
     GenEvent        *m_event; //!< Parent event
     int              m_id;    //!< Index
     GenParticleData  m_data;  //!< Particle data
+    unsigned int     m_flags; //!< Precomputed flags derived from pid and status
 
     weak_ptr<GenVertex>    m_production_vertex; //!< Production vertex
     weak_ptr<GenVertex>    m_end_vertex;        //!< End vertex
+    GenVertex             *m_production_vertex_ptr; //!< Production vertex, valid while m_production_vertex is not expired
+    GenVertex             *m_end_vertex_ptr;        //!< End vertex, valid while m_end_vertex is not expired
     weak_ptr<GenParticle>  m_this;              //!< Pointer to shared pointer managing this particle
 };
 
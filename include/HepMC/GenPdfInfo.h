@@ -51,6 +51,11 @@ public:
     /** @brief Implementation of Attribute::to_string */
     bool to_string(string &att) const;
 
+    /** @brief Implementation of Attribute::memory_usage */
+    size_t memory_usage() const {
+        return sizeof(*this) + string_memory(unparsed_string());
+    }
+
     /** @brief Set all fields */
     void set( int parton_id1, int parton_id2, double x1, double x2,
               double scale_in, double xf1, double xf2,
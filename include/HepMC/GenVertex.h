@@ -37,6 +37,9 @@ namespace HepMC {
         /// @todo Are these really needed? Friends usually indicate a problem...
         friend class GenEvent;
         friend class SmartPointer<GenVertex>;
+        friend class EventSlimmer;
+        friend class EventOverlay;
+        friend class ReaderAscii;
 
 
     public:
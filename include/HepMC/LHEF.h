@@ -24,6 +24,8 @@
 #include <cmath>
 #include <limits>
 
+#include "HepMC/CompressedStream.h"
+
 namespace LHEF {
 
 /**
@@ -2627,9 +2629,9 @@ protected:
 
   /**
    * A local stream which is unused if a stream is supplied from the
-   * outside.
+   * outside. Compressed files are decompressed transparently.
    */
-  std::ifstream intstream;
+  HepMC::CompressedInputStream intstream;
 
   /**
    * The stream we are reading from. This may be a reference to an
@@ -2811,9 +2813,10 @@ protected:
 
   /**
    * A local stream which is unused if a stream is supplied from the
-   * outside.
+   * outside. It is compressed by the codec selected by the extension of
+   * the file name.
    */
-  std::ofstream intstream;
+  HepMC::CompressedOutputStream intstream;
 
   /**
    * The stream we are writing to. This may be a reference to an
@@ -0,0 +1,111 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_MEMORYUSAGE_H
+#define HEPMC_MEMORYUSAGE_H
+///
+/// @file  MemoryUsage.h
+/// @brief Definition of struct \b MemoryUsage and class \b MemoryUsageSummary
+///
+/// @struct HepMC::MemoryUsage
+/// @brief Memory used by the parts of an event, in bytes
+///
+/// Filled by GenEvent::memory_usage(). Sizes include the objects, the
+/// control blocks of their shared pointers and the memory allocated by
+/// their containers and strings. Overhead of the heap allocator itself is
+/// not included, so the numbers are lower bounds.
+///
+/// @note Attributes shared with other events (e.g. by EventSlimmer) are
+///       counted in full in each event
+///
+#include <cstddef>
+#include <string>
+#include <map>
+#include <iostream>
+
+namespace HepMC {
+
+/// @brief Heap memory allocated by string @a s, 0 if it fits in the string object
+inline size_t string_memory(const std::string &s) {
+    const char *data = s.data();
+    const char *self = reinterpret_cast<const char*>(&s);
+
+    if( data >= self && data < self + sizeof(s) ) return 0;
+
+    return s.capacity() + 1;
+}
+
+struct MemoryUsage {
+
+    /// @brief Default constructor with all sizes set to 0
+    MemoryUsage(): particles(0), vertices(0), links(0), event(0), weights(0), run_info(0) {}
+
+    size_t particles; //!< Particles
+    size_t vertices;  //!< Vertices, including the root vertex
+    size_t links;     //!< Lists of incoming and outgoing particles of vertices
+    size_t event;     //!< Event object, its particle and vertex lists, particle indexes and barcodes
+    size_t weights;   //!< Event weights
+    std::map<std::string, size_t> attributes; //!< Attributes by name, including their maps
+
+    /// @brief Run info, shared between events of a run and not included in total()
+    size_t run_info;
+
+    /// @brief Memory used by all attributes
+    size_t attributes_total() const;
+
+    /// @brief Memory used by the event, not counting run info
+    size_t total() const { return particles + vertices + links + event + weights + attributes_total(); }
+
+    /// @brief Add sizes of @a rhs
+    MemoryUsage& operator+=(const MemoryUsage &rhs);
+
+    /// @brief Print breakdown
+    void print(std::ostream &os = std::cout) const;
+};
+
+
+/// @class HepMC::MemoryUsageSummary
+/// @brief Memory usage statistics of a number of events
+///
+/// Collected by readers when enabled with Reader::set_memory_accounting().
+class MemoryUsageSummary {
+public:
+
+    /// @brief Default constructor
+    MemoryUsageSummary(): m_events(0), m_max_total(0) {}
+
+    /// @brief Add memory usage of one event
+    void add(const MemoryUsage &usage);
+
+    /// @brief Remove all statistics
+    void clear();
+
+    /// @brief Number of events
+    unsigned long events() const { return m_events; }
+
+    /// @brief Memory usage summed over all events
+    const MemoryUsage& sum() const { return m_sum; }
+
+    /// @brief Memory usage averaged over events
+    ///
+    /// Run info is that of the last event
+    MemoryUsage mean() const;
+
+    /// @brief Largest total memory used by an event
+    size_t max_total() const { return m_max_total; }
+
+    /// @brief Print summary
+    void print(std::ostream &os = std::cout) const;
+
+private:
+
+    unsigned long m_events;    //!< Number of events
+    MemoryUsage   m_sum;       //!< Memory usage summed over all events
+    size_t        m_max_total; //!< Largest total memory used by an event
+};
+
+} // namespace HepMC
+
+#endif
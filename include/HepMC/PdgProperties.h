@@ -0,0 +1,188 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_PDGPROPERTIES_H
+#define HEPMC_PDGPROPERTIES_H
+/**
+ *  @file PdgProperties.h
+ *  @brief Definition of \b class PdgProperties
+ *
+ *  @class HepMC::PdgProperties
+ *  @brief Compile-time decoding of PDG particle ID
+ *
+ *  Properties are derived from the digits of the PDG numbering scheme
+ *  (n nr nL nq1 nq2 nq3 nJ) and from the table of charges of fundamental
+ *  particles. All functions are constexpr and can be used in constant
+ *  expressions, e.g.
+ *
+ *  @code{.cpp}
+ *      static_assert( PdgProperties::three_charge(-521) == -3, "B- charge" );
+ *      static_assert( PdgProperties::has_bottom(5122),         "Lambda_b"  );
+ *  @endcode
+ *
+ *  The most common properties are packed into a bitfield returned by
+ *  properties(). The same bits are stored in HepMC::GenParticle::flags().
+ *
+ */
+
+namespace HepMC {
+
+
+class PdgProperties {
+//
+// Enums
+//
+public:
+    /** @brief Bits of the bitfield returned by properties() */
+    enum Property {
+        CHARGED     = 0x0001, //!< Non-zero electric charge
+        QUARK       = 0x0002, //!< Quark
+        LEPTON      = 0x0004, //!< Lepton (including neutrinos)
+        NEUTRINO    = 0x0008, //!< Neutrino
+        MESON       = 0x0010, //!< Meson
+        BARYON      = 0x0020, //!< Baryon
+        HADRON      = 0x0040, //!< Meson or baryon
+        NUCLEUS     = 0x0080, //!< Nucleus (10LZZZAAAI code)
+        HAS_STRANGE = 0x0100, //!< Strange quark or hadron containing one
+        HAS_CHARM   = 0x0200, //!< Charm quark or hadron containing one
+        HAS_BOTTOM  = 0x0400, //!< Bottom quark or hadron containing one
+        HAS_TOP     = 0x0800  //!< Top quark or hadron containing one
+    };
+
+//
+// Functions
+//
+public:
+    /** @brief Three times the electric charge */
+    static constexpr int three_charge(int pid) {
+        return sign(pid) * unsigned_three_charge(pid);
+    }
+
+    /** @brief Electric charge */
+    static constexpr double charge(int pid) { return three_charge(pid) / 3.0; }
+
+    /** @brief Check if particle has non-zero electric charge */
+    static constexpr bool is_charged(int pid) { return three_charge(pid) != 0; }
+
+    /** @brief Check if particle is a quark */
+    static constexpr bool is_quark(int pid) { return abs_pid(pid) >= 1 && abs_pid(pid) <= 8; }
+
+    /** @brief Check if particle is a lepton */
+    static constexpr bool is_lepton(int pid) { return abs_pid(pid) >= 11 && abs_pid(pid) <= 18; }
+
+    /** @brief Check if particle is a neutrino */
+    static constexpr bool is_neutrino(int pid) { return is_lepton(pid) && abs_pid(pid) % 2 == 0; }
+
+    /** @brief Check if particle is a meson */
+    static constexpr bool is_meson(int pid) {
+        return abs_pid(pid) == 130 || abs_pid(pid) == 310 || abs_pid(pid) == 210 ||
+               ( is_composite(pid) && nq1(pid) == 0 && nq2(pid) != 0 && nq3(pid) != 0 &&
+                 !( nq2(pid) == nq3(pid) && pid < 0 ) );
+    }
+
+    /** @brief Check if particle is a baryon */
+    static constexpr bool is_baryon(int pid) {
+        return abs_pid(pid) == 2110 || abs_pid(pid) == 2210 ||
+               ( is_composite(pid) && nq1(pid) != 0 && nq2(pid) != 0 && nq3(pid) != 0 );
+    }
+
+    /** @brief Check if particle is a hadron */
+    static constexpr bool is_hadron(int pid) { return is_meson(pid) || is_baryon(pid); }
+
+    /** @brief Check if particle is a nucleus */
+    static constexpr bool is_nucleus(int pid) {
+        return abs_pid(pid) / 1000000000 == 1 && nucleus_a(pid) >= nucleus_z(pid);
+    }
+
+    /** @brief Check if particle is quark @a q or a hadron containing one */
+    static constexpr bool has_quark(int pid, int q) {
+        return abs_pid(pid) == q ||
+               ( is_hadron(pid) && ( nq1(pid) == q || nq2(pid) == q || nq3(pid) == q ) );
+    }
+
+    static constexpr bool has_strange(int pid) { return has_quark(pid,3); } //!< Check if particle has strange content
+    static constexpr bool has_charm  (int pid) { return has_quark(pid,4); } //!< Check if particle has charm content
+    static constexpr bool has_bottom (int pid) { return has_quark(pid,5); } //!< Check if particle has bottom content
+    static constexpr bool has_top    (int pid) { return has_quark(pid,6); } //!< Check if particle has top content
+
+    /** @brief Bitfield of properties of the particle
+     *
+     *  @see Property
+     */
+    static constexpr unsigned int properties(int pid) {
+        return bit( is_charged(pid),  CHARGED     ) |
+               bit( is_quark(pid),    QUARK       ) |
+               bit( is_lepton(pid),   LEPTON      ) |
+               bit( is_neutrino(pid), NEUTRINO    ) |
+               bit( is_meson(pid),    MESON       ) |
+               bit( is_baryon(pid),   BARYON      ) |
+               bit( is_hadron(pid),   HADRON      ) |
+               bit( is_nucleus(pid),  NUCLEUS     ) |
+               bit( has_strange(pid), HAS_STRANGE ) |
+               bit( has_charm(pid),   HAS_CHARM   ) |
+               bit( has_bottom(pid),  HAS_BOTTOM  ) |
+               bit( has_top(pid),     HAS_TOP     );
+    }
+
+//
+// Helpers
+//
+private:
+    static constexpr int abs_pid(int pid) { return pid < 0 ? -pid : pid; } //!< Absolute value of PDG ID
+    static constexpr int sign   (int pid) { return pid < 0 ? -1   : 1;    } //!< Sign of PDG ID
+
+    /** @brief Property bit @a p if @a set is true, 0 otherwise */
+    static constexpr unsigned int bit(bool set, Property p) { return set ? (unsigned int)p : 0u; }
+
+    /** @brief Digit @a n of PDG ID, counting from 1 for the last digit */
+    static constexpr int digit(int pid, int n) { return n <= 1 ? abs_pid(pid) % 10 : digit(abs_pid(pid) / 10, n - 1); }
+
+    static constexpr int nj (int pid) { return digit(pid,1); } //!< Spin digit
+    static constexpr int nq3(int pid) { return digit(pid,2); } //!< Third quark digit
+    static constexpr int nq2(int pid) { return digit(pid,3); } //!< Second quark digit
+    static constexpr int nq1(int pid) { return digit(pid,4); } //!< First quark digit
+
+    /** @brief Digits beyond the standard seven-digit scheme */
+    static constexpr int extra_bits(int pid) { return abs_pid(pid) / 10000000; }
+
+    /** @brief ID of fundamental particle or 0 for composite particles */
+    static constexpr int fundamental_id(int pid) {
+        return ( extra_bits(pid) == 0 && nq1(pid) == 0 && nq2(pid) == 0 ) ? abs_pid(pid) % 10000 : 0;
+    }
+
+    /** @brief Check if PDG ID follows the quark-content scheme */
+    static constexpr bool is_composite(int pid) {
+        return abs_pid(pid) > 100 && extra_bits(pid) == 0 && fundamental_id(pid) == 0 && nj(pid) > 0;
+    }
+
+    static constexpr int nucleus_z(int pid) { return ( abs_pid(pid) / 10000 ) % 1000; } //!< Number of protons
+    static constexpr int nucleus_a(int pid) { return ( abs_pid(pid) / 10    ) % 1000; } //!< Number of nucleons
+
+    /** @brief Three times the charge of quark @a q */
+    static constexpr int quark_three_charge(int q) { return q == 0 ? 0 : ( q % 2 ? -1 : 2 ); }
+
+    /** @brief Three times the charge of fundamental particle @a id (positive PDG ID) */
+    static constexpr int fundamental_three_charge(int id) {
+        return ( id >= 1  && id <= 8  ) ? quark_three_charge(id) :
+               ( id >= 11 && id <= 18 ) ? ( id % 2 ? -3 : 0 )    :
+               ( id == 24 || id == 34 || id == 37 ) ? 3 : 0;
+    }
+
+    /** @brief Three times the charge of particle with positive PDG ID */
+    static constexpr int unsigned_three_charge(int pid) {
+        return extra_bits(pid) > 0                           ? ( is_nucleus(pid) ? 3 * nucleus_z(pid) : 0 ) :
+               fundamental_id(pid) > 0                       ? fundamental_three_charge( fundamental_id(pid) ) :
+               nj(pid) == 0                                  ? 0 :
+               // Meson: s and b mesons contain the heavier quark as antiquark
+               nq1(pid) == 0 && ( nq2(pid) == 3 || nq2(pid) == 5 ) ? quark_three_charge(nq3(pid)) - quark_three_charge(nq2(pid)) :
+               nq1(pid) == 0                                 ? quark_three_charge(nq2(pid)) - quark_three_charge(nq3(pid)) :
+               // Diquark and baryon
+               quark_three_charge(nq1(pid)) + quark_three_charge(nq2(pid)) + quark_three_charge(nq3(pid));
+    }
+};
+
+} // namespace HepMC
+
+#endif
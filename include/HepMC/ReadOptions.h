@@ -0,0 +1,114 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_READOPTIONS_H
+#define HEPMC_READOPTIONS_H
+///
+/// @file  ReadOptions.h
+/// @brief Definition of class \b ReadOptions
+///
+/// @class HepMC::ReadOptions
+/// @brief Selection of the event content kept by readers
+///
+/// Readers skip attributes that are not kept without unescaping them,
+/// and particles rejected by the particle filter without building them.
+/// The topology of kept particles is collapsed as by EventSlimmer, so
+/// kept particles are linked to their closest kept ancestors:
+///
+/// @code{.cpp}
+///     ReadOptions options;
+///     options.keep_attribute("GenHeavyIon");
+///     options.set_keep_weights(false);
+///     options.set_particle_filter( [](const GenParticleData &p) { return p.status == 1 || p.status == 4; } );
+///
+///     ReaderAscii reader("events.hepmc");
+///     reader.set_read_options(options);
+/// @endcode
+///
+/// The filter sees only the data of the particle line, as ancestry is not
+/// known yet while parsing. Run attributes and weight names are always kept.
+///
+/// ReaderAscii applies the options while parsing. Other readers apply them
+/// to events after reading, which gives the same content at no saving.
+///
+/// @ingroup IO
+///
+#include "HepMC/Data/GenParticleData.h"
+
+#include <set>
+#include <string>
+#if !defined(__CINT__)
+#include <functional>
+#endif
+
+namespace HepMC {
+
+class ReadOptions {
+public:
+
+#if !defined(__CINT__)
+    /// Particle filter type
+    typedef std::function<bool(const GenParticleData&)> ParticleFilter;
+#endif
+
+    /// @brief Default constructor keeping all content
+    ReadOptions(): m_all_attributes(true), m_keep_weights(true) {}
+
+    /// @brief Keep attributes named @a name
+    ///
+    /// Once called, attributes of events, particles and vertices
+    /// with other names are skipped
+    void keep_attribute(const std::string &name) {
+        m_all_attributes = false;
+        m_attributes.insert(name);
+    }
+
+    /// @brief Skip all attributes of events, particles and vertices
+    void drop_attributes() {
+        m_all_attributes = false;
+        m_attributes.clear();
+    }
+
+    /// @brief Check if attributes named @a name are kept
+    bool keeps_attribute(const std::string &name) const {
+        return m_all_attributes || m_attributes.count(name);
+    }
+
+    /// @brief Check if all attributes are kept
+    bool keeps_all_attributes() const { return m_all_attributes; }
+
+    /// @brief Keep or skip event weights
+    void set_keep_weights(bool keep) { m_keep_weights = keep; }
+
+    /// @brief Check if event weights are kept
+    bool keeps_weights() const { return m_keep_weights; }
+
+#if !defined(__CINT__)
+    /// @brief Keep only particles accepted by @a filter, empty filter keeps all
+    void set_particle_filter(const ParticleFilter &filter) { m_particle_filter = filter; }
+
+    /// @brief Particle filter, empty if all particles are kept
+    const ParticleFilter& particle_filter() const { return m_particle_filter; }
+
+    /// @brief Check if particles are filtered
+    bool has_particle_filter() const { return (bool)m_particle_filter; }
+
+    /// @brief Check if all content is kept
+    bool keeps_all() const { return m_all_attributes && m_keep_weights && !m_particle_filter; }
+#endif
+
+private:
+
+    bool                  m_all_attributes;  //!< Are all attributes kept?
+    std::set<std::string> m_attributes;      //!< Names of kept attributes
+    bool                  m_keep_weights;    //!< Are event weights kept?
+#if !defined(__CINT__)
+    ParticleFilter        m_particle_filter; //!< Particle filter, empty if all particles are kept
+#endif
+};
+
+} // namespace HepMC
+
+#endif
@@ -16,15 +16,19 @@
 ///
 
 #include "HepMC/GenRunInfo.h"
+#include "HepMC/GenEvent.h"
+#include "HepMC/MemoryUsage.h"
+#include "HepMC/EventIndex.h"
+#include "HepMC/ReadOptions.h"
 
 namespace HepMC {
 
-  // Forward declaration
-  class GenEvent;
-
   class Reader {
   public:
 
+    /// Default constructor
+    Reader(): m_memory_accounting(false) {}
+
     /// Virtual destructor
     virtual ~Reader() {}
 
@@ -33,11 +37,71 @@ namespace HepMC {
     virtual bool failed()=0;
     virtual void close()=0;
 
+    /// @brief Skip @a n events
+    ///
+    /// Reads the events by default. Readers override it with faster
+    /// ways that do not build the events.
+    /// @return false if the input ends before or reading fails
+    virtual bool skip(int n) {
+      GenEvent evt;
+      for ( int i = 0; i < n; ++i ) {
+        if ( !read_event(evt) || failed() ) return false;
+      }
+      return true;
+    }
+
+    /// @brief Read number and counts of the next event without building it
+    ///
+    /// Allows counting events and particles at close to the speed of
+    /// reading the input:
+    /// @code{.cpp}
+    ///     EventIndex::Entry header;
+    ///     while( reader.scan_event(header) ) particles += header.particles;
+    /// @endcode
+    /// Reads the event by default. The offset is 0 unless the reader
+    /// knows positions in its input.
+    /// @return false at the end of the input or if reading fails
+    virtual bool scan_event(EventIndex::Entry &header) {
+      GenEvent evt;
+      if ( !read_event(evt) || failed() ) return false;
+
+      header.offset       = 0;
+      header.event_number = evt.event_number();
+      header.particles    = evt.particles().size();
+      header.vertices     = evt.vertices().size();
+      return true;
+    }
+
     /// Get the global GenRunInfo object.
     shared_ptr<GenRunInfo> run_info() const {
       return m_run_info;
     }
 
+    /// @brief Enable or disable memory accounting
+    ///
+    /// When enabled, memory used by each event read is added to
+    /// memory_summary(). Takes linear time in the size of the event.
+    void set_memory_accounting(bool enable) {
+      m_memory_accounting = enable;
+    }
+
+    /// Get memory usage statistics of events read since accounting was enabled
+    const MemoryUsageSummary& memory_summary() const {
+      return m_memory_summary;
+    }
+
+    /// @brief Set content of events kept by the reader
+    ///
+    /// Has to be called before the first event is read
+    void set_read_options(const ReadOptions &options) {
+      m_read_options = options;
+    }
+
+    /// Get content of events kept by the reader
+    const ReadOptions& read_options() const {
+      return m_read_options;
+    }
+
   protected:
 
     /// Set the global GenRunInfo object.
@@ -45,11 +109,32 @@ namespace HepMC {
       m_run_info = run;
     }
 
+    /// @brief Add memory used by @a evt to the summary, if accounting is enabled
+    ///
+    /// Empty events returned at the end of input are not counted
+    void account_memory(const GenEvent &evt) {
+      if ( m_memory_accounting && !failed() ) m_memory_summary.add( evt.memory_usage() );
+    }
+
+    /// @brief Remove content of @a evt not kept by the read options
+    ///
+    /// Used by readers that cannot skip the content while parsing
+    void apply_read_options(GenEvent &evt) const;
+
   private:
 
     /// The global GenRunInfo object.
     shared_ptr<GenRunInfo> m_run_info;
 
+    /// Is memory accounting enabled?
+    bool m_memory_accounting;
+
+    /// Memory usage statistics of events read
+    MemoryUsageSummary m_memory_summary;
+
+    /// Content of events kept by the reader
+    ReadOptions m_read_options;
+
   };
 
 
@@ -12,10 +12,27 @@
 /// @class HepMC::ReaderAscii
 /// @brief GenEvent I/O parsing for structured text files
 ///
+/// Regular files are mapped into memory and parsed in place, without
+/// copying lines. Pipes, devices and input streams are read line by line.
+/// Compressed files are recognized by their first bytes and decompressed
+/// on a background thread, see CompressedInputStream.
+///
+/// Events of mapped files can be parsed ahead on worker threads, see
+/// set_parallel().
+///
+/// With an index of the input events can be accessed in any order,
+/// see load_index() and seek_event().
+///
+/// Read options are applied while parsing: attributes that are not kept
+/// are not unescaped and particles rejected by the filter are not built.
+/// @see ReadOptions
+///
 /// @ingroup IO
 ///
 #include "HepMC/Reader.h"
 #include "HepMC/GenEvent.h"
+#include "HepMC/EventIndex.h"
+#include "HepMC/CompressedStream.h"
 #include <string>
 #include <fstream>
 #include <istream>
@@ -27,8 +44,12 @@ class ReaderAscii : public Reader {
 public:
 
     /// @brief Constructor
-    /// @warning If file already exists, it will be cleared before writing
-    ReaderAscii(const std::string& filename);
+    ///
+    /// @param filename Input file
+    /// @param map_file Map regular file into memory. Files that cannot be
+    ///                 mapped, do not end with a new line or are compressed
+    ///                 are read as stream
+    ReaderAscii(const std::string& filename, bool map_file = true);
 
     /// The ctor to read from stdin
     ReaderAscii(std::istream &);
@@ -42,11 +63,76 @@ public:
     bool read_event(GenEvent& evt);
 
     /// @brief Return status of the stream
-    bool failed() { return m_isstream ? (bool)m_stream->rdstate() :(bool)m_file.rdstate(); }
+    bool failed() {
+        if( m_map_begin ) return m_map_failed;
+        return m_isstream ? (bool)m_stream->rdstate() :(bool)m_file.rdstate();
+    }
 
     /// @brief Close file stream
     void close();
 
+    /// @brief Check if input file is mapped into memory
+    bool is_mapped() const { return m_map_begin != NULL; }
+
+    /// @brief Parse events on worker threads
+    ///
+    /// The mapped file is split into events at their E lines, which are
+    /// parsed on @a threads worker threads, at most @a look_ahead events
+    /// ahead of read_event(). read_event() returns them in the original
+    /// order. Run information before and between events is parsed by
+    /// the calling thread, when all events before it have been returned.
+    ///
+    /// Has to be called before the first event is read. Input streams and
+    /// files that are not mapped are always parsed sequentially.
+    ///
+    /// @param threads    Number of worker threads, below 2 to parse sequentially
+    /// @param look_ahead Maximum number of events parsed ahead, 0 for twice the number of threads
+    void set_parallel(unsigned int threads, unsigned int look_ahead = 0);
+
+    /// @brief Number of worker threads, 0 if events are parsed sequentially
+    unsigned int parallel_threads() const;
+
+    /// @brief Use index of the input for seek_event() and skip()
+    ///
+    /// @return false if the index cannot be read or does not belong to the input
+    /// @see EventIndex
+    bool load_index(const std::string &filename);
+
+    /// @brief Use index of the compressed blocks of the input for seeking
+    ///
+    /// seek_event() then decompresses from the start of the block containing
+    /// the event instead of from the current position or the start of the file.
+    ///
+    /// @return false if the input is not compressed, the index cannot be read
+    ///         or it does not belong to the input
+    /// @see BlockIndex
+    bool load_block_index(const std::string &filename);
+
+    /// @brief Move to first event with number @a event_number
+    ///
+    /// The next call to read_event() returns this event. Requires an index
+    /// and a mapped file or seekable input. Failure of previous reads, e.g.
+    /// at the end of the file, is reset, so events can be read again.
+    ///
+    /// @return false if there is no such event in the index
+    bool seek_event(int event_number);
+
+    /// @brief Skip @a n events
+    ///
+    /// Uses the index if there is one. Otherwise events are skipped as
+    /// by scan_event(), which also parses run information between them.
+    /// With an index only run information in the header is parsed.
+    ///
+    /// @return false if the input ends before @a n events are skipped
+    bool skip(int n);
+
+    /// @brief Read number and counts of the next event without building it
+    ///
+    /// Only the E line and run information are parsed, particle, vertex
+    /// and attribute lines are passed without being tokenized.
+    /// @see Reader::scan_event()
+    bool scan_event(EventIndex::Entry &header);
+
   private:
 
     /// @brief Get global attribute
@@ -54,8 +140,97 @@ public:
     /// @todo rewrite global attributes
     shared_ptr<Attribute> get_global(std::string name);
 
-    /// @brief Unsecape '\' and '\n' characters in string
-    std::string unescape(const std::string& s);
+    /// @brief Map input file into memory
+    ///
+    /// @return false if file is not a regular file, is compressed or cannot be mapped
+    bool map(const std::string &filename);
+
+    /// @brief Unsecape '\' and '\n' characters in line of text
+    std::string unescape(const char *s);
+
+    /// @name Positioning helpers
+    //@{
+
+    /// @brief Input stream, when the file is not mapped
+    std::istream& input() { return m_isstream ? *m_stream : m_file; }
+
+    /// @brief Offset of the next line in the input, -1 if unknown
+    std::streamoff input_position();
+
+    /// @brief Size of the input in bytes, -1 if unknown
+    std::streamoff input_size();
+
+    /// @brief First character of the next line, 0 at the end of the input
+    char peek_input();
+
+    /// @brief Move to event starting at @a offset
+    ///
+    /// @return false, marking the input as failed, if no event starts there
+    bool seek_offset(unsigned long long offset);
+
+    /// @brief Move past the next line
+    void skip_line();
+
+    /// @brief Read next line, which stays valid until the next line is read
+    ///
+    /// @param text Storage for the line when the file is not mapped
+    const char* read_line(std::string &text);
+
+    /// @brief Drop events parsed ahead by worker threads
+    void discard_parsed_events();
+    //@}
+
+    /// @name Particle filter helpers
+    //@{
+
+    /// Particles and vertices of the input mapped to the kept ones
+    struct Projection;
+
+    /// @brief Add particle to @a evt if it passes the filter, otherwise link its descendants to its ancestors
+    void project_particle(GenEvent &evt, const GenParticleData &data, int mother_id, Projection &projection);
+
+    /// @brief Parse vertex, adding it to @a evt if it has kept incoming particles
+    bool project_vertex(GenEvent &evt, const char *buf, Projection &projection);
+
+    /// @brief Add attributes of kept particles and vertices to @a evt
+    ///
+    /// Releases references to the particles and vertices of @a evt
+    void finish_projection(GenEvent &evt, Projection &projection);
+    //@}
+
+    /// @name Parallel parsing helpers
+    //@{
+
+    /// Worker threads and events parsed by them
+    struct ParallelParser;
+
+    /// @brief Return next event parsed by worker threads
+    ///
+    /// @return 1 on success, 0 if parsing failed and -1 if the next
+    ///         event has to be parsed sequentially
+    int read_parsed_event(GenEvent &evt);
+
+    /// @brief Pass events following already passed ones to worker threads
+    void dispatch_events();
+
+    /// @brief Parse events passed to worker threads until stopped
+    void run_worker();
+
+    /// @brief Parse lines of an event in [@a begin, @a end)
+    ///
+    /// Called by worker threads, run information is not modified.
+    /// @param[out] evt                    Event that will be filled with new data
+    /// @param[out] vertices_and_particles Numbers of vertices and particles given in the E line
+    /// @param[out] failed_line            Line that could not be parsed
+    /// @param      projection             Particles dropped by the read options, NULL if all are kept
+    /// @return Status of parsing, see ParallelParser
+    int parse_event_lines(GenEvent &evt, const char *begin, const char *end,
+                          std::pair<int,int> &vertices_and_particles, const char *&failed_line,
+                          Projection *projection);
+
+    /// @brief Stop worker threads and parse sequentially
+    void stop_parallel();
+    //@}
 
     /// @name Read helpers
     //@{
@@ -110,22 +285,25 @@ public:
     /// Helper routine for parsing single event information
     /// @param[out] evt Event that will contain parsed vertex
     /// @param[in] buf Line of text that needs to be parsed
+    /// @param projection Particles dropped by the read options, NULL if all are kept
     ///
-    bool parse_vertex_information(GenEvent &evt, const char *buf);
+    bool parse_vertex_information(GenEvent &evt, const char *buf, Projection *projection);
 
     /// @brief Parse particle
     ///
     /// Helper routine for parsing single particle information
     /// @param[out] evt Event that will contain parsed particle
     /// @param[in] buf Line of text that needs to be parsed
-    bool parse_particle_information(GenEvent &evt, const char *buf);
+    /// @param projection Particles dropped by the read options, NULL if all are kept
+    bool parse_particle_information(GenEvent &evt, const char *buf, Projection *projection);
 
     /// @brief Parse attribute
     ///
     /// Helper routine for parsing single attribute information
     /// @param[out] evt Event that will contain parsed attribute
     /// @param[in] buf Line of text that needs to be parsed
-    bool parse_attribute(GenEvent &evt, const char *buf);
+    /// @param projection Particles dropped by the read options, NULL if all are kept
+    bool parse_attribute(GenEvent &evt, const char *buf, Projection *projection);
 
     /// @brief Parse run-level attribute.
     ///
@@ -152,10 +330,20 @@ public:
   private:
 
     /// @todo Unify file/stream treatment
-    std::ifstream m_file; //!< Input file
+    CompressedInputStream m_file; //!< Input file
     std::istream* m_stream; // For ctor when reading from stdin
     bool m_isstream; // toggles usage of m_file or m_stream
 
+    const char *m_map_begin;  //!< Start of mapped file, NULL if file is not mapped
+    const char *m_map_end;    //!< End of mapped file
+    const char *m_map_cursor; //!< Start of next line in mapped file
+    bool        m_map_failed; //!< End of mapped file reached or parsing failed
+
+    ParallelParser *m_parallel;   //!< Worker threads, NULL if events are parsed sequentially
+    Projection     *m_projection; //!< Particles dropped while parsing sequentially, NULL until needed
+
+    EventIndex m_index; //!< Index of the input, empty if none is loaded
+
 
     /** @brief Store attributes global to the run being written/read. */
     std::map< std::string, shared_ptr<Attribute> > m_global_attributes;
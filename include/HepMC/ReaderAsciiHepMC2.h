@@ -12,16 +12,21 @@
  *  @class HepMC::ReaderAsciiHepMC2
  *  @brief Parser for HepMC2 I/O files
  *
+ *  Compressed files are decompressed transparently, see CompressedInputStream.
+ *
  *  @ingroup IO
  *
  */
 #include "HepMC/Reader.h"
 
 #include "HepMC/Data/SmartPointer.h"
+#include "HepMC/EventIndex.h"
+#include "HepMC/CompressedStream.h"
 
 #include <string>
 #include <fstream>
 #include <vector>
+#include <unordered_map>
 using std::vector;
 using std::ifstream;
 
@@ -49,7 +54,46 @@ public:
     /// @brief Close file stream
     void close();
 
+    /** @brief Use index of the input for seek_event() and skip()
+     *
+     *  @return false if the index cannot be read or does not belong to the input
+     *  @see EventIndex
+     */
+    bool load_index(const std::string &filename);
+
+    /** @brief Move to first event with number @a event_number
+     *
+     *  The next call to read_event() returns this event. Requires an index.
+     *  Failure of previous reads, e.g. at the end of the file, is reset.
+     *
+     *  @return false if there is no such event in the index
+     */
+    bool seek_event(int event_number);
+
+    /** @brief Skip @a n events
+     *
+     *  Uses the index if there is one, otherwise the file is scanned
+     *  for lines starting events.
+     *
+     *  @return false if the file ends before @a n events are skipped
+     */
+    bool skip(int n);
+
+    /** @brief Read number and counts of the next event without building it
+     *
+     *  Only the E line and weight names are parsed, particles are counted
+     *  by the first character of their lines.
+     *  @see Reader::scan_event()
+     */
+    bool scan_event(EventIndex::Entry &header);
+
 private:
+    /** @brief Move to event starting at @a offset
+     *
+     *  @return false, marking the file as failed, if no event starts there
+     */
+    bool seek_offset(unsigned long long offset);
+
     /** @brief Parse event
      *
      *  Helper routine for parsing event information
@@ -118,14 +162,18 @@ private:
 // Fields
 //
 private:
-    ifstream               m_file;                //!< Input file
+    CompressedInputStream  m_file;                //!< Input file
+    EventIndex             m_index;               //!< Index of the file, empty if none is loaded
 
     vector<GenVertexPtr>   m_vertex_cache;        //!< Vertex cache
     vector<int>            m_vertex_barcodes;     //!< Old vertex barcodes
 
     vector<GenParticlePtr> m_particle_cache;      //!< Particle cache
+    vector<int>            m_particle_barcodes;   //!< Old particle barcodes
     vector<int>            m_end_vertex_barcodes; //!< Old end vertex barcodes
 
+    std::unordered_map<int,unsigned int> m_vertex_barcode_index; //!< Position in vertex cache by old barcode
+
     GenEvent*              m_event_ghost;                      //!< To save particle and verstex attributes.
     vector<GenParticlePtr> m_particle_cache_ghost;//!< Particle cache for attributes
 };
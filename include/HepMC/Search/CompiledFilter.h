@@ -0,0 +1,266 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef  HEPMC_SEARCH_COMPILEDFILTER_H
+#define  HEPMC_SEARCH_COMPILEDFILTER_H
+/**
+ *  @file CompiledFilter.h
+ *  @brief Definition of \b class CompiledFilter
+ *
+ *  @class HepMC::CompiledFilter
+ *  @brief FilterList compiled into a single fused predicate
+ *
+ *  The list of filters is translated once into a short program of
+ *  fused instructions. Parameter type and operator of each filter are
+ *  resolved at compile time, integer comparisons are turned into range
+ *  checks and all ranges on the same particle property are merged into
+ *  one instruction, e.g. <tt>IS_STABLE && STATUS == 1</tt> becomes a single
+ *  check and <tt>PDG_ID >= -6 && PDG_ID <= 6</tt> a single range test.
+ *  Filters based on GenParticle::flags(), e.g. <tt>IS_CHARGED && !HAS_BOTTOM</tt>,
+ *  are merged into a single AND-mask test.
+ *
+ *  Evaluation works on GenParticle references, without copying smart
+ *  pointers. Cheap checks are evaluated first. Attributes are compared
+ *  by their string form as by Filter, a missing one as an empty string.
+ *  Unparsed attributes are compared directly, only parsed ones are
+ *  converted with Attribute::to_string().
+ *
+ *  A whole list of particles can be evaluated in batch using select().
+ *  In this mode the program is executed one instruction at a time over
+ *  all particles that passed previous instructions, which keeps the
+ *  kinematic computations in tight loops.
+ *
+ *  Compile the list once and reuse the result for every event:
+ *
+ *  @code{.cpp}
+ *      CompiledFilter selection( IS_STABLE && ABS_PDG_ID == 211 );
+ *
+ *      // event loop
+ *      FindParticles search( event, FIND_ALL, selection );
+ *  @endcode
+ *
+ *  Instructions are ordered by a static cost model. When the same filter
+ *  is applied to many events, statistics of each instruction can be
+ *  collected and the instructions reordered periodically so that cheap
+ *  and selective checks are evaluated first:
+ *
+ *  @code{.cpp}
+ *      CompiledFilter selection( ATTRIBUTE("tag") && ABS_ETA < 2.5 && PT > 20.0 );
+ *      selection.enable_statistics( 10000 );
+ *
+ *      // event loop
+ *
+ *      selection.print_statistics();
+ *  @endcode
+ *
+ *  @note Collecting statistics modifies the filter during evaluation.
+ *        Such filter must not be shared between threads.
+ *
+ *  @ingroup search_engine
+ *
+ */
+#include "HepMC/Search/FilterList.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace HepMC {
+
+class GenParticle;
+
+class CompiledFilter {
+//
+// Constructors
+//
+public:
+    /** @brief Default constructor
+     *
+     *  Creates predicate that accepts every particle
+     */
+    CompiledFilter();
+
+    /** @brief Compile list of filters */
+    explicit CompiledFilter(const FilterList &filter_list);
+
+//
+// Functions
+//
+public:
+    /** @brief Check if particle passed all compiled filters */
+    bool passed_filter(const GenParticle &p) const;
+
+    /** @brief Check if particle passed all compiled filters */
+    bool passed_filter(const GenParticlePtr &p) const { return passed_filter(*p); }
+
+    /** @brief Append all particles that passed compiled filters to @a results
+     *
+     *  Particles are evaluated in batch. Order of @a particles is preserved.
+     */
+    void select(const vector<GenParticlePtr> &particles, vector<GenParticlePtr> &results) const;
+
+//
+// Accessors
+//
+public:
+    /** @brief List of GenEvent particle indexes usable for preselection */
+    enum IndexHint {
+        NO_INDEX,         //!< Full scan needed
+        PDG_ID_INDEX,     //!< Use GenEvent::particles_with_pid()
+        ABS_PDG_ID_INDEX, //!< Use GenEvent::particles_with_abs_pid()
+        STATUS_INDEX      //!< Use GenEvent::particles_with_status()
+    };
+
+    /** @brief Find index that contains all particles that can pass the filters
+     *
+     *  Index can be used if filters require equality on PDG ID, its absolute
+     *  value or status code. Requested value is stored in @a value.
+     */
+    IndexHint index_hint(int &value) const;
+
+    /** @brief Check if predicate accepts every particle */
+    bool accepts_all() const { return !m_never && m_code.empty(); }
+
+    /** @brief Check if predicate rejects every particle
+     *
+     *  True if filters contradict each other, e.g. <tt>STATUS == 1 && STATUS == 2</tt>
+     */
+    bool rejects_all() const { return m_never; }
+
+    /** @brief Number of instructions after fusing the filters */
+    size_t size() const { return m_code.size(); }
+
+//
+// Statistics
+//
+public:
+    /** @brief Statistics of single instruction */
+    struct Statistics {
+        string        description; //!< Instruction in readable form
+        unsigned long evaluated;   //!< Number of particles checked
+        unsigned long passed;      //!< Number of particles that passed
+        unsigned long timed;       //!< Number of particles checked in batch evaluation
+        double        time;        //!< Time spent in batch evaluation [s]
+
+        /** @brief Fraction of checked particles that passed */
+        double pass_rate() const { return evaluated ? (double)passed/evaluated : 1.0; }
+    };
+
+    /** @brief Start collecting statistics of instructions
+     *
+     *  Instructions are reordered each time @a reorder_interval particles
+     *  have been checked, by increasing cost per rejected particle.
+     *  Zero disables reordering. Time is measured only in select().
+     */
+    void enable_statistics(unsigned long reorder_interval = 10000);
+
+    /** @brief Stop collecting statistics
+     *
+     *  Collected statistics are kept
+     */
+    void disable_statistics() { m_collect_statistics = false; }
+
+    /** @brief Clear collected statistics */
+    void reset_statistics();
+
+    /** @brief Reorder instructions using collected statistics */
+    void reorder() const;
+
+    /** @brief Get statistics of instructions in current order of evaluation */
+    vector<Statistics> statistics() const;
+
+    /** @brief Print statistics of instructions */
+    void print_statistics(std::ostream& ostr = std::cout) const;
+
+//
+// Internal types
+//
+private:
+    /** @brief List of fused operations
+     *
+     *  Operations are listed in order of increasing cost
+     */
+    enum OpCode {
+        OP_STATUS_RANGE,            //!< status() within [lo,hi]
+        OP_PDG_ID_RANGE,            //!< pid() within [lo,hi]
+        OP_ABS_PDG_ID_RANGE,        //!< abs(pid()) within [lo,hi]
+        OP_FLAGS,                   //!< ( flags() & mask ) == bits
+        OP_ENERGY_RANGE,            //!< momentum().e() within [dlo,dhi]
+        OP_MASS_RANGE,              //!< generated_mass() within [dlo,dhi]
+        OP_PT_RANGE,                //!< momentum().pt() within [dlo,dhi]
+        OP_ETA_RANGE,               //!< momentum().eta() within [dlo,dhi]
+        OP_ABS_ETA_RANGE,           //!< momentum().abs_eta() within [dlo,dhi]
+        OP_RAPIDITY_RANGE,          //!< momentum().rap() within [dlo,dhi]
+        OP_ABS_RAPIDITY_RANGE,      //!< momentum().abs_rap() within [dlo,dhi]
+        OP_HAS_PRODUCTION_VERTEX,   //!< production vertex exists
+        OP_PRODUCTION_RADIUS_RANGE, //!< production_vertex()->position().perp() within [dlo,dhi]
+        OP_HAS_SAME_PDG_ID_DAUGHTER,//!< end vertex has outgoing particle with the same pid
+        OP_ATTRIBUTE_EXISTS,        //!< attribute exists
+        OP_ATTRIBUTE_IS_EQUAL       //!< attribute is equal to string
+    };
+
+    /** @brief Single instruction of the compiled program */
+    struct Instruction {
+        OpCode op;     //!< Operation
+        bool   negate; //!< Negate result of the operation
+        int    lo;     //!< Lower bound of range operations
+        int    hi;     //!< Upper bound of range operations
+        double dlo;    //!< Lower bound of floating-point range operations
+        double dhi;    //!< Upper bound of floating-point range operations
+        unsigned int mask; //!< Flags tested by flag operation
+        unsigned int bits; //!< Expected values of tested flags
+        string name;   //!< Attribute name (attribute operations only)
+        string value;  //!< Attribute value (attribute operations only)
+    };
+
+//
+// Helpers
+//
+private:
+    /** @brief Translate filter into instruction and append it to the program */
+    void compile(const Filter &f);
+
+    /** @brief Append range check, merging it with existing check on the same property */
+    void add_range(OpCode op, int lo, int hi, bool negate);
+
+    /** @brief Append floating-point range check, merging it with existing check on the same property */
+    void add_range(OpCode op, double lo, double hi, bool negate);
+
+    /** @brief Append flag check, merging it with existing flag check */
+    void add_flag(unsigned int mask, bool value);
+
+    /** @brief Order of evaluation of two instructions */
+    static bool cheaper(const Instruction &a, const Instruction &b) { return a.op < b.op; }
+
+    /** @brief Evaluate single instruction */
+    static bool passed_instruction(const Instruction &ins, const GenParticle &p);
+
+    /** @brief Evaluate all instructions collecting statistics */
+    bool passed_filter_with_statistics(const GenParticle &p) const;
+
+    /** @brief Count checked particles and reorder instructions if needed */
+    void count_checked(unsigned long n) const;
+
+    /** @brief Estimated time needed to evaluate operation [s] */
+    static double estimated_cost(OpCode op);
+
+    /** @brief Describe instruction in readable form */
+    static string describe(const Instruction &ins);
+
+//
+// Fields
+//
+private:
+    mutable vector<Instruction> m_code;               //!< Compiled program
+    mutable vector<Statistics>  m_statistics;         //!< Statistics of instructions, same order as m_code
+    mutable unsigned long       m_checked;            //!< Particles checked since last reordering
+    unsigned long               m_reorder_interval;   //!< Particles checked between reorderings
+    bool                        m_collect_statistics; //!< Statistics are collected
+    bool                        m_never;              //!< Program rejects all particles
+};
+
+} // namespace HepMC
+
+#endif
@@ -0,0 +1,82 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef  HEPMC_SEARCH_DECAYDESCRIPTOR_H
+#define  HEPMC_SEARCH_DECAYDESCRIPTOR_H
+/**
+ *  @file DecayDescriptor.h
+ *  @brief Definition of \b class DecayDescriptor
+ *
+ *  @class HepMC::DecayDescriptor
+ *  @brief Tree of filters describing a decay topology
+ *
+ *  Each node holds filters for one particle and a list of descriptors
+ *  of its decay products. A node without decay products matches
+ *  a particle regardless of its decay.
+ *
+ *  Descriptor of <tt>B0 -> J/psi(-> mu+ mu-) K_S0</tt>:
+ *
+ *  @code{.cpp}
+ *      DecayDescriptor jpsi( PDG_ID == 443 );
+ *      jpsi.add_daughter( PDG_ID == -13 ).add_daughter( PDG_ID == 13 );
+ *
+ *      DecayDescriptor b0( ABS_PDG_ID == 511 );
+ *      b0.add_daughter( jpsi ).add_daughter( PDG_ID == 310 );
+ *  @endcode
+ *
+ *  See HepMC::FindDecays for the search using the descriptor.
+ *
+ *  @ingroup search_engine
+ *
+ */
+#include "HepMC/Search/FilterList.h"
+#include "HepMC/Search/CompiledFilter.h"
+
+#include <vector>
+
+namespace HepMC {
+
+class DecayDescriptor {
+//
+// Constructors
+//
+public:
+    /** @brief Create descriptor of a particle passing all filters */
+    DecayDescriptor(const FilterList &filter_list);
+
+//
+// Functions
+//
+public:
+    /** @brief Add decay product passing all filters */
+    DecayDescriptor& add_daughter(const FilterList &filter_list);
+
+    /** @brief Add decay product described by another descriptor */
+    DecayDescriptor& add_daughter(const DecayDescriptor &daughter);
+
+//
+// Accessors
+//
+public:
+    const CompiledFilter&          filter()    const { return m_filter;    } //!< Get filter of this particle
+    const vector<DecayDescriptor>& daughters() const { return m_daughters; } //!< Get descriptors of decay products
+
+    /** @brief Number of particles in the descriptor tree
+     *
+     *  This is also the length of each tuple returned by FindDecays
+     */
+    size_t size() const;
+
+//
+// Fields
+//
+private:
+    CompiledFilter          m_filter;    //!< Filter of this particle
+    vector<DecayDescriptor> m_daughters; //!< Descriptors of decay products
+};
+
+} // namespace HepMC
+
+#endif
@@ -32,7 +32,8 @@ class GenEvent;
 
 class Filter : protected FilterBase {
 
-friend class FilterBase; // To allow call to protected constructor
+friend class FilterBase;     // To allow call to protected constructor
+friend class CompiledFilter; // To allow translation of filter parameters
 
 //
 // Constructors
@@ -43,20 +44,27 @@ protected:
      *  Invoked when an operator == != < > <= or >= with integer value
      *  is used on a filter.
      */
-    Filter(FilterIntegerParam p, FilterOperator o, int value):FilterBase(p),m_operator(o),m_int_value(value),m_bool_value(true) {}
+    Filter(FilterIntegerParam p, FilterOperator o, int value):FilterBase(p),m_operator(o),m_int_value(value),m_double_value(0.),m_bool_value(true) {}
+
+    /** @brief Internal constructor for floating-point-type filters
+     *
+     *  Invoked when an operator == != < > <= or >= is used on
+     *  a floating-point filter.
+     */
+    Filter(FilterDoubleParam p, FilterOperator o, double value):FilterBase(p),m_operator(o),m_int_value(0),m_double_value(value),m_bool_value(true) {}
 
     /** @brief Internal constructor for boolean-type filters
      *
      *  Used to initialize global static const filters and to create
      *  new filters using operator '!'
      */
-    Filter(FilterBoolParam p, bool value = true):FilterBase(p),m_operator(EQUAL),m_int_value(0),m_bool_value(value) {}
+    Filter(FilterBoolParam p, bool value = true):FilterBase(p),m_operator(EQUAL),m_int_value(0),m_double_value(0.),m_bool_value(value) {}
 
     /** @brief Internal constructor for attribute-type filters
      *
      *  Used when class ATTRIBUTE is called to provide attribute name
      */
-    Filter(FilterAttributeParam p, const string name):FilterBase(p),m_operator(EQUAL),m_int_value(0),m_bool_value(true),m_attribute_name(name) {}
+    Filter(FilterAttributeParam p, const string name):FilterBase(p),m_operator(EQUAL),m_int_value(0),m_double_value(0.),m_bool_value(true),m_attribute_name(name) {}
 
 //
 // Functions
@@ -72,17 +80,27 @@ private:
     /** @brief Filter::passed_filter helper for integer-type filters */
     bool passed_int_filter(const GenParticlePtr &p) const;
 
+    /** @brief Filter::passed_filter helper for floating-point-type filters */
+    bool passed_double_filter(const GenParticlePtr &p) const;
+
     /** @brief Filter::passed_filter helper for pointer-type filters */
     bool passed_bool_filter(const GenParticlePtr &p) const;
 
     /** @brief Filter::passed_filter helper for attribute-type filters */
     bool passed_attribute_filter(const GenParticlePtr &p) const;
+
+    /** @brief Bit of GenParticle::flags() tested by boolean filter
+     *
+     *  @return 0 if filter is not based on particle flags
+     */
+    static unsigned int flag_mask(FilterBoolParam p);
 //
 // Fields
 //
 protected:
     FilterOperator m_operator;       //!< Operator used by filter
     int            m_int_value;      //!< Filter parameter for integer-type filter
+    double         m_double_value;   //!< Filter parameter for floating-point-type filter
     bool           m_bool_value;     //!< Filter parameter for boolean-type filter
     string         m_attribute_name; //!< Filter parameter for attribute-type filters
     string         m_attribute_str;  //!< Filter parameter for attribute-type filters
@@ -93,6 +111,18 @@ static const Filter HAS_PRODUCTION_VERTEX    = FilterBase::init_has_production_v
 static const Filter HAS_SAME_PDG_ID_DAUGHTER = FilterBase::init_has_same_pdg_id_daughter(); //!< Filter for checking if end vertex has particle with same pdg_id
 static const Filter IS_STABLE                = FilterBase::init_is_stable();                //!< Filter for checking if particle is stable
 static const Filter IS_BEAM                  = FilterBase::init_is_beam();                  //!< Filter for checking if particle is a beam particle
+static const Filter IS_CHARGED               = FilterBase::init_is_charged();               //!< Filter for checking if particle has non-zero charge
+static const Filter IS_QUARK                 = FilterBase::init_is_quark();                 //!< Filter for checking if particle is a quark
+static const Filter IS_LEPTON                = FilterBase::init_is_lepton();                //!< Filter for checking if particle is a lepton
+static const Filter IS_NEUTRINO              = FilterBase::init_is_neutrino();              //!< Filter for checking if particle is a neutrino
+static const Filter IS_HADRON                = FilterBase::init_is_hadron();                //!< Filter for checking if particle is a hadron
+static const Filter IS_MESON                 = FilterBase::init_is_meson();                 //!< Filter for checking if particle is a meson
+static const Filter IS_BARYON                = FilterBase::init_is_baryon();                //!< Filter for checking if particle is a baryon
+static const Filter IS_NUCLEUS               = FilterBase::init_is_nucleus();               //!< Filter for checking if particle is a nucleus
+static const Filter HAS_STRANGE              = FilterBase::init_has_strange();              //!< Filter for checking if particle is a strange quark or contains one
+static const Filter HAS_CHARM                = FilterBase::init_has_charm();                //!< Filter for checking if particle is a charm quark or contains one
+static const Filter HAS_BOTTOM               = FilterBase::init_has_bottom();               //!< Filter for checking if particle is a bottom quark or contains one
+static const Filter HAS_TOP                  = FilterBase::init_has_top();                  //!< Filter for checking if particle is a top quark or contains one
 
 } // namespace HepMC
 
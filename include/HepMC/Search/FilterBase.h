@@ -18,6 +18,9 @@
  *  @ingroup search_engine
  *
  */
+#if !defined(__CINT__)
+#include <type_traits>
+#endif
 
 namespace HepMC {
 
@@ -32,6 +35,7 @@ protected:
 /** @brief List of filter parameter types */
 enum FilterParamType {
     INTEGER_PARAM,
+    DOUBLE_PARAM,
     BOOL_PARAM,
     ATTRIBUTE_PARAM
 };
@@ -43,13 +47,37 @@ enum FilterIntegerParam {
     ABS_PDG_ID
 };
 
+/** @brief List of filters with floating-point parameter */
+enum FilterDoubleParam {
+    PT,
+    ETA,
+    ABS_ETA,
+    RAPIDITY,
+    ABS_RAPIDITY,
+    ENERGY,
+    MASS,
+    PRODUCTION_RADIUS
+};
+
 /** @brief List of filters with boolean parameter */
 enum FilterBoolParam {
     HAS_END_VERTEX,
     HAS_PRODUCTION_VERTEX,
     HAS_SAME_PDG_ID_DAUGHTER,
     IS_STABLE,
-    IS_BEAM
+    IS_BEAM,
+    IS_CHARGED,
+    IS_QUARK,
+    IS_LEPTON,
+    IS_NEUTRINO,
+    IS_HADRON,
+    IS_MESON,
+    IS_BARYON,
+    IS_NUCLEUS,
+    HAS_STRANGE,
+    HAS_CHARM,
+    HAS_BOTTOM,
+    HAS_TOP
 };
 
 /** @brief List of filters with attribute parameter */
@@ -76,11 +104,32 @@ public:
     static const FilterBase init_pdg_id()          { return FilterBase(PDG_ID);          } //!< init static const PDG_ID
     static const FilterBase init_abs_pdg_id()      { return FilterBase(ABS_PDG_ID);      } //!< init static const ABS_PDG_ID
 
+    static const FilterBase init_pt()                { return FilterBase(PT);                } //!< init static const PT
+    static const FilterBase init_eta()               { return FilterBase(ETA);               } //!< init static const ETA
+    static const FilterBase init_abs_eta()           { return FilterBase(ABS_ETA);           } //!< init static const ABS_ETA
+    static const FilterBase init_rapidity()          { return FilterBase(RAPIDITY);          } //!< init static const RAPIDITY
+    static const FilterBase init_abs_rapidity()      { return FilterBase(ABS_RAPIDITY);      } //!< init static const ABS_RAPIDITY
+    static const FilterBase init_energy()            { return FilterBase(ENERGY);            } //!< init static const ENERGY
+    static const FilterBase init_mass()              { return FilterBase(MASS);              } //!< init static const MASS
+    static const FilterBase init_production_radius() { return FilterBase(PRODUCTION_RADIUS); } //!< init static const PRODUCTION_RADIUS
+
     static const Filter     init_has_end_vertex();           //!< init static const HAS_END_VERTEX
     static const Filter     init_has_production_vertex();    //!< init static const HAS_PRODUCTION_VERTEX
     static const Filter     init_has_same_pdg_id_daughter(); //!< init static const HAS_SAME_PDG_ID_DAUGHTER
     static const Filter     init_is_stable();                //!< init static const IS_STABLE
     static const Filter     init_is_beam();                  //!< init static const IS_BEAM
+    static const Filter     init_is_charged();               //!< init static const IS_CHARGED
+    static const Filter     init_is_quark();                 //!< init static const IS_QUARK
+    static const Filter     init_is_lepton();                //!< init static const IS_LEPTON
+    static const Filter     init_is_neutrino();              //!< init static const IS_NEUTRINO
+    static const Filter     init_is_hadron();                //!< init static const IS_HADRON
+    static const Filter     init_is_meson();                 //!< init static const IS_MESON
+    static const Filter     init_is_baryon();                //!< init static const IS_BARYON
+    static const Filter     init_is_nucleus();               //!< init static const IS_NUCLEUS
+    static const Filter     init_has_strange();              //!< init static const HAS_STRANGE
+    static const Filter     init_has_charm();                //!< init static const HAS_CHARM
+    static const Filter     init_has_bottom();               //!< init static const HAS_BOTTOM
+    static const Filter     init_has_top();                  //!< init static const HAS_TOP
 
 //
 // Constructors
@@ -93,6 +142,12 @@ protected:
      */
     FilterBase(FilterIntegerParam p):m_value_type(INTEGER_PARAM),m_int(p) {}
 
+    /** @brief Floating-point-type internal constructor
+     *
+     *  Used by static const initializers to define filters.
+     */
+    FilterBase(FilterDoubleParam p):m_value_type(DOUBLE_PARAM),m_double(p) {}
+
     /** @brief Boolean-type internal constructor
      *
      *  Used by static const initializers to define filters.
@@ -116,6 +171,59 @@ public:
     Filter operator< (int value) const; //!< Create integer filter with operator <
     Filter operator<=(int value) const; //!< Create integer filter with operator <=
 
+    /** @brief Create floating-point filter with operator ==
+     *
+     *  Floating-point values can be used only with floating-point filters,
+     *  e.g. <tt>PT > 20.5</tt>. Integer values are accepted by both types
+     *  of filters, e.g. <tt>PT > 20</tt>.
+     *
+     *  @throws Exception if used with integer filter
+     */
+    Filter operator==(double value) const;
+    Filter operator!=(double value) const; //!< Create floating-point filter with operator !=
+    Filter operator> (double value) const; //!< Create floating-point filter with operator >
+    Filter operator>=(double value) const; //!< Create floating-point filter with operator >=
+    Filter operator< (double value) const; //!< Create floating-point filter with operator <
+    Filter operator<=(double value) const; //!< Create floating-point filter with operator <=
+
+#if !defined(__CINT__)
+    /** @brief Create filter with operator == from other integer types
+     *
+     *  Integer values of other types, e.g. <tt>STATUS == 1u</tt>, are
+     *  converted to int as before floating-point filters were added,
+     *  instead of being ambiguous between the int and double overloads.
+     */
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value,Filter>::type operator==(T value) const { return operator==((int)value); }
+
+    /** @brief Create filter with operator != from other integer types */
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value,Filter>::type operator!=(T value) const { return operator!=((int)value); }
+
+    /** @brief Create filter with operator > from other integer types */
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value,Filter>::type operator> (T value) const { return operator> ((int)value); }
+
+    /** @brief Create filter with operator >= from other integer types */
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value,Filter>::type operator>=(T value) const { return operator>=((int)value); }
+
+    /** @brief Create filter with operator < from other integer types */
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value,Filter>::type operator< (T value) const { return operator< ((int)value); }
+
+    /** @brief Create filter with operator <= from other integer types */
+    template<class T>
+    typename std::enable_if<std::is_integral<T>::value,Filter>::type operator<=(T value) const { return operator<=((int)value); }
+#endif
+
+private:
+    /** @brief Create filter using proper parameter type */
+    Filter make_filter(FilterOperator o, int value) const;
+
+    /** @brief Create floating-point filter */
+    Filter make_filter(FilterOperator o, double value) const;
+
 //
 // Fields
 //
@@ -125,6 +233,7 @@ protected:
     union {
         FilterAttributeParam m_attribute; //!< Attribute value (if attribute parameter type)
         FilterIntegerParam   m_int;       //!< Integer   value (if integer   parameter type)
+        FilterDoubleParam    m_double;    //!< Double    value (if double    parameter type)
         FilterBoolParam      m_bool;      //!< Boolean   value (if boolean   parameter type)
     };
 };
@@ -133,6 +242,15 @@ static const FilterBase STATUS          = FilterBase::init_status();           /
 static const FilterBase PDG_ID          = FilterBase::init_pdg_id();           //!< Filter base for filtering GenParticle::pid()
 static const FilterBase ABS_PDG_ID      = FilterBase::init_abs_pdg_id();       //!< Filter base for filtering abs( GenParticle::pid() )
 
+static const FilterBase PT                = FilterBase::init_pt();                //!< Filter base for filtering GenParticle::momentum().pt()
+static const FilterBase ETA               = FilterBase::init_eta();               //!< Filter base for filtering GenParticle::momentum().eta()
+static const FilterBase ABS_ETA           = FilterBase::init_abs_eta();           //!< Filter base for filtering GenParticle::momentum().abs_eta()
+static const FilterBase RAPIDITY          = FilterBase::init_rapidity();          //!< Filter base for filtering GenParticle::momentum().rap()
+static const FilterBase ABS_RAPIDITY      = FilterBase::init_abs_rapidity();      //!< Filter base for filtering GenParticle::momentum().abs_rap()
+static const FilterBase ENERGY            = FilterBase::init_energy();            //!< Filter base for filtering GenParticle::momentum().e()
+static const FilterBase MASS              = FilterBase::init_mass();              //!< Filter base for filtering GenParticle::generated_mass()
+static const FilterBase PRODUCTION_RADIUS = FilterBase::init_production_radius(); //!< Filter base for filtering transverse distance of GenParticle::production_vertex() from the beam axis
+
 } // namespace HepMC
 
 #endif
@@ -59,7 +59,7 @@ public:
 // Accessors
 //
 public:
-    const vector<Filter>& filters() { return m_filters; } //!< Get list of filters
+    const vector<Filter>& filters() const { return m_filters; } //!< Get list of filters
 
 //
 // Fields
@@ -0,0 +1,133 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef  HEPMC_SEARCH_FINDDECAYS_H
+#define  HEPMC_SEARCH_FINDDECAYS_H
+/**
+ *  @file FindDecays.h
+ *  @brief Definition of \b class FindDecays
+ *
+ *  @class HepMC::FindDecays
+ *  @brief Search engine for decay topologies
+ *
+ *  Finds all decays matching HepMC::DecayDescriptor. Each result is a tuple
+ *  of particles listed in the order of the descriptor tree (mother first,
+ *  then each daughter followed by its own decay products).
+ *
+ *  Candidate mothers are taken from the particle index of the event
+ *  whenever the filters of the top descriptor allow it. Decay products
+ *  are matched by graph traversal of the end vertices. Particles that
+ *  fail the filters of a descriptor are not followed any further.
+ *
+ *  Copies of the same particle made by the generator (end vertex containing
+ *  a particle with the same PDG ID) are followed to the last copy before
+ *  decay products are matched. Each decay is reported only for the first
+ *  copy of the mother.
+ *
+ *  @code{.cpp}
+ *      FindDecays search( event, b0, ALLOW_PHOTON_RADIATION );
+ *
+ *      FOREACH( const vector<GenParticlePtr> &decay, search.results() ) {
+ *          // decay[0] - B0, decay[1] - J/psi, decay[2] - mu+, decay[3] - mu-, decay[4] - K_S0
+ *      }
+ *  @endcode
+ *
+ *  If several daughters can be matched to the same particles,
+ *  e.g. <tt>D0 -> pi+ pi- pi+ pi-</tt>, a tuple is returned for
+ *  each possible assignment.
+ *
+ *  @ingroup search_engine
+ *
+ */
+#include "HepMC/Search/DecayDescriptor.h"
+#include "HepMC/Data/SmartPointer.h"
+
+#include <vector>
+
+namespace HepMC {
+
+
+class GenEvent;
+
+
+/** @brief Options of decay matching */
+enum DecayMatchOption {
+    EXACT_DECAY                   = 0x0, //!< Decay products have to match the descriptor exactly
+    ALLOW_INTERMEDIATE_RESONANCES = 0x1, //!< Decay products may come from decays of particles not listed in the descriptor
+    ALLOW_PHOTON_RADIATION        = 0x2  //!< Photons not listed in the descriptor are ignored
+};
+
+
+class FindDecays {
+//
+// Constructors
+//
+public:
+    /** @brief Find all decays in the event */
+    FindDecays(const GenEvent &evt, const DecayDescriptor &descriptor, int options = EXACT_DECAY);
+
+    /** @brief Find all decays of the particle */
+    FindDecays(const GenParticlePtr &p, const DecayDescriptor &descriptor, int options = EXACT_DECAY);
+
+//
+// Functions
+//
+private:
+    /** @brief Append all tuples matching descriptor @a d starting from particle @a p */
+    void match(const DecayDescriptor &d, const GenParticlePtr &p, vector< vector<GenParticlePtr> > &tuples) const;
+
+    /** @brief Assign decay products to descriptors of daughters
+     *
+     *  Particles of @a products starting from @a i are either assigned to
+     *  one of the daughters, ignored (radiated photons) or replaced by their
+     *  own decay products (intermediate resonances).
+     */
+    void match_products(const DecayDescriptor &d, vector<GenParticlePtr> &products, size_t i, size_t unassigned,
+                        vector< vector< vector<GenParticlePtr> > > &assigned, vector<GenVertexPtr> &expanded,
+                        const GenParticlePtr &mother, vector< vector<GenParticlePtr> > &tuples) const;
+
+    /** @brief Append all combinations of assigned daughter tuples */
+    static void combine(const vector< vector< vector<GenParticlePtr> > > &assigned, size_t k,
+                        vector<GenParticlePtr> &tuple, vector< vector<GenParticlePtr> > &tuples);
+
+    /** @brief Follow copies of the particle made by the generator */
+    static GenParticlePtr last_copy(const GenParticlePtr &p);
+
+    /** @brief Check if particle is a copy of its mother */
+    static bool is_copy(const GenParticlePtr &p);
+
+//
+// Accessors
+//
+public:
+    const vector< vector<GenParticlePtr> >& results() const { return m_results; } //!< Get results
+
+//
+// Fields
+//
+private:
+    int                              m_options; //!< Matching options
+    vector< vector<GenParticlePtr> > m_results; //!< List of matched tuples
+};
+
+
+  /// @name Finding decays via unbound functions (returns by copy)
+  //@{
+
+  /** @brief Find decays in GenEvent */
+  inline vector< vector<GenParticlePtr> > findDecays(const GenEvent &evt, const DecayDescriptor &descriptor, int options = EXACT_DECAY ) {
+    return FindDecays(evt, descriptor, options).results();
+  }
+
+  /** @brief Find decays of GenParticle */
+  inline vector< vector<GenParticlePtr> > findDecays(const GenParticlePtr &p, const DecayDescriptor &descriptor, int options = EXACT_DECAY ) {
+    return FindDecays(p, descriptor, options).results();
+  }
+
+  //@}
+
+} // namespace HepMC
+
+#endif
@@ -12,16 +12,42 @@
  *  @class HepMC::FindParticles
  *  @brief Search engine for GenEvent class
  *
+ *  Besides the constructors collecting results, static functions visit()
+ *  and collect() provide searches that do not allocate memory in steady
+ *  state. visit() invokes a callback for each particle that passed the
+ *  filters and stops as soon as the callback returns false:
+ *
+ *  @code{.cpp}
+ *      CompiledFilter muons( ABS_PDG_ID == 13 && PT > 10.0 );
+ *      int n = 0;
+ *
+ *      FindParticles::visit( event, FIND_ALL, muons, [&n](const GenParticlePtr &p) { return ++n < 2; } );
+ *  @endcode
+ *
+ *  collect() appends results to a buffer provided by the caller, which
+ *  can be cleared and reused between searches. Searches through ancestors
+ *  or descendants keep their traversal state in HepMC::SearchBuffer.
+ *
+ *  The callback receives references to pointers stored in the event
+ *  and the graph is traversed without copying smart pointers.
+ *
  *  @ingroup search_engine
  *
  */
 #include "HepMC/Search/FilterList.h"
+#include "HepMC/Search/CompiledFilter.h"
 #include "HepMC/Data/SmartPointer.h"
 
+#include <vector>
+#include <utility>
+#include <type_traits>
+
 namespace HepMC {
 
 
 class GenEvent;
+class GenVertex;
+class GenParticle;
 
 
 /** @brief List of methods of searching through all particles in the event */
@@ -34,6 +60,49 @@ enum FilterType {
 using FilterEvent = FilterType;
 
 
+/** @class HepMC::SearchBuffer
+ *  @brief Reusable state of searches through ancestors and descendants
+ *
+ *  Keeps the list of visited vertices as marks indexed by vertex id,
+ *  invalidated in O(1) at the start of each search. Memory is allocated
+ *  only when the buffer is used with an event larger than any before.
+ *
+ *  @ingroup search_engine
+ */
+class SearchBuffer {
+friend class FindParticles;
+//
+// Constructors
+//
+public:
+    /** @brief Default constructor */
+    SearchBuffer():m_event(NULL),m_epoch(0) {}
+
+//
+// Functions
+//
+private:
+    /** @brief Forget vertices visited by the previous search */
+    void begin(const GenEvent *evt);
+
+    /** @brief Mark vertex as visited
+     *
+     *  @return false if the vertex has already been visited
+     */
+    bool mark(const GenVertex &v);
+
+//
+// Fields
+//
+private:
+    const GenEvent                                    *m_event;   //!< Event of the vertices indexed by m_marks
+    unsigned int                                       m_epoch;   //!< Mark value of the current search
+    vector<unsigned int>                               m_marks;   //!< Visit marks indexed by vertex id
+    vector<const GenVertex*>                           m_visited; //!< Visited vertices not belonging to m_event
+    vector< std::pair<const GenVertex*, unsigned int> > m_stack;   //!< Traversal stack of vertices and positions in their particle lists
+};
+
+
 class FindParticles {
 //
 // Constructors
@@ -49,27 +118,113 @@ public:
     /** @brief GenVertex-based constructor */
     FindParticles(const GenVertexPtr &v, Relationship filter_type, FilterList filter_list = FilterList() );
 
+    /** @brief GenEvent-based constructor using precompiled filters */
+    FindParticles(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter );
+
+    /** @brief GenParticle-based constructor using precompiled filters */
+    FindParticles(const GenParticlePtr &p, Relationship filter_type, const CompiledFilter &filter );
+
+    /** @brief GenVertex-based constructor using precompiled filters */
+    FindParticles(const GenVertexPtr &v, Relationship filter_type, const CompiledFilter &filter );
+
 
     /** @brief Narrow down the results applying additional filters */
     void narrow_down( FilterList filter_list );
+
+    /** @brief Narrow down the results applying precompiled filters */
+    void narrow_down( const CompiledFilter &filter );
+
 //
-// Functions
+// Visitor-based search
 //
-private:
-    /** @brief Check if particle passed all filters */
-    bool passed_all_filters(const GenParticlePtr &p, FilterList &filter_list);
+public:
+    /** @brief Callback invoked for each particle that passed the filters
+     *
+     *  Returns false to stop the search
+     */
+    typedef bool (*Callback)(const GenParticlePtr &p, void *data);
 
-    /** @brief Check if all ancestors passed the filter
+    /** @brief Invoke @a callback for each particle of the event that passed the filters
      *
-     *  Recursively check all particles and production vertices of these particles
+     *  @return false if the search was stopped by the callback
      */
-    void recursive_check_ancestors(const GenVertexPtr &v, FilterList &filter_list);
+    static bool visit(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter, Callback callback, void *data);
+
+    /** @brief Invoke @a callback for each related particle that passed the filters */
+    static bool visit(const GenParticle &p, Relationship filter_type, const CompiledFilter &filter, Callback callback, void *data, SearchBuffer &buffer);
+
+    /** @brief Invoke @a callback for each related particle that passed the filters */
+    static bool visit(const GenVertex &v, Relationship filter_type, const CompiledFilter &filter, Callback callback, void *data, SearchBuffer &buffer);
 
-    /** @brief Check if all descendants passed the filter
+    /** @brief Invoke @a visitor for each particle of the event that passed the filters
      *
-     *  Recursively check all particles and end vertices of these particles
+     *  @a visitor is any function object taking <tt>const GenParticlePtr&</tt>
+     *  and returning false to stop the search
      */
-    void recursive_check_descendants(const GenVertexPtr &v, FilterList &filter_list);
+    template<class Visitor>
+    static bool visit(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter, Visitor &&visitor) {
+        return visit( evt, filter_type, filter, &call<Visitor>, address(visitor) );
+    }
+
+    /** @brief Invoke @a visitor for each related particle that passed the filters */
+    template<class Visitor>
+    static bool visit(const GenParticlePtr &p, Relationship filter_type, const CompiledFilter &filter, Visitor &&visitor, SearchBuffer &buffer) {
+        return visit( *p, filter_type, filter, &call<Visitor>, address(visitor), buffer );
+    }
+
+    /** @brief Invoke @a visitor for each related particle that passed the filters */
+    template<class Visitor>
+    static bool visit(const GenVertexPtr &v, Relationship filter_type, const CompiledFilter &filter, Visitor &&visitor, SearchBuffer &buffer) {
+        return visit( *v, filter_type, filter, &call<Visitor>, address(visitor), buffer );
+    }
+
+    /** @brief Append particles of the event that passed the filters to @a results */
+    static void collect(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results);
+
+    /** @brief Append related particles that passed the filters to @a results */
+    static void collect(const GenParticle &p, Relationship filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results, SearchBuffer &buffer);
+
+    /** @brief Append related particles that passed the filters to @a results */
+    static void collect(const GenVertex &v, Relationship filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results, SearchBuffer &buffer);
+
+    /** @brief Append related particles that passed the filters to @a results */
+    static void collect(const GenParticlePtr &p, Relationship filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results, SearchBuffer &buffer) {
+        collect( *p, filter_type, filter, results, buffer );
+    }
+
+    /** @brief Append related particles that passed the filters to @a results */
+    static void collect(const GenVertexPtr &v, Relationship filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results, SearchBuffer &buffer) {
+        collect( *v, filter_type, filter, results, buffer );
+    }
+
+//
+// Functions
+//
+private:
+    /** @brief Visit all ancestors or descendants of the vertex
+     *
+     *  Depth-first traversal of production (@a ancestors = true) or end vertices
+     *  of particles. Each vertex is visited once.
+     */
+    static bool visit_tree(const GenVertex &v, bool ancestors, const CompiledFilter &filter, Callback callback, void *data, SearchBuffer &buffer);
+
+    /** @brief Invoke @a callback for particles of a list that passed the filters */
+    static bool visit_list(const vector<GenParticlePtr> &particles, const CompiledFilter &filter, Callback callback, void *data);
+
+    /** @brief Append particle to a vector passed as @a data */
+    static bool append(const GenParticlePtr &p, void *data);
+
+    /** @brief Address of a function object passed as callback data */
+    template<class Visitor>
+    static void* address(Visitor &visitor) {
+        return const_cast<void*>( static_cast<const void*>(&visitor) );
+    }
+
+    /** @brief Forward call to a function object passed as @a data */
+    template<class Visitor>
+    static bool call(const GenParticlePtr &p, void *data) {
+        return (*static_cast<typename std::remove_reference<Visitor>::type*>(data))(p);
+    }
 //
 // Accessors
 //
@@ -80,8 +235,7 @@ public:
 // Fields
 //
 private:
-    vector<GenParticlePtr> m_results;          //!< List of results
-    vector<GenVertexPtr>   m_checked_vertices; //!< List of already checked vertices
+    vector<GenParticlePtr> m_results; //!< List of results
 };
 
 
@@ -103,6 +257,21 @@ private:
     return FindParticles(v, filter_type, filter_list).results();
   }
 
+  /** @brief Find from GenEvent using precompiled filters */
+  inline vector<GenParticlePtr> findParticles(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter ) {
+    return FindParticles(evt, filter_type, filter).results();
+  }
+
+  /** @brief Find from GenParticle using precompiled filters */
+  inline vector<GenParticlePtr> findParticles(const GenParticlePtr &p, Relationship filter_type, const CompiledFilter &filter ) {
+    return FindParticles(p, filter_type, filter).results();
+  }
+
+  /** @brief Find from GenVertex using precompiled filters */
+  inline vector<GenParticlePtr> findParticles(const GenVertexPtr &v, Relationship filter_type, const CompiledFilter &filter ) {
+    return FindParticles(v, filter_type, filter).results();
+  }
+
   //@}
 
 
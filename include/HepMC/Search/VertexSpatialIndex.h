@@ -0,0 +1,141 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef  HEPMC_SEARCH_VERTEXSPATIALINDEX_H
+#define  HEPMC_SEARCH_VERTEXSPATIALINDEX_H
+/**
+ *  @file VertexSpatialIndex.h
+ *  @brief Definition of \b class VertexSpatialIndex
+ *
+ *  @class HepMC::VertexSpatialIndex
+ *  @brief Spatial index of vertex positions of an event
+ *
+ *  Balanced k-d tree over spatial coordinates of resolved vertex positions
+ *  (see GenVertex::position()). Building the index takes O(N log N),
+ *  queries take O(log N) plus the number of vertices found.
+ *
+ *  @code{.cpp}
+ *      VertexSpatialIndex index( event );
+ *
+ *      double distance = 0;
+ *      GenVertexPtr closest = index.nearest( reco_position, &distance );
+ *
+ *      vector<GenVertexPtr> displaced = index.in_cylinder( 100.0, -300.0, 300.0 );
+ *  @endcode
+ *
+ *  The index is a snapshot of the event. It has to be rebuilt with build()
+ *  after vertices are added, removed or moved. Reusing the same index for
+ *  consecutive events reuses its memory.
+ *
+ *  Only spatial coordinates are used. Time coordinates of the found vertices
+ *  can be checked using GenVertex::position().
+ *
+ *  @ingroup search_engine
+ *
+ */
+#include "HepMC/FourVector.h"
+#include "HepMC/Data/SmartPointer.h"
+
+#include <vector>
+
+namespace HepMC {
+
+
+class GenEvent;
+class GenVertex;
+
+
+class VertexSpatialIndex {
+//
+// Constructors
+//
+public:
+    /** @brief Default constructor creating empty index */
+    VertexSpatialIndex() {}
+
+    /** @brief Build index of all vertices of the event */
+    explicit VertexSpatialIndex(const GenEvent &evt);
+
+//
+// Functions
+//
+public:
+    /** @brief Rebuild index using vertices of the event */
+    void build(const GenEvent &evt);
+
+    /** @brief Find vertices within distance @a radius from @a point */
+    vector<GenVertexPtr> within_radius(const FourVector &point, double radius) const;
+
+    /** @brief Find vertices within axis-aligned box spanned by @a min and @a max */
+    vector<GenVertexPtr> in_box(const FourVector &min, const FourVector &max) const;
+
+    /** @brief Find vertices within cylinder around the beam axis
+     *
+     *  Vertices with transverse distance from the axis up to @a radius
+     *  and z coordinate within [z_min,z_max] are returned
+     */
+    vector<GenVertexPtr> in_cylinder(double radius, double z_min, double z_max) const;
+
+    /** @brief Find vertex closest to @a point
+     *
+     *  Returns empty pointer if the index is empty or no vertex is at a finite
+     *  distance, e.g. for an infinite @a point. If @a distance is provided,
+     *  distance to the vertex is stored in it, HUGE_VAL if none is found.
+     */
+    GenVertexPtr nearest(const FourVector &point, double *distance = NULL) const;
+
+//
+// Accessors
+//
+public:
+    size_t size()  const { return m_nodes.size();  } //!< Number of indexed vertices
+    bool   empty() const { return m_nodes.empty(); } //!< Check if index is empty
+
+//
+// Internal types
+//
+private:
+    /** @brief Node of the k-d tree */
+    struct Node {
+        double       pos[3]; //!< Spatial coordinates of the vertex
+        GenVertexPtr vertex; //!< Indexed vertex
+    };
+
+    /** @brief Comparison of nodes along one axis */
+    struct AxisLess {
+        AxisLess(int a):axis(a) {}
+        bool operator()(const Node &a, const Node &b) const { return a.pos[axis] < b.pos[axis]; }
+        int axis; //!< Compared coordinate
+    };
+
+//
+// Helpers
+//
+private:
+    /** @brief Arrange nodes within [lo,hi) into k-d tree
+     *
+     *  Median of each range is its root, split along axis @a depth % 3
+     */
+    void build_tree(size_t lo, size_t hi, int depth);
+
+    /** @brief Collect nodes within [lo,hi) that lie within the box */
+    void find_in_box(size_t lo, size_t hi, int depth, const double *min, const double *max, vector<const Node*> &results) const;
+
+    /** @brief Find node within [lo,hi) closest to @a point */
+    void find_nearest(size_t lo, size_t hi, int depth, const double *point, const Node *&best, double &best_distance2) const;
+
+    /** @brief Squared distance of the node from @a point */
+    static double distance2(const Node &n, const double *point);
+
+//
+// Fields
+//
+private:
+    vector<Node> m_nodes; //!< Nodes of the implicit k-d tree
+};
+
+} // namespace HepMC
+
+#endif
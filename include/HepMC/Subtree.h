@@ -0,0 +1,113 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_SUBTREE_H
+#define HEPMC_SUBTREE_H
+///
+/// @file  Subtree.h
+/// @brief Definition of class \b Subtree
+///
+/// @class HepMC::Subtree
+/// @brief Part of the event below a particle, extracted as a standalone event
+///
+/// The standalone event holds a copy of the particle as its first particle,
+/// followed by copies of its descendants in topological order, together
+/// with their attributes and barcodes. Each copy is mapped to its original.
+/// After the standalone event is modified, e.g. by an afterburner, it can
+/// be spliced back in place of the original subtree in one operation
+/// (see GenEvent::replace_subtree()).
+///
+/// @code{.cpp}
+///     Subtree decay( tau );
+///
+///     process( decay.event() );  // works on the standalone event
+///
+///     decay.splice();            // replaces the decay of tau
+/// @endcode
+///
+/// Subtrees of different particles of the same event can be extracted and
+/// processed in parallel, as long as they do not overlap. Splicing modifies
+/// the event and has to be done sequentially.
+///
+/// @note Descendants of the particle must not have other ancestors
+///
+#include "HepMC/GenEvent.h"
+
+#if !defined(__CINT__)
+#include <unordered_map>
+#endif
+
+namespace HepMC {
+
+class Subtree {
+public:
+
+    /// @brief Default constructor creating empty subtree
+    Subtree() {}
+
+    /// @brief Extract subtree below particle @a p
+    explicit Subtree(const GenParticlePtr &p);
+
+    /// @brief Extract subtree below particle @a p
+    ///
+    /// Returns false and leaves the subtree empty if @a p does not belong
+    /// to an event or if its descendants have other ancestors
+    bool extract(const GenParticlePtr &p);
+
+    /// @brief Replace the original subtree with the content of event()
+    ///
+    /// Returns false if the subtree cannot be spliced, see
+    /// GenEvent::replace_subtree(). The subtree is empty afterwards.
+    bool splice();
+
+    /// @brief Remove content of the subtree
+    void clear();
+
+    /// @brief Standalone event holding the subtree
+    GenEvent&       event()       { return m_event; }
+
+    /// @brief Standalone event holding the subtree
+    const GenEvent& event() const { return m_event; }
+
+    /// @brief Particle the subtree was extracted from
+    const GenParticlePtr& origin() const { return m_origin; }
+
+    /// @brief Copy of origin() in event()
+    GenParticlePtr head() const;
+
+    /// @brief Original counterpart of particle of event()
+    ///
+    /// Returns empty pointer for particles added after extraction
+    GenParticlePtr original(const GenParticlePtr &p) const;
+
+    /// @brief Original counterpart of vertex of event()
+    ///
+    /// Returns empty pointer for vertices added after extraction
+    GenVertexPtr original(const GenVertexPtr &v) const;
+
+private:
+
+    /// @brief Copy of a vertex waiting for its incoming particles
+    struct PendingVertex {
+        GenVertexPtr copy;      //!< Copy of the vertex
+        unsigned int remaining; //!< Number of incoming particles not copied yet
+    };
+
+    GenParticlePtr m_origin; //!< Particle the subtree was extracted from
+    GenEvent       m_event;  //!< Standalone event
+
+    std::unordered_map<const GenParticle*, GenParticlePtr> m_particles; //!< Original particles by copy
+    std::unordered_map<const GenVertex*,   GenVertexPtr>   m_vertices;  //!< Original vertices by copy
+
+    /// @name Buffers reused between extractions
+    //@{
+    std::unordered_map<const GenVertex*, PendingVertex> m_pending; //!< Copies of vertices by original
+    std::vector<GenVertexPtr>                           m_ready;   //!< Original vertices in topological order
+    //@}
+};
+
+} // namespace HepMC
+
+#endif
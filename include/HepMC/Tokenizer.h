@@ -0,0 +1,157 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_TOKENIZER_H
+#define HEPMC_TOKENIZER_H
+///
+/// @file  Tokenizer.h
+/// @brief Definition of class \b Tokenizer
+///
+/// @class HepMC::Tokenizer
+/// @brief Splitting of text lines into fields used by ASCII readers
+///
+/// Reads whitespace-separated fields of a line one after another. Numbers
+/// are parsed in a single pass, without first searching for the end of the
+/// field, and independently of the locale. Doubles are rounded correctly,
+/// giving the same result as strtod in the "C" locale. A number has to be
+/// followed by whitespace, the end of the line or one of the list
+/// separators ',' and ']', otherwise the field fails to parse.
+///
+/// Lines may be terminated either by a new line or by a null character,
+/// so lines of memory-mapped files can be parsed in place.
+///
+/// Errors are sticky: after a field fails to parse, all further reads
+/// return 0 and failed() returns true, so a line can be parsed completely
+/// before checking for errors:
+///
+/// @code{.cpp}
+///     Tokenizer tok(line+1);
+///     int    id = tok.read_int();
+///     double px = tok.read_double();
+///     if( tok.failed() ) return false;
+/// @endcode
+///
+/// @ingroup IO
+///
+#include <string>
+
+namespace HepMC {
+
+class Tokenizer {
+public:
+
+    /// @brief Constructor
+    ///
+    /// @param line Text terminated by new line or null character
+    explicit Tokenizer(const char *line): m_cursor(line), m_failed(false) {}
+
+    /// @brief Read integer field
+    int read_int() {
+        int value = 0;
+        if( !m_failed ) advance( parse_int( skip_spaces(), value ) );
+        return value;
+    }
+
+    /// @brief Read long integer field
+    long read_long() {
+        long value = 0;
+        if( !m_failed ) advance( parse_long( skip_spaces(), value ) );
+        return value;
+    }
+
+    /// @brief Read floating point field
+    double read_double() {
+        double value = 0.0;
+        if( !m_failed ) advance( parse_double( skip_spaces(), value ) );
+        return value;
+    }
+
+    /// @brief Read field up to the next whitespace as string
+    std::string read_string();
+
+    /// @brief Skip field up to the next whitespace
+    void skip_field();
+
+    /// @brief Skip whitespace and character @a c
+    ///
+    /// @return false, without changing state, if @a c is not the next character
+    bool skip(char c) {
+        if( m_failed || *skip_spaces() != c ) return false;
+        ++m_cursor;
+        return true;
+    }
+
+    /// @brief Check if only whitespace is left in the line
+    ///
+    /// Also true after a field failed to parse, so loops over fields end
+    bool at_end() {
+        if( m_failed ) return true;
+
+        char c = *skip_spaces();
+        return c == '\n' || c == '\0';
+    }
+
+    /// @brief Check if any field failed to parse
+    bool failed() const { return m_failed; }
+
+    /// @brief Mark line as invalid
+    void set_failed() { m_failed = true; }
+
+    /// @brief Current position in the line
+    const char* cursor() const { return m_cursor; }
+
+    /// @name Parsing of single values
+    ///
+    /// Parse value at @a s, without skipping whitespace.
+    /// @return Position after the value or NULL if there is no valid value
+    //@{
+
+    /// @brief Parse integer, failing on overflow
+    static const char* parse_int(const char *s, int &value);
+
+    /// @brief Parse long integer, failing on overflow
+    static const char* parse_long(const char *s, long &value);
+
+    /// @brief Parse floating point number, rounded to nearest
+    static const char* parse_double(const char *s, double &value);
+    //@}
+
+    /// @brief Find character @a c in line
+    ///
+    /// @return NULL if line ends first
+    static const char* find_in_line(const char *s, char c) {
+        for( ; *s != c; ++s ) {
+            if( *s == '\n' || *s == '\0' ) return NULL;
+        }
+        return s;
+    }
+
+    /// @brief Find end of line, i.e. the new line or null character
+    static const char* line_end(const char *s) {
+        while( *s != '\n' && *s != '\0' ) ++s;
+        return s;
+    }
+
+private:
+
+    /// @brief Skip spaces, tabs and carriage returns
+    const char* skip_spaces() {
+        while( *m_cursor == ' ' || *m_cursor == '\t' || *m_cursor == '\r' ) ++m_cursor;
+        return m_cursor;
+    }
+
+    /// @brief Move to @a next or mark line as invalid if it is NULL
+    void advance(const char *next) {
+        if( next ) m_cursor = next;
+        else       m_failed = true;
+    }
+
+    const char *m_cursor; //!< Current position in the line
+    bool        m_failed; //!< Has parsing of a field failed?
+};
+
+} // namespace HepMC
+
+#endif
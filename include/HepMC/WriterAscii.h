@@ -12,11 +12,20 @@
 /// @class HepMC::WriterAscii
 /// @brief GenEvent I/O serialization for structured text files
 ///
+/// Files are compressed by the codec selected by name or by the extension
+/// of the file name, see CompressedOutputStream.
+///
+/// Formatted events can be written to the output stream on a background
+/// thread, so that write_event() does not wait for the file system, see
+/// set_async().
+///
 /// @ingroup IO
 ///
 #include "HepMC/Writer.h"
 #include "HepMC/GenEvent.h"
 #include "HepMC/GenRunInfo.h"
+#include "HepMC/CompressedStream.h"
+#include "HepMC/EventIndex.h"
 #include <string>
 #include <fstream>
 
@@ -27,8 +36,14 @@ public:
 
     /// @brief Constructor
     /// @warning If file already exists, it will be cleared before writing
+    ///
+    /// @param filename Output file
+    /// @param run      Run information written before the first event
+    /// @param codec    Name of compression codec, empty to select it by the
+    ///                 extension of @a filename, "none" for no compression
     WriterAscii(const std::string& filename,
-		shared_ptr<GenRunInfo> run = shared_ptr<GenRunInfo>());
+		shared_ptr<GenRunInfo> run = shared_ptr<GenRunInfo>(),
+		const std::string& codec = "");
 
     /// @brief Constructor from ostream
     WriterAscii(std::ostream& stream,
@@ -46,14 +61,21 @@ public:
     void write_run_info();
 
     /// @brief Return status of the stream
-    bool failed() { return (bool)m_file.rdstate(); }
+    ///
+    /// In asynchronous mode errors of the background thread are reported
+    /// after the data has been written by it.
+    bool failed();
 
     /// @brief Close file stream
     void close();
 
     /// @brief Set output precision
     ///
-    /// So far available range is [2,24]. Default is 16.
+    /// Precision is the number of digits after the decimal point of
+    /// the exponential notation. So far available range is [2,24].
+    /// Default is 16, which like all values of 16 and above writes the
+    /// shortest representation that is read back exactly.
+    /// @see Formatter
     void set_precision(const int& prec ) {
         if (prec < 2 || prec > 24) return;
         m_precision = prec;
@@ -62,6 +84,67 @@ public:
     int precision() const {
         return m_precision;
     }
+
+    /// @brief Set order of particles and vertices in the output
+    ///
+    /// Events are written as if GenEvent::reorder() was called on them,
+    /// but they are not modified. Default is GenEvent::KEEP_ORDER.
+    /// GenEvent::BY_STATUS cannot be used, as particles have to follow
+    /// their production vertices.
+    void set_reorder_policy(GenEvent::ReorderPolicy policy);
+
+    /// @brief Return order of particles and vertices in the output
+    GenEvent::ReorderPolicy reorder_policy() const {
+        return m_reorder_policy;
+    }
+
+    /// @brief Write index of the events to @a filename when closing
+    ///
+    /// The offsets are known while writing, so the index costs no extra
+    /// pass over the file. Only events written after this call are indexed.
+    /// Requires an output stream with a known position, i.e. not std::cout.
+    /// Offsets in compressed files are those of the uncompressed data.
+    /// @see EventIndex
+    ///
+    /// @return false if positions in the output stream are unknown
+    bool set_index_filename(const std::string &filename);
+
+    /// @brief Compress output on worker threads
+    ///
+    /// The output is cut into blocks of @a block_size bytes, which are
+    /// compressed independently on @a threads worker threads and written
+    /// in order. Has to be called before the first event is written.
+    /// @see CompressedOutputStream::set_parallel()
+    ///
+    /// @return false if the output file is not compressed
+    bool set_parallel_compression(unsigned int threads, size_t block_size = 0);
+
+    /// @brief Write index of the compressed blocks to @a filename when closing
+    ///
+    /// With the block index and the index of events, readers seek events
+    /// by decompressing only the block containing them.
+    /// @see BlockIndex
+    ///
+    /// @return false if the output file is not compressed
+    bool set_block_index_filename(const std::string &filename);
+
+    /// @brief Write the output stream on a background thread
+    ///
+    /// Events are formatted into one buffer while filled buffers are
+    /// written to the output stream, and compressed if the file is, by a
+    /// background thread. write_event() waits only when @a queue_depth
+    /// buffers are waiting to be written. The buffers are passed on when
+    /// full, so data reaches the stream in chunks of the buffer size and
+    /// completely when the writer is closed.
+    ///
+    /// An output stream given to the constructor is used by the background
+    /// thread and must not be accessed otherwise until close().
+    ///
+    /// @param queue_depth Maximum number of buffers waiting to be written, 0 to write synchronously
+    void set_async(unsigned int queue_depth = 4);
+
+    /// @brief Maximum number of buffers waiting to be written, 0 if the stream is written synchronously
+    unsigned int async_queue_depth() const;
 private:
 
     /// @name Buffer management
@@ -98,6 +181,24 @@ private:
     //@}
 
 
+    /// @name Asynchronous output helpers
+    //@{
+
+    /// Background thread and buffers waiting to be written by it
+    struct AsyncOutput;
+
+    /// @brief Pass the buffer to the background thread and continue in a free one
+    void queue_buffer();
+
+    /// @brief Write queued buffers to the output stream until stopped
+    void run_async();
+
+    /// @brief Write all queued buffers and stop the background thread
+    void stop_async();
+
+    //@}
+
+
     /// @name Write helpers
     //@{
 
@@ -107,6 +208,11 @@ private:
     /// with separately.
     void write_string( const std::string &str );
 
+    /// @brief Inline function writing space and double with @a digits significant digits
+    ///
+    /// @see Formatter::format_double()
+    void write_double( double value, int digits );
+
     /// @brief Write vertex
     ///
     /// Helper routine for writing single vertex to file
@@ -117,16 +223,36 @@ private:
     /// Helper routine for writing single particle to file
     void write_particle(const GenParticlePtr &p, int second_field);
 
+    /// @brief Id of particle or vertex in the output
+    int output_id(int id) const {
+        if ( m_reorder_policy == GenEvent::KEEP_ORDER ) return id;
+        if ( id > 0 && id <= (int)m_particle_id.size() ) return m_particle_id[id-1];
+        if ( id < 0 && -id <= (int)m_vertex_id.size() )  return m_vertex_id[-id-1];
+        return id;
+    }
+
     //@}
 
 private:
 
-    std::ofstream m_file; //!< Output file
+    CompressedOutputStream m_file; //!< Output file
     std::ostream* m_stream; //!< Output stream
     int m_precision; //!< Output precision
     char* m_buffer;  //!< Stream buffer
     char* m_cursor;  //!< Cursor inside stream buffer
     unsigned long m_buffer_size; //!< Buffer size
+    std::streamoff m_start_offset; //!< Position in the output stream after the header, -1 if unknown
+    unsigned long long m_bytes_written; //!< Bytes written to the output stream after the header
+    AsyncOutput *m_async; //!< Background thread writing the stream, NULL if it is written synchronously
+
+    EventIndex  m_index;          //!< Index of events written
+    std::string m_index_filename; //!< File to write the index to, empty if none
+
+    GenEvent::ReorderPolicy m_reorder_policy; //!< Order of particles and vertices
+    std::vector<int> m_particle_order; //!< Particle ids in output order
+    std::vector<int> m_vertex_order;   //!< Vertex ids in output order
+    std::vector<int> m_particle_id;    //!< Output ids of particles by index
+    std::vector<int> m_vertex_id;      //!< Output ids of vertices by index
 
 };
 
@@ -12,11 +12,15 @@
 /// @class HepMC::WriterAsciiHepMC2
 /// @brief GenEvent I/O serialization for structured text files
 ///
+/// Files are compressed by the codec selected by name or by the extension
+/// of the file name, see CompressedOutputStream.
+///
 /// @ingroup IO
 ///
 #include "HepMC/Writer.h"
 #include "HepMC/GenEvent.h"
 #include "HepMC/GenRunInfo.h"
+#include "HepMC/CompressedStream.h"
 #include <string>
 #include <fstream>
 
@@ -29,8 +33,14 @@ public:
 
     /// @brief Constructor
     /// @warning If file already exists, it will be cleared before writing
+    ///
+    /// @param filename Output file
+    /// @param run      Run information written before the first event
+    /// @param codec    Name of compression codec, empty to select it by the
+    ///                 extension of @a filename, "none" for no compression
     WriterAsciiHepMC2(const std::string& filename,
-                      shared_ptr<GenRunInfo> run = shared_ptr<GenRunInfo>());
+                      shared_ptr<GenRunInfo> run = shared_ptr<GenRunInfo>(),
+                      const std::string& codec = "");
 
     /// @brief Constructor from ostream
     WriterAsciiHepMC2(std::ostream& stream,
@@ -55,7 +65,11 @@ public:
 
     /// @brief Set output precision
     ///
-    /// Available range is [2,24]. Default is 16.
+    /// Precision is the number of digits after the decimal point of
+    /// the exponential notation. Available range is [2,24]. Default is 16,
+    /// which like all values of 16 and above writes the shortest
+    /// representation that is read back exactly.
+    /// @see Formatter
     void set_precision( const int& prec )
     {
         if (prec < 2 || prec > 24) return;
@@ -111,6 +125,11 @@ private:
     /// with separately.
     void write_string( const std::string &str );
 
+    /// @brief Inline function writing space and double with @a digits significant digits
+    ///
+    /// @see Formatter::format_double()
+    void write_double( double value, int digits );
+
     /// @brief Write vertex
     ///
     /// Helper routine for writing single vertex to file
@@ -121,17 +140,24 @@ private:
     /// Helper routine for writing single particle to file
     void write_particle(const GenParticlePtr &p, int second_field);
 
+    /// @brief Barcode of the vertex
+    ///
+    /// HepMC2 barcode stored in the event (see GenEvent::barcode()) or vertex id
+    /// if not all particles and vertices of the event have barcodes
+    int vertex_barcode(const GenVertexPtr &v);
+
     //@}
 
 private:
 
-    std::ofstream m_file; //!< Output file
+    CompressedOutputStream m_file; //!< Output file
     std::ostream* m_stream; //!< Output stream
     int m_precision; //!< Output precision
     char* m_buffer;  //!< Stream buffer
     char* m_cursor;  //!< Cursor inside stream buffer
     unsigned long m_buffer_size; //!< Buffer size
     unsigned long m_particle_counter; //!< Used to set bar codes
+    bool m_use_barcodes; //!< Write barcodes stored in the event
 
 };
 
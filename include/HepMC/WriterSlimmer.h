@@ -0,0 +1,64 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+#ifndef HEPMC_WRITERSLIMMER_H
+#define HEPMC_WRITERSLIMMER_H
+///
+/// @file  WriterSlimmer.h
+/// @brief Definition of class \b WriterSlimmer
+///
+/// @class HepMC::WriterSlimmer
+/// @brief Writer slimming events before passing them to another writer
+///
+/// Each event is reduced using EventSlimmer and written by the wrapped
+/// writer. The slimmed event is reused between events.
+///
+/// @code{.cpp}
+///     shared_ptr<Writer> output = make_shared<WriterAscii>("slim.hepmc");
+///     WriterSlimmer      writer( output, EventSlimmer( IS_STABLE ) );
+///
+///     // event loop
+///     writer.write_event( event );
+/// @endcode
+///
+/// @ingroup IO
+///
+#include "HepMC/Writer.h"
+#include "HepMC/GenEvent.h"
+#include "HepMC/EventSlimmer.h"
+
+namespace HepMC {
+
+class WriterSlimmer : public Writer {
+public:
+
+    /// @brief Constructor
+    ///
+    /// If @a run is set, it replaces run info of the slimmed events
+    WriterSlimmer(shared_ptr<Writer> output, const EventSlimmer &slimmer,
+                  shared_ptr<GenRunInfo> run = shared_ptr<GenRunInfo>());
+
+    /// @brief Slim event and write it using the wrapped writer
+    void write_event(const GenEvent &evt);
+
+    /// @brief Return status of the wrapped writer
+    bool failed();
+
+    /// @brief Close the wrapped writer
+    void close();
+
+    /// @brief Access the slimmer used for events
+    EventSlimmer& slimmer() { return m_slimmer; }
+
+private:
+
+    shared_ptr<Writer> m_output;  //!< Wrapped writer
+    EventSlimmer       m_slimmer; //!< Slimming engine
+    GenEvent           m_event;   //!< Slimmed event
+};
+
+} // namespace HepMC
+
+#endif
@@ -43,10 +43,11 @@ std::vector<TauolaParticle*> TauolaHepMC3Event::findParticles(int pdg_id){
 
   if(m_tau_list.size()==0){
 
-    //loop over all particle in the event looking for taus (or other)
-    for( unsigned int i=0; i<m_event->particles().size(); ++i) {
-      if(abs((m_event->particles()[i])->pid())==pdg_id)
-        m_tau_list.push_back(new TauolaHepMC3Particle(m_event->particles()[i]));
+    //use particle index of the event to find taus (or other)
+    std::vector<HepMC::GenParticlePtr> particles = m_event->particles_with_abs_pid(pdg_id);
+
+    for( unsigned int i=0; i<particles.size(); ++i) {
+      m_tau_list.push_back(new TauolaHepMC3Particle(particles[i]));
     }
   }
   return m_tau_list;
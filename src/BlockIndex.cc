@@ -0,0 +1,161 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file BlockIndex.cc
+/// @brief Implementation of \b class BlockIndex
+///
+#include "HepMC/BlockIndex.h"
+
+#include "HepMC/Setup.h"
+#include "HepMC/Errors.h"
+#include <cstring>
+#include <fstream>
+
+namespace HepMC {
+
+namespace {
+
+/// @brief Magic bytes at the start of sidecar files
+const char   index_magic[8]  = { 'H','e','p','M','C','B','l','k' };
+
+/// @brief Version of the sidecar file layout
+const uint32_t index_version = 1;
+
+/// @brief Size of one block in sidecar files
+const size_t entry_size = 16;
+
+void put_uint32(char *p, uint32_t value) {
+    for( int i = 0; i < 4; ++i ) p[i] = (char)( value >> (8*i) );
+}
+
+void put_uint64(char *p, uint64_t value) {
+    for( int i = 0; i < 8; ++i ) p[i] = (char)( value >> (8*i) );
+}
+
+uint32_t get_uint32(const char *p) {
+    uint32_t value = 0;
+    for( int i = 3; i >= 0; --i ) value = (value << 8) | (unsigned char)p[i];
+    return value;
+}
+
+uint64_t get_uint64(const char *p) {
+    uint64_t value = 0;
+    for( int i = 7; i >= 0; --i ) value = (value << 8) | (unsigned char)p[i];
+    return value;
+}
+
+} // namespace
+
+
+bool BlockIndex::read(const std::string &filename) {
+    clear();
+
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if( !file.is_open() ) {
+        ERROR( "BlockIndex: could not open index file: " << filename )
+        return false;
+    }
+
+    char header[32];
+    file.read( header, sizeof(header) );
+
+    if( !file || memcmp( header, index_magic, 8 ) != 0 ) {
+        ERROR( "BlockIndex: not a block index file: " << filename )
+        return false;
+    }
+
+    if( get_uint32(header+8) != index_version ) {
+        ERROR( "BlockIndex: unsupported version of index file: " << filename )
+        return false;
+    }
+
+    uint64_t count = get_uint64(header+24);
+
+    std::vector<char> data( count*entry_size );
+    if( count ) file.read( &data[0], data.size() );
+
+    if( (uint64_t)file.gcount() != count*entry_size ) {
+        ERROR( "BlockIndex: truncated index file: " << filename )
+        return false;
+    }
+
+    m_entries.reserve(count);
+
+    for( size_t i = 0; i < count; ++i ) {
+        const char *p = &data[i*entry_size];
+        add( get_uint64(p), get_uint64(p+8) );
+    }
+
+    m_file_size = get_uint64(header+16);
+
+    return true;
+}
+
+
+bool BlockIndex::write(const std::string &filename) const {
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !file.is_open() ) {
+        ERROR( "BlockIndex: could not open index file: " << filename )
+        return false;
+    }
+
+    char header[32];
+    memcpy( header, index_magic, 8 );
+    put_uint32( header+8,  index_version );
+    put_uint32( header+12, 0 );
+    put_uint64( header+16, m_file_size );
+    put_uint64( header+24, m_entries.size() );
+    file.write( header, sizeof(header) );
+
+    std::vector<char> data( m_entries.size()*entry_size );
+
+    for( size_t i = 0; i < m_entries.size(); ++i ) {
+        char *p = &data[i*entry_size];
+        put_uint64( p,   m_entries[i].offset );
+        put_uint64( p+8, m_entries[i].compressed_offset );
+    }
+
+    if( !data.empty() ) file.write( &data[0], data.size() );
+    file.close();
+
+    if( !file ) {
+        ERROR( "BlockIndex: error writing index file: " << filename )
+        return false;
+    }
+
+    return true;
+}
+
+
+void BlockIndex::add(uint64_t offset, uint64_t compressed_offset) {
+    Entry entry = { offset, compressed_offset };
+    m_entries.push_back(entry);
+}
+
+
+void BlockIndex::clear() {
+    m_file_size = 0;
+    m_entries.clear();
+}
+
+
+size_t BlockIndex::find(uint64_t offset) const {
+    size_t first = 0, count = m_entries.size();
+
+    // First block starting after offset
+    while( count > 0 ) {
+        size_t step = count/2;
+        if( m_entries[first+step].offset <= offset ) {
+            first += step+1;
+            count -= step+1;
+        }
+        else count = step;
+    }
+
+    return first > 0 ? first-1 : m_entries.size();
+}
+
+} // namespace HepMC
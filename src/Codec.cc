@@ -0,0 +1,207 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file Codec.cc
+/// @brief Implementation of \b class Codec and of the gzip codec
+///
+#include "HepMC/Codec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <climits>
+#include <mutex>
+#include <vector>
+
+#ifdef HEPMC_ZLIB
+#include <zlib.h>
+#endif
+
+namespace HepMC {
+
+const size_t Codec::magic_size;
+
+namespace {
+
+#ifdef HEPMC_ZLIB
+
+/// @brief Compression or decompression of gzip streams with zlib
+class GzipStream : public CodecStream {
+public:
+
+    GzipStream(bool compress, int level): m_compress(compress), m_finished(false) {
+        memset( &m_z, 0, sizeof(m_z) );
+
+        // Window bits above 15 select the gzip header and trailer
+        if( m_compress ) m_status = deflateInit2( &m_z, level < 0 ? Z_DEFAULT_COMPRESSION : level,
+                                                  Z_DEFLATED, 15+16, 8, Z_DEFAULT_STRATEGY );
+        else             m_status = inflateInit2( &m_z, 15+16 );
+    }
+
+    ~GzipStream() {
+        if( m_status == Z_OK || m_status == Z_STREAM_END ) {
+            if( m_compress ) deflateEnd(&m_z);
+            else             inflateEnd(&m_z);
+        }
+    }
+
+    bool process(const char *&in, const char *in_end, char *&out, char *out_end, bool finish) {
+        if( m_status != Z_OK && m_status != Z_STREAM_END ) return false;
+
+        while( true ) {
+            // Next member of concatenated input
+            if( !m_compress && m_finished && in != in_end ) {
+                inflateReset(&m_z);
+                m_finished = false;
+            }
+
+            size_t in_size  = std::min<size_t>( in_end - in,   UINT_MAX );
+            size_t out_size = std::min<size_t>( out_end - out, UINT_MAX );
+
+            m_z.next_in   = (Bytef*)in;
+            m_z.avail_in  = in_size;
+            m_z.next_out  = (Bytef*)out;
+            m_z.avail_out = out_size;
+
+            int ret;
+            if( m_compress ) ret = deflate( &m_z, finish && in_size == (size_t)(in_end - in) ? Z_FINISH : Z_NO_FLUSH );
+            else             ret = inflate( &m_z, Z_NO_FLUSH );
+
+            in  += in_size  - m_z.avail_in;
+            out += out_size - m_z.avail_out;
+
+            if( ret == Z_STREAM_END ) m_finished = true;
+            else if( ret != Z_OK && ret != Z_BUF_ERROR ) {
+                m_status = ret;
+                return false;
+            }
+
+            // Continue while there is room for output and input or the end of the stream to write
+            bool more = ( out != out_end ) && ( in != in_end || ( m_compress && finish && !m_finished ) );
+            if( !more || ret == Z_BUF_ERROR ) break;
+        }
+
+        return true;
+    }
+
+    bool finished() const { return m_finished; }
+
+    std::string error() const {
+        if( m_z.msg ) return m_z.msg;
+
+        switch( m_status ) {
+            case Z_MEM_ERROR:     return "out of memory";
+            case Z_VERSION_ERROR: return "incompatible zlib version";
+            case Z_DATA_ERROR:    return "invalid compressed data";
+            default:              return "zlib error";
+        }
+    }
+
+private:
+
+    z_stream m_z;        //!< zlib state
+    bool     m_compress; //!< Compress or decompress?
+    int      m_status;   //!< Result of initialization or of the last failure
+    bool     m_finished; //!< End of member reached or written
+};
+
+
+/// @brief gzip format of zlib, files concatenated by cat are read as one
+class GzipCodec : public Codec {
+public:
+
+    std::string name()      const { return "gzip"; }
+    std::string extension() const { return ".gz"; }
+
+    bool matches(const char *data, size_t size) const {
+        return size >= 2 && (unsigned char)data[0] == 0x1f && (unsigned char)data[1] == 0x8b;
+    }
+
+    CodecStream* make_compressor(int level) const { return new GzipStream(true,level); }
+    CodecStream* make_decompressor()        const { return new GzipStream(false,-1); }
+};
+
+#endif
+
+
+/// @brief Registered codecs, initialized with the built-in ones
+class Registry {
+public:
+
+    Registry() {
+#ifdef HEPMC_ZLIB
+        codecs.push_back( make_shared<GzipCodec>() );
+#endif
+    }
+
+    std::mutex                      mutex;  //!< Protects the codecs
+    std::vector< shared_ptr<Codec> > codecs; //!< Codecs in order of registration
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+} // namespace
+
+
+void Codec::add(shared_ptr<Codec> codec) {
+    if( !codec ) return;
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock( r.mutex );
+
+    FOREACH( shared_ptr<Codec> &c, r.codecs ) {
+        if( c->name() == codec->name() ) {
+            c = codec;
+            return;
+        }
+    }
+
+    r.codecs.push_back(codec);
+}
+
+
+shared_ptr<Codec> Codec::find(const std::string &name) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock( r.mutex );
+
+    FOREACH( const shared_ptr<Codec> &c, r.codecs ) {
+        if( c->name() == name ) return c;
+    }
+
+    return shared_ptr<Codec>();
+}
+
+
+shared_ptr<Codec> Codec::find_extension(const std::string &filename) {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock( r.mutex );
+
+    FOREACH( const shared_ptr<Codec> &c, r.codecs ) {
+        std::string ext = c->extension();
+        if( !ext.empty() && filename.size() > ext.size()
+            && filename.compare( filename.size()-ext.size(), ext.size(), ext ) == 0 ) return c;
+    }
+
+    return shared_ptr<Codec>();
+}
+
+
+shared_ptr<Codec> Codec::find_magic(const char *data, size_t size) {
+    if( size > magic_size ) size = magic_size;
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock( r.mutex );
+
+    FOREACH( const shared_ptr<Codec> &c, r.codecs ) {
+        if( c->matches(data,size) ) return c;
+    }
+
+    return shared_ptr<Codec>();
+}
+
+} // namespace HepMC
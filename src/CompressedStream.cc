@@ -0,0 +1,812 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file CompressedStream.cc
+/// @brief Implementation of \b classes CompressedInputStream and CompressedOutputStream
+///
+#include "HepMC/CompressedStream.h"
+
+#include "HepMC/Setup.h"
+#include "HepMC/Errors.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace HepMC {
+
+namespace {
+
+/// @brief Size of blocks of decompressed data
+const size_t block_size = 1024*1024;
+
+/// @brief Number of blocks, the one being read and those decompressed ahead
+const size_t block_count = 4;
+
+/// @brief Size of reads from compressed files and of compressed output written at once
+const size_t chunk_size = 256*1024;
+
+} // namespace
+
+
+/// @brief Stream buffer filled with data decompressed on a background thread
+///
+/// Without codec the data is copied, which reads pipes ahead.
+class DecompressingBuffer : public std::streambuf {
+public:
+
+    /// @brief Constructor
+    ///
+    /// @param source Compressed data
+    /// @param codec  Codec of the data, NULL to copy it
+    /// @param prefix Data already read from @a source
+    DecompressingBuffer(std::streambuf *source, shared_ptr<Codec> codec, const std::string &prefix)
+      : m_source(source), m_codec(codec), m_prefix(prefix), m_stream(NULL),
+        m_input(chunk_size), m_in(NULL), m_in_end(NULL), m_source_end(false),
+        m_stop(false), m_done(false), m_current(NULL), m_offset(0)
+    {
+        for( size_t i = 0; i < block_count; ++i ) m_free.push_back( new Block(block_size) );
+        if( m_codec ) m_stream = m_codec->make_decompressor();
+        start();
+    }
+
+    ~DecompressingBuffer() {
+        stop();
+        if( m_current ) m_free.push_back(m_current);
+        for( size_t i = 0; i < m_ready.size(); ++i ) m_free.push_back(m_ready[i].first);
+        FOREACH( Block *block, m_free ) delete block;
+        delete m_stream;
+    }
+
+    /// @brief Restart decompression at the blocks of @a index when seeking
+    void set_index(const BlockIndex &index) { m_index = index; }
+
+protected:
+
+    /// @brief Make next decompressed block available
+    ///
+    /// @throw std::ios_base::failure if the data cannot be decompressed, which sets badbit
+    int_type underflow() {
+        if( gptr() < egptr() ) return traits_type::to_int_type(*gptr());
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if( m_current ) {
+            m_offset += egptr() - eback();
+            m_free.push_back(m_current);
+            m_current = NULL;
+            setg(NULL,NULL,NULL);
+            m_changed.notify_all();
+        }
+
+        while( m_ready.empty() && !m_done ) m_changed.wait(lock);
+
+        if( m_ready.empty() ) {
+            if( !m_error.empty() ) {
+                ERROR( "CompressedInputStream: " << m_error )
+                throw std::ios_base::failure( "CompressedInputStream: " + m_error );
+            }
+            return traits_type::eof();
+        }
+
+        m_current = m_ready.front().first;
+        char *begin = &(*m_current)[0];
+        setg( begin, begin, begin + m_ready.front().second );
+        m_ready.pop_front();
+
+        return traits_type::to_int_type(*begin);
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+        off_type position = m_offset + ( gptr() - eback() );
+
+        if( dir == std::ios_base::cur ) {
+            if( off == 0 && (which & std::ios_base::in) ) return pos_type(position);
+            return seekpos( pos_type(position + off), which );
+        }
+        if( dir == std::ios_base::beg ) return seekpos( pos_type(off), which );
+
+        // The size of the decompressed data is not known
+        return pos_type(off_type(-1));
+    }
+
+    pos_type seekpos(pos_type pos, std::ios_base::openmode which) {
+        off_type target = pos;
+        if( !(which & std::ios_base::in) || target < 0 ) return pos_type(off_type(-1));
+
+        // Restart at the block containing the target when seeking backward or beyond the next block
+        size_t block = m_index.find(target);
+        bool   jump  = block < m_index.size() && m_index[block].offset > m_offset + ( egptr() - eback() );
+
+        if( (unsigned long long)target < m_offset || jump ) {
+            if( !restart(block) ) return pos_type(off_type(-1));
+        }
+
+        // Decompress up to the target
+        while( (unsigned long long)target > m_offset + ( egptr() - eback() ) ) {
+            setg( eback(), egptr(), egptr() );
+            if( traits_type::eq_int_type( underflow(), traits_type::eof() ) ) return pos_type(off_type(-1));
+        }
+
+        setg( eback(), eback() + ( target - m_offset ), egptr() );
+        return pos;
+    }
+
+private:
+
+    typedef std::vector<char> Block; //!< Block of decompressed data
+
+    /// @brief Start background thread
+    void start() {
+        m_thread = std::thread( &DecompressingBuffer::run, this );
+    }
+
+    /// @brief Stop background thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_changed.notify_all();
+        if( m_thread.joinable() ) m_thread.join();
+        m_stop = false;
+    }
+
+    /// @brief Restart decompression at the start of block @a block of the index
+    ///
+    /// Starts at the beginning of the source if there is no such block
+    /// @return false if the source cannot be rewound
+    bool restart(size_t block) {
+        unsigned long long offset = 0, compressed_offset = 0;
+        if( block < m_index.size() ) {
+            offset            = m_index[block].offset;
+            compressed_offset = m_index[block].compressed_offset;
+        }
+
+        stop();
+
+        if( m_current ) m_free.push_back(m_current);
+        for( size_t i = 0; i < m_ready.size(); ++i ) m_free.push_back(m_ready[i].first);
+        m_ready.clear();
+        m_current = NULL;
+        setg(NULL,NULL,NULL);
+
+        if( m_source->pubseekpos( compressed_offset, std::ios_base::in ) != pos_type(compressed_offset) ) {
+            m_done  = true;
+            m_error = "cannot seek in input";
+            return false;
+        }
+
+        m_offset = offset;
+        m_prefix.clear();
+        m_in = m_in_end = NULL;
+        m_source_end = false;
+        m_done = false;
+        m_error.clear();
+
+        delete m_stream;
+        m_stream = m_codec ? m_codec->make_decompressor() : NULL;
+
+        start();
+        return true;
+    }
+
+    /// @brief Decompress into free blocks until the end of the data or until stopped
+    void run() {
+        while( true ) {
+            Block *block;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while( m_free.empty() && !m_stop ) m_changed.wait(lock);
+                if( m_stop ) return;
+
+                block = m_free.back();
+                m_free.pop_back();
+            }
+
+            size_t      size = 0;
+            std::string error;
+            bool        more = fill( *block, size, error );
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if( size ) m_ready.push_back( std::make_pair(block,size) );
+                else       m_free.push_back(block);
+
+                if( !more ) {
+                    m_done  = true;
+                    m_error = error;
+                }
+            }
+            m_changed.notify_all();
+
+            if( !more ) return;
+        }
+    }
+
+    /// @brief Fill @a block with decompressed data
+    ///
+    /// @param[out] size  Number of bytes written to @a block
+    /// @param[out] error Description of failure
+    /// @return false at the end of the data or on failure
+    bool fill(Block &block, size_t &size, std::string &error) {
+        char *begin = &block[0];
+        char *out   = begin;
+        char *end   = begin + block.size();
+        bool  more  = true;
+
+        while( out != end ) {
+            if( m_in == m_in_end && !m_source_end ) {
+                std::streamsize count = m_prefix.size();
+
+                if( count ) {
+                    memcpy( &m_input[0], m_prefix.data(), count );
+                    m_prefix.clear();
+                }
+                else count = m_source->sgetn( &m_input[0], m_input.size() );
+
+                if( count <= 0 ) {
+                    count = 0;
+                    m_source_end = true;
+                }
+                m_in     = &m_input[0];
+                m_in_end = m_in + count;
+            }
+
+            if( !m_stream ) {
+                if( m_in == m_in_end ) {
+                    more = false;
+                    break;
+                }
+                size_t count = std::min<size_t>( m_in_end - m_in, end - out );
+                memcpy( out, m_in, count );
+                m_in += count;
+                out  += count;
+                continue;
+            }
+
+            const char *in_before  = m_in;
+            char       *out_before = out;
+
+            if( !m_stream->process( m_in, m_in_end, out, end, m_source_end ) ) {
+                error = m_stream->error();
+                more  = false;
+                break;
+            }
+
+            if( m_in == in_before && out == out_before ) {
+                if( !m_source_end ) {
+                    if( m_in != m_in_end ) {
+                        error = "decompression makes no progress";
+                        more  = false;
+                        break;
+                    }
+                    continue;
+                }
+                if( !m_stream->finished() ) error = "unexpected end of compressed data";
+                more = false;
+                break;
+            }
+        }
+
+        size = out - begin;
+        return more;
+    }
+
+    std::streambuf   *m_source;     //!< Compressed data
+    shared_ptr<Codec> m_codec;      //!< Codec of the data, NULL if it is copied
+    std::string       m_prefix;     //!< Data read from the source before decompression started
+    CodecStream      *m_stream;     //!< Decompressor, NULL if the data is copied
+
+    std::vector<char> m_input;      //!< Data read from the source, used by the background thread
+    const char       *m_in;         //!< Start of data in m_input not yet decompressed
+    const char       *m_in_end;     //!< End of data in m_input
+    bool              m_source_end; //!< End of source reached
+
+    std::thread                          m_thread;  //!< Background thread
+    std::mutex                           m_mutex;   //!< Protects blocks and status
+    std::condition_variable              m_changed; //!< Signals new ready or free blocks and stopping
+    std::deque< std::pair<Block*,size_t> > m_ready; //!< Decompressed blocks and their sizes
+    std::vector<Block*>                  m_free;    //!< Blocks available for decompression
+    bool                                 m_stop;    //!< Has the background thread to stop?
+    bool                                 m_done;    //!< Has the background thread finished?
+    std::string                          m_error;   //!< Description of failure, empty if none
+
+    Block             *m_current; //!< Block being read, NULL before the first read
+    unsigned long long m_offset;  //!< Offset of the current block in the decompressed data
+    BlockIndex         m_index;   //!< Independently compressed blocks of the source, empty if unknown
+};
+
+
+/// @brief Stream buffer compressing data before passing it to a sink
+///
+/// Compresses a single stream on the calling thread, or blocks of data as
+/// independent streams on worker threads. Compressed blocks are written in
+/// order by the calling thread.
+class CompressingBuffer : public std::streambuf {
+public:
+
+    CompressingBuffer(std::streambuf *sink, shared_ptr<Codec> codec, int level)
+      : m_sink(sink), m_codec(codec), m_level(level), m_stream(codec->make_compressor(level)),
+        m_buffer(block_size), m_output(chunk_size), m_offset(0), m_compressed(0), m_failed(false),
+        m_block_size(block_size), m_stop(false)
+    {
+        setp( &m_buffer[0], &m_buffer[0] + m_buffer.size() );
+        m_index.add(0,0);
+    }
+
+    ~CompressingBuffer() {
+        stop_workers();
+        delete m_stream;
+        FOREACH( Task *task, m_tasks ) delete task;
+        FOREACH( Task *task, m_free )  delete task;
+    }
+
+    /// @brief Compress blocks on @a threads worker threads
+    ///
+    /// @return false if data has already been compressed
+    bool set_parallel(unsigned int threads, size_t size) {
+        if( m_offset > 0 || m_failed || !m_workers.empty() ) return false;
+        if( threads == 0 ) return true;
+
+        // Data written so far is kept for the first block
+        size_t used = pptr() - pbase();
+        m_block_size = std::max( size ? size : block_size, used );
+        m_buffer.resize(m_block_size);
+        setp( &m_buffer[0], &m_buffer[0] + m_buffer.size() );
+        pbump(used);
+
+        delete m_stream;
+        m_stream = NULL;
+        m_index.clear();
+
+        for( unsigned int i = 0; i < threads; ++i ) {
+            m_workers.push_back( std::thread( &CompressingBuffer::run_worker, this ) );
+        }
+
+        return true;
+    }
+
+    /// @brief Compress remaining data and write the end of the stream
+    ///
+    /// @return false if compression or writing failed
+    bool finish() {
+        bool finished = m_workers.empty() ? compress(true) : submit(true);
+        m_index.set_file_size(m_compressed);
+        return finished && m_sink->pubsync() == 0;
+    }
+
+    /// @brief Offsets of the blocks written
+    BlockIndex& index() { return m_index; }
+
+protected:
+
+    int_type overflow(int_type c) {
+        bool compressed = m_workers.empty() ? compress(false) : submit(false);
+        if( !compressed ) return traits_type::eof();
+
+        if( !traits_type::eq_int_type( c, traits_type::eof() ) ) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+
+        return traits_type::not_eof(c);
+    }
+
+    /// @brief Pass data compressed so far to the file
+    ///
+    /// Buffered data is not compressed, so that flushing does not cut blocks
+    int sync() {
+        if( m_failed ) return -1;
+        return m_sink->pubsync();
+    }
+
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+        if( off == 0 && dir == std::ios_base::cur && (which & std::ios_base::out) ) {
+            return pos_type( off_type( m_offset + ( pptr() - pbase() ) ) );
+        }
+        return pos_type(off_type(-1));
+    }
+
+private:
+
+    /// @brief Block of data compressed on a worker thread
+    struct Task {
+        enum Status { QUEUED, DONE, FAILED };
+
+        std::vector<char> input;  //!< Uncompressed data, not all of it used
+        size_t            size;   //!< Size of uncompressed data
+        std::vector<char> output; //!< Compressed data, not all of it used
+        size_t            length; //!< Size of compressed data
+        Status            status; //!< Status of compression
+        std::string       error;  //!< Description of failure
+    };
+
+    /// @brief Write @a size bytes at @a data to the sink
+    bool write(const char *data, size_t size) {
+        if( size && m_sink->sputn( data, size ) != (std::streamsize)size ) {
+            ERROR( "CompressedOutputStream: error writing compressed data" )
+            m_failed = true;
+            return false;
+        }
+        m_compressed += size;
+        return true;
+    }
+
+    /// @brief Compress the buffer into the single stream and write the output to the sink
+    ///
+    /// @param finish Write the end of the stream
+    bool compress(bool finish) {
+        if( m_failed ) return false;
+
+        const char *in     = pbase();
+        const char *in_end = pptr();
+
+        while( true ) {
+            const char *in_before = in;
+            char       *begin     = &m_output[0];
+            char       *out       = begin;
+            char       *end       = begin + m_output.size();
+
+            if( !m_stream->process( in, in_end, out, end, finish ) ) {
+                ERROR( "CompressedOutputStream: " << m_stream->error() )
+                m_failed = true;
+                return false;
+            }
+
+            if( !write( begin, out - begin ) ) return false;
+
+            if( in == in_end && ( finish ? m_stream->finished() : out != end ) ) break;
+
+            if( in == in_before && out == begin ) {
+                ERROR( "CompressedOutputStream: compression makes no progress" )
+                m_failed = true;
+                return false;
+            }
+        }
+
+        m_offset += in_end - pbase();
+        setp( &m_buffer[0], &m_buffer[0] + m_buffer.size() );
+
+        return true;
+    }
+
+    /// @brief Pass the buffer to the worker threads and write compressed blocks
+    ///
+    /// Waits while too many blocks are compressed ahead of writing.
+    /// @param finish Wait for all blocks
+    bool submit(bool finish) {
+        if( m_failed ) return false;
+
+        size_t size = pptr() - pbase();
+
+        // A file without data still holds one empty stream
+        if( size || ( finish && m_index.empty() && m_tasks.empty() ) ) {
+            Task *task;
+            if( m_free.empty() ) task = new Task();
+            else {
+                task = m_free.back();
+                m_free.pop_back();
+            }
+
+            task->input.swap(m_buffer);
+            task->size   = size;
+            task->status = Task::QUEUED;
+            m_tasks.push_back(task);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_queue.push_back(task);
+            }
+            m_work.notify_one();
+
+            m_offset += size;
+            m_buffer.resize(m_block_size);
+            setp( &m_buffer[0], &m_buffer[0] + m_buffer.size() );
+        }
+
+        return write_tasks( finish ? 0 : 2*m_workers.size() );
+    }
+
+    /// @brief Write compressed blocks in order until at most @a max_pending are left
+    bool write_tasks(size_t max_pending) {
+        uint64_t offset = m_offset;
+        for( size_t i = 0; i < m_tasks.size(); ++i ) offset -= m_tasks[i]->size;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        while( !m_tasks.empty() ) {
+            Task *task = m_tasks.front();
+
+            if( task->status == Task::QUEUED ) {
+                if( m_tasks.size() <= max_pending ) break;
+                m_task_done.wait(lock);
+                continue;
+            }
+
+            lock.unlock();
+
+            bool written = false;
+            if( task->status == Task::FAILED ) {
+                ERROR( "CompressedOutputStream: " << task->error )
+                m_failed = true;
+            }
+            else {
+                m_index.add( offset, m_compressed );
+                written = write( &task->output[0], task->length );
+            }
+            offset += task->size;
+
+            m_tasks.pop_front();
+            m_free.push_back(task);
+
+            if( !written ) return false;
+
+            lock.lock();
+        }
+
+        return true;
+    }
+
+    /// @brief Compress blocks until stopped
+    void run_worker() {
+        while( true ) {
+            Task *task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while( m_queue.empty() && !m_stop ) m_work.wait(lock);
+                if( m_stop ) return;
+
+                task = m_queue.front();
+                m_queue.pop_front();
+            }
+
+            Task::Status status = compress_block(*task) ? Task::DONE : Task::FAILED;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                task->status = status;
+            }
+            m_task_done.notify_all();
+        }
+    }
+
+    /// @brief Compress data of @a task as an independent stream
+    bool compress_block(Task &task) {
+        CodecStream *stream = m_codec->make_compressor(m_level);
+
+        const char *in     = task.size ? &task.input[0] : NULL;
+        const char *in_end = in + task.size;
+
+        if( task.output.size() < chunk_size ) task.output.resize(chunk_size);
+        size_t length = 0;
+        bool   ok     = true;
+
+        while( true ) {
+            char *out = &task.output[0] + length;
+            char *end = &task.output[0] + task.output.size();
+
+            if( !stream->process( in, in_end, out, end, true ) ) {
+                task.error = stream->error();
+                ok = false;
+                break;
+            }
+
+            length = out - &task.output[0];
+            if( stream->finished() ) break;
+
+            if( out == end ) task.output.resize( 2*task.output.size() );
+        }
+
+        task.length = length;
+        delete stream;
+        return ok;
+    }
+
+    /// @brief Stop worker threads, dropping blocks not yet compressed
+    void stop_workers() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_work.notify_all();
+        FOREACH( std::thread &worker, m_workers ) worker.join();
+        m_workers.clear();
+    }
+
+    std::streambuf    *m_sink;       //!< Destination of compressed data
+    shared_ptr<Codec>  m_codec;      //!< Codec of the data
+    int                m_level;      //!< Compression level
+    CodecStream       *m_stream;     //!< Compressor of the single stream, NULL with worker threads
+    std::vector<char>  m_buffer;     //!< Data not yet compressed
+    std::vector<char>  m_output;     //!< Compressed data of the single stream
+    unsigned long long m_offset;     //!< Uncompressed bytes before m_buffer
+    unsigned long long m_compressed; //!< Compressed bytes written
+    bool               m_failed;     //!< Has compression or writing failed?
+    BlockIndex         m_index;      //!< Offsets of the blocks written
+
+    size_t                   m_block_size; //!< Size of blocks compressed by workers
+    std::vector<std::thread> m_workers;    //!< Worker threads
+    std::deque<Task*>        m_tasks;      //!< Blocks not yet written, in order
+    std::vector<Task*>       m_free;       //!< Blocks available for reuse
+    std::mutex               m_mutex;      //!< Protects m_queue, m_stop and the status of blocks
+    std::condition_variable  m_work;       //!< Signals new blocks and stopping to workers
+    std::condition_variable  m_task_done;  //!< Signals compressed blocks
+    std::deque<Task*>        m_queue;      //!< Blocks not yet taken by workers
+    bool                     m_stop;       //!< Have the workers to stop?
+};
+
+
+CompressedInputStream::CompressedInputStream()
+  : std::istream(NULL), m_decompressor(NULL), m_file_size(-1)
+{
+    rdbuf(&m_file);
+}
+
+
+CompressedInputStream::CompressedInputStream(const std::string &filename)
+  : std::istream(NULL), m_decompressor(NULL), m_file_size(-1)
+{
+    rdbuf(&m_file);
+    open(filename);
+}
+
+
+CompressedInputStream::~CompressedInputStream() {
+    delete m_decompressor;
+}
+
+
+void CompressedInputStream::open(const std::string &filename) {
+    if( is_open() ) close();
+
+    if( !m_file.open( filename.c_str(), std::ios_base::in | std::ios_base::binary ) ) {
+        setstate(std::ios_base::failbit);
+        return;
+    }
+
+    m_file_size = m_file.pubseekoff( 0, std::ios_base::end, std::ios_base::in );
+    if( m_file_size >= 0 ) m_file.pubseekpos( 0, std::ios_base::in );
+
+    char magic[Codec::magic_size];
+    std::streamsize count = m_file.sgetn( magic, sizeof(magic) );
+    if( count < 0 ) count = 0;
+
+    m_codec = Codec::find_magic( magic, count );
+
+    // Pipes cannot be rewound, the bytes read are passed to the background thread
+    bool rewound = ( m_file.pubseekpos( 0, std::ios_base::in ) == std::streampos(0) );
+
+    if( m_codec || !rewound ) {
+        m_decompressor = new DecompressingBuffer( &m_file, m_codec, rewound ? std::string() : std::string(magic,count) );
+        rdbuf(m_decompressor);
+    }
+    else clear();
+}
+
+
+void CompressedInputStream::close() {
+    if( m_decompressor ) {
+        std::ios_base::iostate state = rdstate();
+        rdbuf(&m_file);
+        clear(state);
+
+        delete m_decompressor;
+        m_decompressor = NULL;
+    }
+
+    m_codec.reset();
+    m_file_size = -1;
+    if( !m_file.close() ) setstate(std::ios_base::failbit);
+}
+
+
+bool CompressedInputStream::load_block_index(const std::string &filename) {
+    if( !m_decompressor || !m_codec ) {
+        ERROR( "CompressedInputStream: block index requires compressed input: " << filename )
+        return false;
+    }
+
+    BlockIndex index;
+    if( !index.read(filename) ) return false;
+
+    if( m_file_size >= 0 && (uint64_t)m_file_size != index.file_size() ) {
+        ERROR( "CompressedInputStream: block index does not match size of the input: " << filename )
+        return false;
+    }
+
+    m_decompressor->set_index(index);
+    return true;
+}
+
+
+CompressedOutputStream::CompressedOutputStream()
+  : std::ostream(NULL), m_compressor(NULL)
+{
+    rdbuf(&m_file);
+}
+
+
+CompressedOutputStream::CompressedOutputStream(const std::string &filename, const std::string &codec, int level)
+  : std::ostream(NULL), m_compressor(NULL)
+{
+    rdbuf(&m_file);
+    open(filename,codec,level);
+}
+
+
+CompressedOutputStream::~CompressedOutputStream() {
+    if( is_open() ) close();
+}
+
+
+void CompressedOutputStream::open(const std::string &filename, const std::string &codec, int level) {
+    if( is_open() ) close();
+
+    shared_ptr<Codec> c;
+
+    if( codec.empty() ) c = Codec::find_extension(filename);
+    else if( codec != "none" ) {
+        c = Codec::find(codec);
+        if( !c ) {
+            ERROR( "CompressedOutputStream: unknown codec: " << codec )
+            setstate(std::ios_base::failbit);
+            return;
+        }
+    }
+
+    if( !m_file.open( filename.c_str(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary ) ) {
+        setstate(std::ios_base::failbit);
+        return;
+    }
+
+    m_codec = c;
+
+    if( m_codec ) {
+        m_compressor = new CompressingBuffer( &m_file, m_codec, level );
+        rdbuf(m_compressor);
+    }
+    else clear();
+}
+
+
+void CompressedOutputStream::close() {
+    if( m_compressor ) {
+        bool finished = m_compressor->finish();
+
+        if( !m_block_index_filename.empty() ) {
+            if( finished ) m_compressor->index().write(m_block_index_filename);
+            m_block_index_filename.clear();
+        }
+
+        std::ios_base::iostate state = rdstate();
+        rdbuf(&m_file);
+        clear( finished ? state : state | std::ios_base::badbit );
+
+        delete m_compressor;
+        m_compressor = NULL;
+    }
+
+    m_codec.reset();
+    if( !m_file.close() ) setstate(std::ios_base::failbit);
+}
+
+bool CompressedOutputStream::set_parallel(unsigned int threads, size_t block_size) {
+    return m_compressor && m_compressor->set_parallel(threads,block_size);
+}
+
+
+bool CompressedOutputStream::set_block_index_filename(const std::string &filename) {
+    if( !m_compressor ) return false;
+
+    m_block_index_filename = filename;
+    return true;
+}
+
+} // namespace HepMC
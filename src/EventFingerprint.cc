@@ -0,0 +1,241 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file EventFingerprint.cc
+/// @brief Implementation of \b class EventFingerprint
+///
+#include "HepMC/EventFingerprint.h"
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/GenVertex.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace HepMC {
+
+namespace {
+
+/// @brief Two independent 64-bit hashes
+struct Lanes {
+    uint64_t a; //!< First hash
+    uint64_t b; //!< Second hash
+
+    Lanes(uint64_t seed_a = 0x243f6a8885a308d3ULL, uint64_t seed_b = 0x13198a2e03707344ULL): a(seed_a), b(seed_b) {}
+
+    /// @brief Add hash of unordered content
+    void operator+=(const Lanes &rhs) { a += rhs.a; b += rhs.b; }
+};
+
+/// @brief Rotate bits left
+inline uint64_t rotl(uint64_t x, int r) {
+    return ( x << r ) | ( x >> (64-r) );
+}
+
+/// @brief Finalizer of MurmurHash3
+inline uint64_t mix(uint64_t k) {
+    k ^= k >> 33;
+    k *= 0xff51afd7ed558ccdULL;
+    k ^= k >> 33;
+    k *= 0xc4ceb9fe1a85ec53ULL;
+    k ^= k >> 33;
+    return k;
+}
+
+/// @brief Fold value into both lanes
+///
+/// Cheap step, bits are spread by finish() once the content is complete
+inline void fold(Lanes &h, uint64_t v) {
+    h.a = rotl( h.a ^ v, 27 ) * 0x9e3779b97f4a7c15ULL;
+    h.b = rotl( h.b + v, 31 ) * 0xc2b2ae3d27d4eb4fULL;
+}
+
+/// @brief Fold hash of other content into both lanes
+inline void fold(Lanes &h, const Lanes &v) {
+    h.a = rotl( h.a ^ v.a, 27 ) * 0x9e3779b97f4a7c15ULL;
+    h.b = rotl( h.b + v.b, 31 ) * 0xc2b2ae3d27d4eb4fULL;
+}
+
+/// @brief Spread bits of both lanes before the hash is summed with others
+inline void finish(Lanes &h) {
+    h.a = mix( h.a );
+    h.b = mix( h.b ^ 0x5851f42d4c957f2dULL );
+}
+
+/// @brief Fold string into both lanes
+void fold(Lanes &h, const std::string &s) {
+    uint64_t v = 0;
+    for(unsigned int i=0; i<s.size(); ++i) {
+        v = (v << 8) | (unsigned char)s[i];
+        if( i%8 == 7 ) { fold(h,v); v = 0; }
+    }
+
+    fold( h, v ^ ( (uint64_t)s.size() << 56 ) );
+}
+
+/// @brief Bits of double rounded to @a drop fewer bits of mantissa
+inline uint64_t quantize(double x, int drop) {
+    // Treat -0 as 0
+    if( x == 0 ) return 0;
+
+    uint64_t u;
+    std::memcpy( &u, &x, sizeof(u) );
+
+    if( drop <= 0 ) return u;
+
+    // Round to nearest, carry into exponent is fine
+    u += (uint64_t)1 << (drop-1);
+    return u & ~( ( (uint64_t)1 << drop ) - 1 );
+}
+
+/// @brief Fold four-vector scaled by @a scale
+inline void fold(Lanes &h, const FourVector &v, double scale, int drop) {
+    fold( h, quantize( v.x()*scale, drop ) );
+    fold( h, quantize( v.y()*scale, drop ) );
+    fold( h, quantize( v.z()*scale, drop ) );
+    fold( h, quantize( v.t()*scale, drop ) );
+}
+
+}
+
+
+EventFingerprint::EventFingerprint(const GenEvent &evt, int precision, int content) {
+
+    if( precision < 1  ) precision = 1;
+    if( precision > 52 ) precision = 52;
+
+    const int    drop           = 52 - precision;
+    const double momentum_scale = ( evt.momentum_unit() == Units::MEV ) ? 0.001 : 1.0;
+    const double length_scale   = ( evt.length_unit()   == Units::CM  ) ? 10.0  : 1.0;
+
+    const std::vector<GenParticlePtr> &particles = evt.particles();
+    const std::vector<GenVertexPtr>   &vertices  = evt.vertices();
+
+    Lanes total( 0, 0 );
+
+    // Attributes are hashed as part of their owner, so they do not depend on ids
+    std::vector<Lanes> particle_attributes;
+    std::vector<Lanes> vertex_attributes;
+
+    if( content & ATTRIBUTES ) {
+        particle_attributes.assign( particles.size(), Lanes(0,0) );
+        vertex_attributes.assign( vertices.size(), Lanes(0,0) );
+
+        Lanes event_attributes( 0, 0 );
+
+        typedef std::map< string, std::map<int, shared_ptr<Attribute> > >::value_type att_key_t;
+        typedef std::map<int, shared_ptr<Attribute> >::value_type att_val_t;
+
+        std::string st;
+
+        FOREACH( const att_key_t &vt1, evt.attributes() ) {
+            Lanes name;
+            fold( name, vt1.first );
+
+            FOREACH( const att_val_t &vt2, vt1.second ) {
+                int id = vt2.first;
+
+                if( !vt2.second || !vt2.second->to_string(st) ) continue;
+
+                Lanes h = name;
+                fold( h, st );
+                finish( h );
+
+                if     ( id > 0 && id <= (int)particles.size() ) particle_attributes[id-1] += h;
+                else if( id < 0 && -id <= (int)vertices.size() ) vertex_attributes[-id-1]  += h;
+                else if( id == 0 )                               event_attributes          += h;
+            }
+        }
+
+        fold( total, event_attributes );
+    }
+
+    // Particles
+    std::vector<Lanes> particle_hash( particles.size() );
+
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        const GenParticlePtr &p = particles[i];
+        Lanes &h = particle_hash[i];
+
+        fold( h, (uint64_t)(int64_t)p->pid() );
+        fold( h, (uint64_t)(int64_t)p->status() );
+        fold( h, p->momentum(), momentum_scale, drop );
+        fold( h, quantize( p->generated_mass()*momentum_scale, drop ) );
+
+        if( content & ATTRIBUTES ) fold( h, particle_attributes[i] );
+
+        finish( h );
+        total += h;
+    }
+
+    // Vertices with unordered sets of their incoming and outgoing particles
+    std::vector<char> produced( particles.size(), 0 );
+
+    for(unsigned int i=0; i<vertices.size(); ++i) {
+        const GenVertexPtr &v = vertices[i];
+
+        Lanes h( 0x452821e638d01377ULL, 0xbe5466cf34e90c6cULL );
+        fold( h, (uint64_t)(int64_t)v->status() );
+        fold( h, v->position(), length_scale, drop );
+
+        if( content & ATTRIBUTES ) fold( h, vertex_attributes[i] );
+
+        Lanes in( 0, 0 ), out( 0, 0 );
+
+        FOREACH( const GenParticlePtr &p, v->particles_in() ) {
+            if( p->parent_event() == &evt ) in += particle_hash[ p->id()-1 ];
+        }
+
+        FOREACH( const GenParticlePtr &p, v->particles_out() ) {
+            if( p->parent_event() != &evt ) continue;
+
+            out += particle_hash[ p->id()-1 ];
+            produced[ p->id()-1 ] = 1;
+        }
+
+        fold( h, in );
+        fold( h, out );
+
+        finish( h );
+        total += h;
+    }
+
+    Lanes root_out( 0, 0 );
+
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        if( !produced[i] ) root_out += particle_hash[i];
+    }
+
+    // Particles without production vertex and event position
+    Lanes root( 0xc0ac29b7c97c50ddULL, 0x3f84d5b5b5470917ULL );
+    fold( root, evt.event_pos(), length_scale, drop );
+    fold( root, root_out );
+    finish( root );
+    fold( total, root );
+
+    if( content & WEIGHTS ) {
+        FOREACH( double w, evt.weights() ) fold( total, quantize( w, drop ) );
+    }
+
+    fold( total, (uint64_t)particles.size() );
+    fold( total, (uint64_t)vertices.size() );
+    finish( total );
+
+    m_high = total.a;
+    m_low  = total.b;
+}
+
+
+std::string EventFingerprint::to_string() const {
+    char buf[33];
+    sprintf( buf, "%016llx%016llx", (unsigned long long)m_high, (unsigned long long)m_low );
+
+    return std::string(buf);
+}
+
+} // namespace HepMC
@@ -0,0 +1,397 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file EventIndex.cc
+/// @brief Implementation of \b class EventIndex
+///
+#include "HepMC/EventIndex.h"
+
+#include "HepMC/Setup.h"
+#include "HepMC/Errors.h"
+#include "HepMC/Tokenizer.h"
+#include "HepMC/CompressedStream.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace HepMC {
+
+namespace {
+
+/// @brief Magic bytes at the start of sidecar files
+const char   index_magic[8]  = { 'H','e','p','M','C','I','d','x' };
+
+/// @brief Version of the sidecar file layout
+const uint32_t index_version = 1;
+
+/// @brief Size of one event in sidecar files
+const size_t entry_size = 20;
+
+/// @brief Size of blocks read when building the index
+const size_t scan_block_size = 4*1024*1024;
+
+void put_uint32(char *p, uint32_t value) {
+    for( int i = 0; i < 4; ++i ) p[i] = (char)( value >> (8*i) );
+}
+
+void put_uint64(char *p, uint64_t value) {
+    for( int i = 0; i < 8; ++i ) p[i] = (char)( value >> (8*i) );
+}
+
+uint32_t get_uint32(const char *p) {
+    uint32_t value = 0;
+    for( int i = 3; i >= 0; --i ) value = (value << 8) | (unsigned char)p[i];
+    return value;
+}
+
+uint64_t get_uint64(const char *p) {
+    uint64_t value = 0;
+    for( int i = 7; i >= 0; --i ) value = (value << 8) | (unsigned char)p[i];
+    return value;
+}
+
+/// @brief Check if @a line opens an LHEF event, i.e. is "<event>" or "<event ...>"
+bool is_lhef_event(const char *line) {
+    while( *line == ' ' || *line == '\t' ) ++line;
+    if( strncmp(line,"<event",6) != 0 ) return false;
+
+    char c = line[6];
+    return c == '>' || c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/// @brief Check if @a line opens an LHEF file
+bool is_lhef_start(const char *line) {
+    while( *line == ' ' || *line == '\t' ) ++line;
+    return strncmp(line,"<LesHouchesEvents",17) == 0;
+}
+
+/// @brief Single pass over the lines of a file, adding its events to an index
+///
+/// The counts of HepMC2 particles and of LHEF particles are only known
+/// after the line opening the event, so the event is added to the index
+/// when the next one starts or when the scan is finished.
+class Scanner {
+public:
+
+    explicit Scanner(EventIndex &index): m_index(index), m_pending(false), m_lhef_nup(false) {
+        EventIndex::Entry empty = { 0, 0, 0, 0 };
+        m_entry = empty;
+    }
+
+    /// @brief Process @a line, terminated by new line, which starts at @a offset
+    void scan_line(const char *line, uint64_t offset) {
+        switch( m_index.format() ) {
+            case EventIndex::UNKNOWN:
+                if( is_lhef_start(line) ) m_index.set_format(EventIndex::LHEF);
+                else if( line[0] == 'E' ) {
+                    m_index.set_format( event_line_format(line) );
+                    scan_line(line,offset);
+                }
+                break;
+            case EventIndex::HEPMC3:
+                if( line[0] == 'E' ) {
+                    Tokenizer tok(line+1);
+                    int event_number = tok.read_int();
+                    int vertices     = tok.read_int();
+                    int particles    = tok.read_int();
+                    if( tok.failed() ) {
+                        WARNING( "EventIndex: invalid event line at offset " << offset )
+                        break;
+                    }
+                    m_index.add(offset,event_number,particles,vertices);
+                }
+                break;
+            case EventIndex::HEPMC2:
+                if( line[0] == 'P' ) ++m_entry.particles;
+                else if( line[0] == 'E' ) {
+                    finish();
+                    Tokenizer tok(line+1);
+                    m_entry.offset       = offset;
+                    m_entry.event_number = tok.read_int();
+                    tok.skip_field(); // mpi
+                    tok.skip_field(); // scale
+                    tok.skip_field(); // alpha_qcd
+                    tok.skip_field(); // alpha_qed
+                    tok.skip_field(); // signal_process_id
+                    tok.skip_field(); // signal_process_vertex
+                    m_entry.vertices     = tok.read_int();
+                    m_entry.particles    = 0;
+                    if( tok.failed() ) {
+                        WARNING( "EventIndex: invalid event line at offset " << offset )
+                        break;
+                    }
+                    m_pending = true;
+                }
+                break;
+            case EventIndex::LHEF:
+                if( m_lhef_nup ) {
+                    Tokenizer tok(line);
+                    if( tok.at_end() ) break;
+                    m_entry.particles = tok.read_int();
+                    if( tok.failed() ) m_entry.particles = 0;
+                    m_lhef_nup = false;
+                }
+                else if( is_lhef_event(line) ) {
+                    finish();
+                    m_entry.offset       = offset;
+                    m_entry.event_number = m_index.size();
+                    m_entry.particles    = 0;
+                    m_entry.vertices     = 0;
+                    m_pending  = true;
+                    m_lhef_nup = true;
+                }
+                break;
+        }
+    }
+
+    /// @brief Add the last event to the index
+    void finish() {
+        if( !m_pending ) return;
+        m_index.add(m_entry.offset,m_entry.event_number,m_entry.particles,m_entry.vertices);
+        m_pending = false;
+    }
+
+private:
+
+    /// @brief Format of file which has @a line as its first event line
+    ///
+    /// HepMC3 event lines have three integers optionally followed by the
+    /// event position, HepMC2 event lines have many more fields
+    static EventIndex::Format event_line_format(const char *line) {
+        Tokenizer tok(line+1);
+        tok.read_int();
+        tok.read_int();
+        tok.read_int();
+        if( tok.failed() ) return EventIndex::HEPMC2;
+        if( tok.at_end() || tok.skip('@') ) return EventIndex::HEPMC3;
+        return EventIndex::HEPMC2;
+    }
+
+    EventIndex       &m_index;    //!< Index being built
+    EventIndex::Entry m_entry;    //!< Event of which the counts are not yet known
+    bool              m_pending;  //!< Is m_entry waiting to be added?
+    bool              m_lhef_nup; //!< Is the next line the LHEF event information?
+};
+
+} // namespace
+
+
+bool EventIndex::build(const std::string &filename) {
+    clear();
+
+    CompressedInputStream file(filename);
+    if( !file.is_open() ) {
+        ERROR( "EventIndex: could not open input file: " << filename )
+        return false;
+    }
+
+    Scanner           scanner(*this);
+    std::vector<char> buffer(scan_block_size+1);
+    uint64_t          block_offset = 0; // offset of buffer[0] in the file
+    size_t            used         = 0; // characters in buffer
+    uint64_t          file_size    = 0;
+
+    while( true ) {
+        if( used == buffer.size()-1 ) buffer.resize( 2*buffer.size() ); // line longer than buffer
+
+        file.read( &buffer[used], buffer.size()-1-used );
+        size_t count = file.gcount();
+        bool   at_eof = ( count == 0 );
+
+        used      += count;
+        file_size += count;
+
+        // At the end of the file an unterminated last line is completed
+        if( at_eof ) {
+            if( used == 0 ) break;
+            buffer[used++] = '\n';
+        }
+
+        const char *begin = &buffer[0];
+        const char *end   = begin + used;
+        const char *line  = begin;
+
+        while( true ) {
+            const char *eol = (const char*)memchr( line, '\n', end-line );
+            if( !eol ) break;
+
+            scanner.scan_line( line, block_offset + (line-begin) );
+            line = eol + 1;
+        }
+
+        size_t consumed = line - begin;
+        block_offset += consumed;
+        used         -= consumed;
+        if( used ) memmove( &buffer[0], line, used );
+
+        if( at_eof ) break;
+    }
+
+    scanner.finish();
+
+    if( file.bad() ) {
+        ERROR( "EventIndex: error reading input file: " << filename )
+        clear();
+        return false;
+    }
+
+    if( m_format == UNKNOWN ) {
+        ERROR( "EventIndex: unknown format of input file: " << filename )
+        return false;
+    }
+
+    m_file_size = file_size;
+
+    return true;
+}
+
+
+bool EventIndex::read(const std::string &filename) {
+    clear();
+
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    if( !file.is_open() ) {
+        ERROR( "EventIndex: could not open index file: " << filename )
+        return false;
+    }
+
+    char header[32];
+    file.read( header, sizeof(header) );
+
+    if( !file || memcmp( header, index_magic, 8 ) != 0 ) {
+        ERROR( "EventIndex: not an index file: " << filename )
+        return false;
+    }
+
+    if( get_uint32(header+8) != index_version ) {
+        ERROR( "EventIndex: unsupported version of index file: " << filename )
+        return false;
+    }
+
+    uint32_t format = get_uint32(header+12);
+    if( format > LHEF ) {
+        ERROR( "EventIndex: unknown format in index file: " << filename )
+        return false;
+    }
+
+    uint64_t count = get_uint64(header+24);
+
+    std::vector<char> data( count*entry_size );
+    if( count ) file.read( &data[0], data.size() );
+
+    if( (uint64_t)file.gcount() != count*entry_size ) {
+        ERROR( "EventIndex: truncated index file: " << filename )
+        return false;
+    }
+
+    m_entries.reserve(count);
+
+    for( size_t i = 0; i < count; ++i ) {
+        const char *p = &data[i*entry_size];
+        add( get_uint64(p), (int)get_uint32(p+8), (int)get_uint32(p+12), (int)get_uint32(p+16) );
+    }
+
+    m_format    = (Format)format;
+    m_file_size = get_uint64(header+16);
+
+    return true;
+}
+
+
+bool EventIndex::write(const std::string &filename) const {
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if( !file.is_open() ) {
+        ERROR( "EventIndex: could not open index file: " << filename )
+        return false;
+    }
+
+    char header[32];
+    memcpy( header, index_magic, 8 );
+    put_uint32( header+8,  index_version );
+    put_uint32( header+12, m_format );
+    put_uint64( header+16, m_file_size );
+    put_uint64( header+24, m_entries.size() );
+    file.write( header, sizeof(header) );
+
+    std::vector<char> data( m_entries.size()*entry_size );
+
+    for( size_t i = 0; i < m_entries.size(); ++i ) {
+        char *p = &data[i*entry_size];
+        put_uint64( p,    m_entries[i].offset );
+        put_uint32( p+8,  m_entries[i].event_number );
+        put_uint32( p+12, m_entries[i].particles );
+        put_uint32( p+16, m_entries[i].vertices );
+    }
+
+    if( !data.empty() ) file.write( &data[0], data.size() );
+    file.close();
+
+    if( !file ) {
+        ERROR( "EventIndex: error writing index file: " << filename )
+        return false;
+    }
+
+    return true;
+}
+
+
+void EventIndex::add(uint64_t offset, int event_number, int particles, int vertices) {
+    if( !m_entries.empty() && event_number <= m_entries.back().event_number ) m_sorted = false;
+
+    Entry entry = { offset, event_number, particles, vertices };
+    m_entries.push_back(entry);
+}
+
+
+void EventIndex::clear() {
+    m_format    = UNKNOWN;
+    m_file_size = 0;
+    m_sorted    = true;
+    m_entries.clear();
+}
+
+
+size_t EventIndex::find(int event_number) const {
+    if( m_sorted ) {
+        size_t first = 0, count = m_entries.size();
+
+        while( count > 0 ) {
+            size_t step = count/2;
+            if( m_entries[first+step].event_number < event_number ) {
+                first += step+1;
+                count -= step+1;
+            }
+            else count = step;
+        }
+
+        if( first < m_entries.size() && m_entries[first].event_number == event_number ) return first;
+        return m_entries.size();
+    }
+
+    for( size_t i = 0; i < m_entries.size(); ++i ) {
+        if( m_entries[i].event_number == event_number ) return i;
+    }
+
+    return m_entries.size();
+}
+
+
+size_t EventIndex::position(uint64_t offset) const {
+    size_t first = 0, count = m_entries.size();
+
+    while( count > 0 ) {
+        size_t step = count/2;
+        if( m_entries[first+step].offset < offset ) {
+            first += step+1;
+            count -= step+1;
+        }
+        else count = step;
+    }
+
+    return first;
+}
+
+} // namespace HepMC
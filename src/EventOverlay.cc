@@ -0,0 +1,275 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file EventOverlay.cc
+/// @brief Implementation of \b class EventOverlay
+///
+#include "HepMC/EventOverlay.h"
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/GenVertex.h"
+#include "HepMC/Data/GenEventData.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace HepMC {
+
+
+EventOverlay::EventOverlay(GenEvent &event)
+    : m_event(&event) {
+
+    // Existing content is the first sub-collision
+    if( !event.particles().empty() || !event.vertices().empty() ) {
+        m_first_particle.push_back(  1 );
+        m_first_vertex.push_back  ( -1 );
+    }
+}
+
+
+int EventOverlay::begin_block() {
+    m_first_particle.push_back(  (int)m_event->particles().size() + 1 );
+    m_first_vertex.push_back  ( -(int)m_event->vertices().size()  - 1 );
+
+    return m_first_particle.size() - 1;
+}
+
+
+int EventOverlay::add(const GenEvent &in, const FourVector &shift) {
+
+    if( &in == m_event ) {
+        ERROR( "EventOverlay::add: cannot add event to itself" )
+        return -1;
+    }
+
+    GenEvent &out = *m_event;
+
+    const vector<GenParticlePtr> &particles = in.particles();
+    const vector<GenVertexPtr>   &vertices  = in.vertices();
+
+    const int particle_offset = out.m_particles.size();
+    const int vertex_offset   = out.m_vertices.size();
+
+    int block = begin_block();
+
+    const bool convert_momentum = in.momentum_unit() != out.momentum_unit();
+    const bool convert_length   = in.length_unit()   != out.length_unit();
+
+    FOREACH( const GenParticlePtr &p, particles ) {
+        GenParticlePtr pc = make_shared<GenParticle>( p->data() );
+
+        if( convert_momentum ) Units::convert( pc->m_data.momentum, in.momentum_unit(), out.momentum_unit() );
+
+        out.m_particles.push_back(pc);
+
+        pc->m_event = &out;
+        pc->m_id    = out.m_particles.size();
+    }
+
+    FOREACH( const GenVertexPtr &v, vertices ) {
+        GenVertexPtr vc = make_shared<GenVertex>( v->data() );
+
+        if( vc->has_set_position() ) {
+            if( convert_length ) Units::convert( vc->m_data.position, in.length_unit(), out.length_unit() );
+            vc->m_data.position += shift;
+        }
+
+        out.m_vertices.push_back(vc);
+
+        vc->m_event = &out;
+        vc->m_id    = -(int)out.m_vertices.size();
+
+        shared_ptr<GenVertex> vertex = vc->m_this.lock();
+
+        vc->m_particles_in.reserve( v->particles_in().size() );
+        FOREACH( const GenParticlePtr &p, v->particles_in() ) {
+            GenParticlePtr pc = out.m_particles[ particle_offset + p->id() - 1 ];
+
+            vc->m_particles_in.push_back(pc);
+            pc->set_end_vertex(vertex);
+        }
+
+        vc->m_particles_out.reserve( v->particles_out().size() );
+        FOREACH( const GenParticlePtr &p, v->particles_out() ) {
+            GenParticlePtr pc = out.m_particles[ particle_offset + p->id() - 1 ];
+
+            vc->m_particles_out.push_back(pc);
+            pc->set_production_vertex(vertex);
+        }
+    }
+
+    // Particles without production vertex are attached to the root vertex
+    shared_ptr<GenVertex> root = out.m_rootvertex->m_this.lock();
+
+    for(unsigned int i=particle_offset; i<out.m_particles.size(); ++i) {
+        GenParticlePtr &p = out.m_particles[i];
+        if( p->production_vertex_ptr() ) continue;
+
+        out.m_rootvertex->m_particles_out.push_back(p);
+        p->set_production_vertex(root);
+    }
+
+    FourVector pos = in.event_pos();
+    if( convert_length ) Units::convert( pos, in.length_unit(), out.length_unit() );
+
+    place_vertices( vertex_offset, pos + shift );
+
+    // Attributes of particles and vertices with shifted ids
+    typedef std::map< string, std::map<int, shared_ptr<Attribute> > >::value_type att_key_t;
+    typedef std::map<int, shared_ptr<Attribute> >::value_type att_val_t;
+
+    FOREACH( const att_key_t &vt1, in.attributes() ) {
+        FOREACH( const att_val_t &vt2, vt1.second ) {
+            int id = vt2.first;
+
+            if     ( id > 0 ) out.add_attribute( vt1.first, vt2.second, id + particle_offset );
+            else if( id < 0 ) out.add_attribute( vt1.first, vt2.second, id - vertex_offset   );
+        }
+    }
+
+    out.reset_indexes();
+
+    return block;
+}
+
+
+int EventOverlay::add(const GenEventData &in, const FourVector &shift) {
+
+    GenEvent &out = *m_event;
+
+    const int particle_offset = out.m_particles.size();
+    const int vertex_offset   = out.m_vertices.size();
+
+    int block = begin_block();
+
+    const bool convert_momentum = in.momentum_unit != out.momentum_unit();
+    const bool convert_length   = in.length_unit   != out.length_unit();
+
+    FOREACH( const GenParticleData &pd, in.particles ) {
+        GenParticlePtr pc = make_shared<GenParticle>(pd);
+
+        if( convert_momentum ) Units::convert( pc->m_data.momentum, in.momentum_unit, out.momentum_unit() );
+
+        out.m_particles.push_back(pc);
+
+        pc->m_event = &out;
+        pc->m_id    = out.m_particles.size();
+    }
+
+    FOREACH( const GenVertexData &vd, in.vertices ) {
+        GenVertexPtr vc = make_shared<GenVertex>(vd);
+
+        if( vc->has_set_position() ) {
+            if( convert_length ) Units::convert( vc->m_data.position, in.length_unit, out.length_unit() );
+            vc->m_data.position += shift;
+        }
+
+        out.m_vertices.push_back(vc);
+
+        vc->m_event = &out;
+        vc->m_id    = -(int)out.m_vertices.size();
+    }
+
+    // Restore links
+    for(unsigned int i=0; i<in.links1.size(); ++i) {
+        int id1 = in.links1[i];
+        int id2 = in.links2[i];
+
+        if( id1 > 0 ) {
+            GenVertexPtr   &v = out.m_vertices [ vertex_offset   - id2 - 1 ];
+            GenParticlePtr &p = out.m_particles[ particle_offset + id1 - 1 ];
+
+            v->m_particles_in.push_back(p);
+            p->set_end_vertex( v->m_this.lock() );
+        }
+        else {
+            GenVertexPtr   &v = out.m_vertices [ vertex_offset   - id1 - 1 ];
+            GenParticlePtr &p = out.m_particles[ particle_offset + id2 - 1 ];
+
+            v->m_particles_out.push_back(p);
+            p->set_production_vertex( v->m_this.lock() );
+        }
+    }
+
+    // Particles without production vertex are attached to the root vertex
+    shared_ptr<GenVertex> root = out.m_rootvertex->m_this.lock();
+
+    for(unsigned int i=particle_offset; i<out.m_particles.size(); ++i) {
+        GenParticlePtr &p = out.m_particles[i];
+        if( p->production_vertex_ptr() ) continue;
+
+        out.m_rootvertex->m_particles_out.push_back(p);
+        p->set_production_vertex(root);
+    }
+
+    FourVector pos = in.event_pos;
+    if( convert_length ) Units::convert( pos, in.length_unit, out.length_unit() );
+
+    place_vertices( vertex_offset, pos + shift );
+
+    // Attributes of particles and vertices with shifted ids
+    for(unsigned int i=0; i<in.attribute_id.size(); ++i) {
+        int id = in.attribute_id[i];
+
+        if     ( id > 0 ) id += particle_offset;
+        else if( id < 0 ) id -= vertex_offset;
+        else continue;
+
+        out.add_attribute( in.attribute_name[i], make_shared<StringAttribute>(in.attribute_string[i]), id );
+    }
+
+    out.reset_indexes();
+
+    return block;
+}
+
+
+void EventOverlay::place_vertices(int first_vertex, const FourVector &pos) {
+
+    GenEvent &out = *m_event;
+
+    if( pos == out.event_pos() ) return;
+
+    for(unsigned int i=first_vertex; i<out.m_vertices.size(); ++i) {
+        GenVertexPtr &v = out.m_vertices[i];
+
+        if( v->has_set_position() ) continue;
+
+        // Same search as in GenVertex::position()
+        const GenVertex *prod = NULL;
+        FOREACH( const GenParticlePtr &p, v->particles_in() ) {
+            prod = p->production_vertex_ptr();
+            if( prod ) break;
+        }
+
+        if( !prod || prod->id() == 0 ) v->m_data.position.set( pos.x(), pos.y(), pos.z(), pos.t() );
+    }
+}
+
+
+void EventOverlay::clear() {
+    m_event->clear();
+    m_first_particle.clear();
+    m_first_vertex.clear();
+}
+
+
+int EventOverlay::sub_collision(const GenParticlePtr &p) const {
+    if( !p || p->parent_event() != m_event || m_first_particle.empty() || p->id() < m_first_particle[0] ) return -1;
+
+    return std::upper_bound( m_first_particle.begin(), m_first_particle.end(), p->id() ) - m_first_particle.begin() - 1;
+}
+
+
+int EventOverlay::sub_collision(const GenVertexPtr &v) const {
+    if( !v || v->parent_event() != m_event || m_first_vertex.empty() || v->id() >= 0 || v->id() > m_first_vertex[0] ) return -1;
+
+    // Vertex ids decrease
+    return std::upper_bound( m_first_vertex.begin(), m_first_vertex.end(), v->id(), std::greater<int>() ) - m_first_vertex.begin() - 1;
+}
+
+} // namespace HepMC
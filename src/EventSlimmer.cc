@@ -0,0 +1,240 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file EventSlimmer.cc
+/// @brief Implementation of \b class EventSlimmer
+///
+#include "HepMC/EventSlimmer.h"
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/GenVertex.h"
+
+namespace HepMC {
+
+
+EventSlimmer::EventSlimmer(const FilterList &keep)
+    : m_filter(keep) {}
+
+
+EventSlimmer::EventSlimmer(const CompiledFilter &keep)
+    : m_filter(keep) {}
+
+
+EventSlimmer::EventSlimmer(const Predicate &keep)
+    : m_predicate(keep) {}
+
+
+bool EventSlimmer::keep(const GenParticlePtr &p) const {
+    if( m_predicate ) return m_predicate(p);
+
+    return m_filter.passed_filter(*p);
+}
+
+
+void EventSlimmer::slim(const GenEvent &in, GenEvent &out) {
+
+    if( &in == &out ) {
+        ERROR( "EventSlimmer::slim: input and output event must be different objects" )
+        return;
+    }
+
+    const vector<GenParticlePtr> &particles = in.particles();
+    const vector<GenVertexPtr>   &vertices  = in.vertices();
+
+    // Select particles
+    m_particle_id.assign( particles.size(), 0 );
+
+    int n_particles = 0;
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        if( !keep(particles[i]) ) continue;
+
+        m_particle_id[i] = 1;
+        ++n_particles;
+    }
+
+    // Vertices with kept incoming particles stay separate, the others are
+    // merged with production vertex of their first incoming particle.
+    // Links always point upstream, so merging cannot create loops
+    m_parent.resize( vertices.size() );
+
+    for(unsigned int i=0; i<vertices.size(); ++i) {
+        m_parent[i] = i;
+
+        const vector<GenParticlePtr> &in_particles = vertices[i]->particles_in();
+
+        bool top = false;
+        FOREACH( const GenParticlePtr &p, in_particles ) {
+            if( m_particle_id[p->id()-1] ) { top = true; break; }
+        }
+
+        if( top ) continue;
+
+        FOREACH( const GenParticlePtr &p, in_particles ) {
+            const GenVertex *v = p->production_vertex_ptr();
+
+            // Skip the root vertex
+            if( !v || v->parent_event() != &in || v->id() >= 0 ) continue;
+
+            m_parent[i] = -v->id()-1;
+            break;
+        }
+    }
+
+    // Keep merged vertices that have at least one kept incoming particle
+    m_vertex_id.assign( vertices.size(), 0 );
+
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        if( !m_particle_id[i] ) continue;
+
+        const GenVertex *end = particles[i]->end_vertex_ptr();
+
+        if( end && end->parent_event() == &in && end->id() < 0 ) m_vertex_id[ find(-end->id()-1) ] = 1;
+    }
+
+    int n_vertices = 0;
+    for(unsigned int i=0; i<vertices.size(); ++i) {
+        if( m_vertex_id[i] ) m_vertex_id[i] = -(++n_vertices);
+    }
+
+    // Group kept particles by production vertex, keeping their relative order,
+    // so that each vertex is listed before the particles it produces
+    m_offset.assign( n_vertices+1, 0 );
+
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        if( !m_particle_id[i] ) continue;
+
+        const GenVertex *prod = particles[i]->production_vertex_ptr();
+
+        int group = 0;
+        if( prod && prod->parent_event() == &in && prod->id() < 0 ) group = -m_vertex_id[ find(-prod->id()-1) ];
+
+        m_particle_id[i] = group+1;
+        ++m_offset[group];
+    }
+
+    int first = 0;
+    for(int group=0; group<=n_vertices; ++group) {
+        int count = m_offset[group];
+        m_offset[group] = first;
+        first += count;
+    }
+
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        if( m_particle_id[i] ) m_particle_id[i] = ++m_offset[ m_particle_id[i]-1 ];
+    }
+
+    // Create slimmed event
+    out.clear();
+    out.set_event_number( in.event_number() );
+    out.set_units( in.momentum_unit(), in.length_unit() );
+    out.set_run_info( in.run_info() );
+    out.weights() = in.weights();
+    out.shift_position_to( in.event_pos() );
+    out.reserve( n_particles, n_vertices );
+
+    m_particles.resize( n_particles );
+    m_vertices.clear();
+
+    for(unsigned int i=0; i<vertices.size(); ++i) {
+        if( m_vertex_id[i] ) m_vertices.push_back( make_shared<GenVertex>( vertices[i]->data() ) );
+    }
+
+    for(unsigned int i=0; i<particles.size(); ++i) {
+        if( !m_particle_id[i] ) continue;
+
+        GenParticlePtr p = make_shared<GenParticle>( particles[i]->data() );
+        m_particles[ m_particle_id[i]-1 ] = p;
+
+        const GenVertex *prod = particles[i]->production_vertex_ptr();
+
+        int prod_id = 0;
+        if( prod && prod->parent_event() == &in && prod->id() < 0 ) prod_id = m_vertex_id[ find(-prod->id()-1) ];
+
+        if( prod_id ) {
+            GenVertexPtr v = m_vertices[-prod_id-1];
+            v->m_particles_out.push_back(p);
+            p->set_production_vertex( v->m_this.lock() );
+        }
+    }
+
+    // Kept vertices are those with kept incoming particles, which keep their
+    // original order, as vertices without position inherit it from the first
+    for(unsigned int i=0; i<vertices.size(); ++i) {
+        if( !m_vertex_id[i] ) continue;
+
+        GenVertexPtr v = m_vertices[ -m_vertex_id[i]-1 ];
+
+        FOREACH( const GenParticlePtr &p, vertices[i]->particles_in() ) {
+            if( p->parent_event() != &in ) continue;
+
+            int id = m_particle_id[ p->id()-1 ];
+            if( !id ) continue;
+
+            v->m_particles_in.push_back( m_particles[id-1] );
+            m_particles[id-1]->set_end_vertex( v->m_this.lock() );
+        }
+    }
+
+    // Particles without production vertex are attached to the root vertex
+    FOREACH( const GenParticlePtr &p, m_particles ) out.add_particle(p);
+    FOREACH( const GenVertexPtr   &v, m_vertices  ) out.add_vertex(v);
+
+    // Attributes of merged vertices are taken from their representative
+    typedef std::map< string, std::map<int, shared_ptr<Attribute> > >::value_type att_key_t;
+    typedef std::map<int, shared_ptr<Attribute> >::value_type att_val_t;
+
+    FOREACH( const att_key_t &vt1, in.attributes() ) {
+        FOREACH( const att_val_t &vt2, vt1.second ) {
+            int id = vt2.first;
+
+            if( id > 0 ) {
+                if( id > (int)particles.size() ) continue;
+                id = m_particle_id[id-1];
+            }
+            else if( id < 0 ) {
+                unsigned int v = -id-1;
+                if( v >= vertices.size() || find(v) != v ) continue;
+                id = m_vertex_id[v];
+            }
+            else {
+                out.add_attribute( vt1.first, vt2.second );
+                continue;
+            }
+
+            if( id ) out.add_attribute( vt1.first, vt2.second, id );
+        }
+    }
+
+    if( in.has_barcodes() ) {
+        for(unsigned int i=0; i<particles.size(); ++i) {
+            int id = m_particle_id[i];
+            if( id ) out.set_barcode( m_particles[id-1], in.barcode(particles[i]) );
+        }
+
+        for(unsigned int i=0; i<vertices.size(); ++i) {
+            int id = m_vertex_id[i];
+            if( id ) out.set_barcode( m_vertices[-id-1], in.barcode(vertices[i]) );
+        }
+    }
+
+    // Do not extend lifetime of the slimmed event content
+    m_particles.clear();
+    m_vertices.clear();
+}
+
+
+unsigned int EventSlimmer::find(unsigned int v) {
+    while( m_parent[v] != v ) {
+        m_parent[v] = m_parent[ m_parent[v] ];
+        v = m_parent[v];
+    }
+
+    return v;
+}
+
+
+} // namespace HepMC
@@ -9,6 +9,7 @@
  *
  */
 #include "HepMC/GenCrossSection.h"
+#include "HepMC/Formatter.h"
 #include <cstring> // memcmp
 #include <cstdlib> // atoi
 #include <cstdio> // sprintf
@@ -34,10 +35,13 @@ bool GenCrossSection::from_string(const string &att) {
 
 bool GenCrossSection::to_string(string &att) const {
     char buf[128];
+    char *cursor = buf;
 
-    sprintf(buf,"%.8e %.8e %li %li",
-            cross_section,
-            cross_section_error,
+    cursor += Formatter::format_double(cursor, cross_section, 9);
+    *cursor++ = ' ';
+    cursor += Formatter::format_double(cursor, cross_section_error, 9);
+
+    sprintf(cursor," %li %li",
 	    accepted_events,
 	    attempted_events);
 
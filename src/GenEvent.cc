@@ -26,7 +26,8 @@ GenEvent::GenEvent(Units::MomentumUnit mu,
 		   Units::LengthUnit lu)
   : m_event_number(0), m_weights(std::vector<double>(1, 1.0)),
     m_momentum_unit(mu), m_length_unit(lu),
-    m_rootvertex(make_shared<GenVertex>()) {}
+    m_rootvertex(make_shared<GenVertex>()),
+    m_pid_index_valid(false), m_status_index_valid(false), m_barcode_index_valid(false) {}
 
 
 GenEvent::GenEvent(shared_ptr<GenRunInfo> run,
@@ -35,7 +36,8 @@ GenEvent::GenEvent(shared_ptr<GenRunInfo> run,
   : m_event_number(0), m_weights(std::vector<double>(1, 1.0)),
     m_momentum_unit(mu), m_length_unit(lu),
     m_rootvertex(make_shared<GenVertex>()),
-    m_run_info(run) {
+    m_run_info(run),
+    m_pid_index_valid(false), m_status_index_valid(false), m_barcode_index_valid(false) {
   if ( run && !run->weight_names().empty() )
     m_weights = std::vector<double>(run->weight_names().size(), 1.0);
 }
@@ -50,9 +52,14 @@ void GenEvent::add_particle( GenParticlePtr p ) {
     p->m_event = this;
     p->m_id    = particles().size();
 
-    // Particles without production vertex are added to the root vertex
-    if( !p->production_vertex() )
-      m_rootvertex->add_particle_out(p);
+    reset_indexes();
+
+    // Particles without production vertex are added to the root vertex.
+    // Such particle cannot be in its list yet, no need to check for duplicates
+    if( !p->production_vertex() ) {
+      m_rootvertex->m_particles_out.push_back(p);
+      p->set_production_vertex(m_rootvertex->m_this.lock());
+    }
 }
 
 
@@ -68,12 +75,12 @@ void GenEvent::add_vertex( GenVertexPtr v ) {
     // Add all incoming and outgoing particles and restore their production/end vertices
     FOREACH( GenParticlePtr &p, v->m_particles_in ) {
         if(!p->in_event()) add_particle(p);
-        p->m_end_vertex = v->m_this.lock();
+        p->set_end_vertex( v->m_this.lock() );
     }
 
     FOREACH( GenParticlePtr &p, v->m_particles_out ) {
         if(!p->in_event()) add_particle(p);
-        p->m_production_vertex = v->m_this.lock();
+        p->set_production_vertex( v->m_this.lock() );
     }
 }
 
@@ -103,6 +110,13 @@ void GenEvent::remove_particle( GenParticlePtr p ) {
     int idx = p->id();
     vector<GenParticlePtr>::iterator it = m_particles.erase(m_particles.begin() + idx-1 );
 
+    reset_indexes();
+
+    if( idx <= (int)m_particle_barcodes.size() ) {
+        m_particle_barcodes.erase( m_particle_barcodes.begin() + idx-1 );
+        m_barcode_index_valid = false;
+    }
+
     // Remove attributes of this particle
     vector<string> atts = p->attribute_names();
     FOREACH( string s, atts) {
@@ -181,11 +195,11 @@ void GenEvent::remove_vertex( GenVertexPtr v ) {
     shared_ptr<GenVertex> null_vtx;
 
     FOREACH( GenParticlePtr &p, v->m_particles_in ) {
-        p->m_end_vertex.reset();
+        p->set_end_vertex( shared_ptr<GenVertex>() );
     }
 
     FOREACH( GenParticlePtr &p, v->m_particles_out ) {
-        p->m_production_vertex.reset();
+        p->set_production_vertex( shared_ptr<GenVertex>() );
 
         // recursive delete rest of the tree
         remove_particle(p);
@@ -197,6 +211,11 @@ void GenEvent::remove_vertex( GenVertexPtr v ) {
     int idx = -v->id();
     vector<GenVertexPtr>::iterator it = m_vertices.erase(m_vertices.begin() + idx-1 );
 
+    if( idx <= (int)m_vertex_barcodes.size() ) {
+        m_vertex_barcodes.erase( m_vertex_barcodes.begin() + idx-1 );
+        m_barcode_index_valid = false;
+    }
+
     // Remove attributes of this vertex
     vector<string> atts = v->attribute_names();
     FOREACH( string s, atts) {
@@ -292,9 +311,10 @@ void GenEvent::add_tree( const vector<GenParticlePtr> &parts ) {
         bool added = false;
 
         // Add all mothers to the front of the list
+        // (particles already in the event may come from the root vertex)
         FOREACH( const GenParticlePtr &p, v->particles_in() ) {
             GenVertexPtr v2 = p->production_vertex();
-            if( v2 && !v2->in_event() ) {
+            if( v2 && v2 != m_rootvertex && !v2->in_event() ) {
                 sorting.push_front(v2);
                 added = true;
             }
@@ -329,12 +349,522 @@ void GenEvent::add_tree( const vector<GenParticlePtr> &parts ) {
 }
 
 
+/// @brief Store barcode at @a index of the barcode column, growing it only if needed
+static void set_barcode_entry(vector<int> &barcodes, unsigned int index, int barcode) {
+    if( index >= barcodes.size() ) {
+        if( !barcode ) return;
+        barcodes.resize( index+1, 0 );
+    }
+
+    barcodes[index] = barcode;
+}
+
+
+/// @brief Move attributes of object with id @a from to id @a to
+static void move_attributes(map< string, map<int, shared_ptr<Attribute> > > &attributes, int from, int to) {
+    typedef map< string, map<int, shared_ptr<Attribute> > >::value_type att_key_t;
+
+    FOREACH( att_key_t &vt1, attributes ) {
+        map<int, shared_ptr<Attribute> >::iterator it = vt1.second.find(from);
+        if( it == vt1.second.end() ) continue;
+
+        vt1.second[to] = it->second;
+        vt1.second.erase(it);
+    }
+}
+
+
+bool GenEvent::replace_subtree( const GenParticlePtr &p, GenEvent &subtree ) {
+
+    if( !p || p->parent_event() != this || &subtree == this || subtree.particles().empty() ) {
+        WARNING( "GenEvent::replace_subtree: particle does not belong to this event or subtree is empty" )
+        return false;
+    }
+
+    GenParticlePtr particle = p;
+    GenParticlePtr head     = subtree.m_particles[0];
+
+    // Collect the old subtree. Its particles and vertices are detached
+    // from the event as they are found, which marks them as visited
+    vector<GenParticlePtr> old_particles;
+    vector<GenVertexPtr>   old_vertices;
+
+    GenVertexPtr old_end = p->end_vertex();
+    if( old_end && old_end->m_event == this ) {
+        old_end->m_event = NULL;
+        old_vertices.push_back(old_end);
+    }
+
+    for(unsigned int i=0; i<old_vertices.size(); ++i) {
+        FOREACH( GenParticlePtr &q, old_vertices[i]->m_particles_out ) {
+            if( q->m_event != this ) continue;
+
+            q->m_event = NULL;
+            old_particles.push_back(q);
+
+            GenVertexPtr v = q->end_vertex();
+            if( v && v->m_event == this ) {
+                v->m_event = NULL;
+                old_vertices.push_back(v);
+            }
+        }
+    }
+
+    // Descendants of p cannot have other ancestors
+    bool closed = true;
+    FOREACH( GenVertexPtr &v, old_vertices ) {
+        FOREACH( GenParticlePtr &q, v->m_particles_in ) {
+            if( q != p && q->m_event ) closed = false;
+        }
+    }
+
+    if( !closed ) {
+        FOREACH( GenParticlePtr &q, old_particles ) q->m_event = this;
+        FOREACH( GenVertexPtr   &v, old_vertices  ) v->m_event = this;
+
+        WARNING( "GenEvent::replace_subtree: descendants of particle "<<p->id()<<" have other ancestors" )
+        return false;
+    }
+
+    // Ids freed by the old subtree, in increasing order of their position
+    vector<int> particle_slots;
+    vector<int> vertex_slots;
+    particle_slots.reserve( old_particles.size() );
+    vertex_slots.reserve( old_vertices.size() );
+
+    FOREACH( GenParticlePtr &q, old_particles ) particle_slots.push_back(  q->m_id );
+    FOREACH( GenVertexPtr   &v, old_vertices  ) vertex_slots.push_back(  -v->m_id );
+
+    std::sort( particle_slots.begin(), particle_slots.end() );
+    std::sort( vertex_slots.begin(),   vertex_slots.end()   );
+
+    FOREACH( att_key_t& vt1, m_attributes ) {
+        FOREACH( int id, particle_slots ) vt1.second.erase(  id );
+        FOREACH( int id, vertex_slots   ) vt1.second.erase( -id );
+    }
+
+    FOREACH( GenParticlePtr &q, old_particles ) q->m_id = 0;
+    FOREACH( GenVertexPtr   &v, old_vertices  ) v->m_id = 0;
+
+    if( old_end ) {
+        vector<GenParticlePtr> &in = old_end->m_particles_in;
+        in.erase( std::remove( in.begin(), in.end(), p ), in.end() );
+    }
+
+    // Move particles and vertices of the subtree, reusing freed ids first
+    for(unsigned int i=1; i<subtree.m_particles.size(); ++i) {
+        GenParticlePtr &q = subtree.m_particles[i];
+
+        int id = 0;
+        if( i <= particle_slots.size() ) {
+            id = particle_slots[i-1];
+            m_particles[id-1] = q;
+        }
+        else {
+            m_particles.push_back(q);
+            id = m_particles.size();
+        }
+
+        q->m_event = this;
+        q->m_id    = id;
+
+        int barcode = i < subtree.m_particle_barcodes.size() ? subtree.m_particle_barcodes[i] : 0;
+        set_barcode_entry( m_particle_barcodes, id-1, barcode );
+
+        // Particles without production vertex in the subtree
+        if( !q->production_vertex_ptr() || q->production_vertex_ptr()->id() == 0 ) {
+            m_rootvertex->m_particles_out.push_back(q);
+            q->set_production_vertex( m_rootvertex->m_this.lock() );
+        }
+    }
+
+    for(unsigned int i=0; i<subtree.m_vertices.size(); ++i) {
+        GenVertexPtr &v = subtree.m_vertices[i];
+
+        int index = 0;
+        if( i < vertex_slots.size() ) {
+            index = vertex_slots[i];
+            m_vertices[index-1] = v;
+        }
+        else {
+            m_vertices.push_back(v);
+            index = m_vertices.size();
+        }
+
+        v->m_event = this;
+        v->m_id    = -index;
+
+        int barcode = i < subtree.m_vertex_barcodes.size() ? subtree.m_vertex_barcodes[i] : 0;
+        set_barcode_entry( m_vertex_barcodes, index-1, barcode );
+    }
+
+    FOREACH( const att_key_t& vt1, subtree.m_attributes ) {
+        FOREACH( const att_val_t& vt2, vt1.second ) {
+            int id = vt2.first;
+
+            if( id > 1 && id <= (int)subtree.m_particles.size() ) m_attributes[vt1.first][ subtree.m_particles[id-1]->m_id ] = vt2.second;
+            if( id < 0 && -id <= (int)subtree.m_vertices.size() ) m_attributes[vt1.first][ subtree.m_vertices[-id-1]->m_id ] = vt2.second;
+        }
+    }
+
+    // Fill ids left free with the last particles and vertices of the event
+    if( subtree.m_particles.size()-1 < particle_slots.size() ) {
+        unsigned int hole = subtree.m_particles.size()-1;
+        int          size = m_particles.size() - ( particle_slots.size() - hole );
+
+        for(int id=size+1; id<=(int)m_particles.size(); ++id) {
+            GenParticlePtr &q = m_particles[id-1];
+            if( q->m_event != this ) continue;
+
+            int slot = particle_slots[hole++];
+
+            m_particles[slot-1] = q;
+            q->m_id = slot;
+
+            move_attributes( m_attributes, id, slot );
+            if( id <= (int)m_particle_barcodes.size() ) set_barcode_entry( m_particle_barcodes, slot-1, m_particle_barcodes[id-1] );
+        }
+
+        m_particles.resize(size);
+        if( (int)m_particle_barcodes.size() > size ) m_particle_barcodes.resize(size);
+    }
+
+    if( subtree.m_vertices.size() < vertex_slots.size() ) {
+        unsigned int hole = subtree.m_vertices.size();
+        int          size = m_vertices.size() - ( vertex_slots.size() - hole );
+
+        for(int index=size+1; index<=(int)m_vertices.size(); ++index) {
+            GenVertexPtr &v = m_vertices[index-1];
+            if( v->m_event != this ) continue;
+
+            int slot = vertex_slots[hole++];
+
+            m_vertices[slot-1] = v;
+            v->m_id = -slot;
+
+            move_attributes( m_attributes, -index, -slot );
+            if( index <= (int)m_vertex_barcodes.size() ) set_barcode_entry( m_vertex_barcodes, slot-1, m_vertex_barcodes[index-1] );
+        }
+
+        m_vertices.resize(size);
+        if( (int)m_vertex_barcodes.size() > size ) m_vertex_barcodes.resize(size);
+    }
+
+    // Attach p in place of the head of the subtree
+    GenVertexPtr new_end = head->end_vertex();
+
+    if( new_end && new_end->m_event == this ) {
+        FOREACH( GenParticlePtr &q, new_end->m_particles_in ) {
+            if( q == head ) q = p;
+        }
+
+        particle->set_end_vertex( new_end->m_this.lock() );
+    }
+    else {
+        particle->set_end_vertex( shared_ptr<GenVertex>() );
+    }
+
+    particle->m_data  = head->m_data;
+    particle->m_flags = head->m_flags;
+
+    head->m_event = NULL;
+    head->m_id    = 0;
+
+    subtree.m_particles.clear();
+    subtree.m_vertices.clear();
+    subtree.clear();
+
+    reset_indexes();
+    m_barcode_index_valid = false;
+
+    return true;
+}
+
+
+/// @brief Append particle to the new order and update readiness of its end vertex
+static void place_particle( const GenEvent *evt, const GenParticlePtr &p, vector<int> &particles,
+                            vector<int> &remaining, vector<int> &ready ) {
+    particles.push_back( p->id() );
+
+    const GenVertexPtr &end = p->end_vertex();
+    if( !end || end->parent_event() != evt || end->id() >= 0 ) return;
+
+    int v = -end->id()-1;
+    if( remaining[v] > 0 && --remaining[v] == 0 ) ready.push_back(v);
+}
+
+
+namespace {
+
+/// @brief Compares particle ids by status of the particles
+struct StatusLess {
+    StatusLess(const vector<GenParticlePtr> &particles): m_particles(particles) {}
+
+    bool operator()(int a, int b) const { return m_particles[a-1]->status() < m_particles[b-1]->status(); }
+
+    const vector<GenParticlePtr> &m_particles;
+};
+
+}
+
+
+void GenEvent::reorder_ids( ReorderPolicy policy, vector<int> &particles, vector<int> &vertices ) const {
+
+    particles.clear();
+    vertices.clear();
+    particles.reserve( m_particles.size() );
+    vertices.reserve( m_vertices.size() );
+
+    if( policy == KEEP_ORDER ) {
+        for(unsigned int i=0; i<m_particles.size(); ++i) particles.push_back(  (int)i+1 );
+        for(unsigned int i=0; i<m_vertices.size();  ++i) vertices.push_back ( -(int)i-1 );
+        return;
+    }
+
+    // Incoming particles of each vertex not placed yet, -1 once the vertex is placed
+    vector<int> remaining( m_vertices.size() );
+    vector<int> ready;
+    ready.reserve( m_vertices.size() );
+
+    for(unsigned int i=0; i<m_vertices.size(); ++i) {
+        remaining[i] = m_vertices[i]->particles_in().size();
+        if( remaining[i] == 0 ) ready.push_back(i);
+    }
+
+    // Particles without production vertex
+    FOREACH( const GenParticlePtr &p, m_particles ) {
+        const GenVertex *prod = p->production_vertex_ptr();
+
+        if( !prod || prod->parent_event() != this || prod->id() >= 0 ) place_particle( this, p, particles, remaining, ready );
+    }
+
+    // Vertices become ready once all their incoming particles are placed.
+    // Ready vertices are taken in order for breadth-first and from the end
+    // for depth-first traversal
+    const bool depth_first = ( policy == DEPTH_FIRST );
+    unsigned int next = 0;
+
+    if( depth_first ) std::reverse( ready.begin(), ready.end() );
+
+    while( depth_first ? !ready.empty() : next < ready.size() ) {
+        int v;
+
+        if( depth_first ) {
+            v = ready.back();
+            ready.pop_back();
+        }
+        else v = ready[next++];
+
+        unsigned int first_ready = ready.size();
+
+        vertices.push_back( -v-1 );
+        remaining[v] = -1;
+
+        FOREACH( const GenParticlePtr &p, m_vertices[v]->particles_out() ) place_particle( this, p, particles, remaining, ready );
+
+        // Follow decay of the first outgoing particle first
+        if( depth_first ) std::reverse( ready.begin()+first_ready, ready.end() );
+    }
+
+    // Vertices not reachable from the beams
+    for(unsigned int i=0; i<m_vertices.size(); ++i) {
+        if( remaining[i] < 0 ) continue;
+
+        vertices.push_back( -(int)i-1 );
+        remaining[i] = -1;
+
+        FOREACH( const GenParticlePtr &p, m_vertices[i]->particles_out() ) place_particle( this, p, particles, remaining, ready );
+    }
+
+    if( policy == BY_STATUS ) std::stable_sort( particles.begin(), particles.end(), StatusLess(m_particles) );
+}
+
+
+void GenEvent::reorder( ReorderPolicy policy ) {
+
+    if( policy == KEEP_ORDER ) return;
+
+    vector<int> particle_order;
+    vector<int> vertex_order;
+
+    reorder_ids( policy, particle_order, vertex_order );
+
+    // New ids by old index
+    vector<int> particle_id( m_particles.size() );
+    vector<int> vertex_id  ( m_vertices.size()  );
+
+    vector<GenParticlePtr> particles;
+    vector<GenVertexPtr>   vertices;
+    particles.reserve( m_particles.size() );
+    vertices.reserve ( m_vertices.size()  );
+
+    FOREACH( int id, particle_order ) {
+        particles.push_back( m_particles[id-1] );
+        particle_id[id-1] = particles.size();
+    }
+
+    FOREACH( int id, vertex_order ) {
+        vertices.push_back( m_vertices[-id-1] );
+        vertex_id[-id-1] = -(int)vertices.size();
+    }
+
+    m_particles.swap(particles);
+    m_vertices.swap(vertices);
+
+    for(unsigned int i=0; i<m_particles.size(); ++i) m_particles[i]->m_id =  (int)i+1;
+    for(unsigned int i=0; i<m_vertices.size();  ++i) m_vertices[i]->m_id  = -(int)i-1;
+
+    // Attributes
+    FOREACH( att_key_t &vt1, m_attributes ) {
+        std::map<int, shared_ptr<Attribute> > reordered;
+
+        FOREACH( const att_val_t &vt2, vt1.second ) {
+            int id = vt2.first;
+
+            if     ( id > 0 && id <= (int)particle_id.size() ) id = particle_id[id-1];
+            else if( id < 0 && -id <= (int)vertex_id.size()  ) id = vertex_id[-id-1];
+
+            reordered[id] = vt2.second;
+        }
+
+        vt1.second.swap(reordered);
+    }
+
+    // Barcodes
+    if( !m_particle_barcodes.empty() ) {
+        vector<int> barcodes( m_particles.size(), 0 );
+
+        for(unsigned int i=0; i<m_particle_barcodes.size() && i<particle_id.size(); ++i) barcodes[ particle_id[i]-1 ] = m_particle_barcodes[i];
+
+        m_particle_barcodes.swap(barcodes);
+    }
+
+    if( !m_vertex_barcodes.empty() ) {
+        vector<int> barcodes( m_vertices.size(), 0 );
+
+        for(unsigned int i=0; i<m_vertex_barcodes.size() && i<vertex_id.size(); ++i) barcodes[ -vertex_id[i]-1 ] = m_vertex_barcodes[i];
+
+        m_vertex_barcodes.swap(barcodes);
+    }
+
+    reset_indexes();
+    m_barcode_index_valid = false;
+}
+
+
 void GenEvent::reserve(unsigned int parts, unsigned int verts) {
     m_particles.reserve(parts);
     m_vertices.reserve(verts);
 }
 
 
+namespace {
+
+/// @brief Approximate size of the control block of a shared pointer
+const size_t control_block_size = sizeof(void*) + 2*sizeof(int);
+
+/// @brief Approximate size of the node of a std::map without its value
+const size_t map_node_size = 4*sizeof(void*);
+
+/// @brief Memory allocated by vector @a v
+template<class T>
+size_t vector_memory(const vector<T> &v) {
+    return v.capacity()*sizeof(T);
+}
+
+/// @brief Memory allocated by unordered map @a m
+template<class K, class V>
+size_t unordered_map_memory(const std::unordered_map<K,V> &m) {
+    return m.size()*( sizeof(void*) + sizeof(typename std::unordered_map<K,V>::value_type) )
+         + m.bucket_count()*sizeof(void*);
+}
+
+/// @brief Memory allocated by index of particles
+size_t index_memory(const map< int, vector<GenParticlePtr> > &index) {
+    size_t result = 0;
+
+    for( map< int, vector<GenParticlePtr> >::const_iterator it = index.begin(); it != index.end(); ++it ) {
+        result += map_node_size + sizeof(*it) + vector_memory(it->second);
+    }
+
+    return result;
+}
+
+/// @brief Memory used by attribute, including its control block
+size_t attribute_memory(const shared_ptr<Attribute> &att) {
+    if( !att ) return 0;
+
+    return att->memory_usage() + control_block_size;
+}
+
+/// @brief Memory used by run info, including its control block
+size_t run_info_memory(const GenRunInfo &run) {
+    size_t result = sizeof(GenRunInfo) + control_block_size;
+
+    result += vector_memory( run.tools() );
+
+    FOREACH( const GenRunInfo::ToolInfo &tool, run.tools() ) {
+        result += string_memory(tool.name) + string_memory(tool.version) + string_memory(tool.description);
+    }
+
+    // Names are stored both in the list and in the map of indices
+    result += vector_memory( run.weight_names() );
+
+    FOREACH( const string &name, run.weight_names() ) {
+        result += 2*string_memory(name) + map_node_size + sizeof(pair<const string,int>);
+    }
+
+    typedef map< string, shared_ptr<Attribute> >::value_type att_val_t;
+
+    FOREACH( const att_val_t &vt, run.attributes() ) {
+        result += map_node_size + sizeof(vt) + string_memory(vt.first) + attribute_memory(vt.second);
+    }
+
+    return result;
+}
+
+}
+
+
+MemoryUsage GenEvent::memory_usage() const {
+    MemoryUsage result;
+
+    result.particles = m_particles.size()*( sizeof(GenParticle) + control_block_size );
+    result.vertices  = ( m_vertices.size() + 1 )*( sizeof(GenVertex) + control_block_size );
+
+    result.links = vector_memory( m_rootvertex->particles_in() ) + vector_memory( m_rootvertex->particles_out() );
+
+    FOREACH( const GenVertexPtr &v, m_vertices ) {
+        result.links += vector_memory( v->particles_in() ) + vector_memory( v->particles_out() );
+    }
+
+    result.event  = sizeof(GenEvent);
+    result.event += vector_memory(m_particles) + vector_memory(m_vertices);
+    result.event += index_memory(m_pid_index) + index_memory(m_status_index);
+    result.event += vector_memory(m_particle_barcodes) + vector_memory(m_vertex_barcodes);
+    result.event += unordered_map_memory(m_particle_barcode_index) + unordered_map_memory(m_vertex_barcode_index);
+
+    result.weights = vector_memory(m_weights);
+
+    typedef map< string, map<int, shared_ptr<Attribute> > >::value_type att_key_t;
+    typedef map<int, shared_ptr<Attribute> >::value_type att_val_t;
+
+    FOREACH( const att_key_t &vt1, m_attributes ) {
+        size_t &size = result.attributes[vt1.first];
+
+        size += map_node_size + sizeof(vt1) + string_memory(vt1.first);
+
+        FOREACH( const att_val_t &vt2, vt1.second ) {
+            size += map_node_size + sizeof(vt2) + attribute_memory(vt2.second);
+        }
+    }
+
+    if( m_run_info ) result.run_info = run_info_memory(*m_run_info);
+
+    return result;
+}
+
+
 void GenEvent::set_units( Units::MomentumUnit new_momentum_unit, Units::LengthUnit new_length_unit) {
     if( new_momentum_unit != m_momentum_unit ) {
         FOREACH( GenParticlePtr &p, m_particles ) {
@@ -381,6 +911,196 @@ void GenEvent::clear() {
     m_attributes.clear();
     m_particles.clear();
     m_vertices.clear();
+    m_pid_index.clear();
+    m_status_index.clear();
+    reset_indexes();
+    clear_barcodes();
+}
+
+
+void GenEvent::swap(GenEvent &other) {
+    m_particles.swap(other.m_particles);
+    m_vertices.swap(other.m_vertices);
+    std::swap(m_event_number, other.m_event_number);
+    m_weights.swap(other.m_weights);
+    std::swap(m_momentum_unit, other.m_momentum_unit);
+    std::swap(m_length_unit, other.m_length_unit);
+    std::swap(m_rootvertex, other.m_rootvertex);
+    m_run_info.swap(other.m_run_info);
+    m_attributes.swap(other.m_attributes);
+    m_pid_index.swap(other.m_pid_index);
+    m_status_index.swap(other.m_status_index);
+    std::swap(m_pid_index_valid, other.m_pid_index_valid);
+    std::swap(m_status_index_valid, other.m_status_index_valid);
+    m_particle_barcodes.swap(other.m_particle_barcodes);
+    m_vertex_barcodes.swap(other.m_vertex_barcodes);
+    m_particle_barcode_index.swap(other.m_particle_barcode_index);
+    m_vertex_barcode_index.swap(other.m_vertex_barcode_index);
+    std::swap(m_barcode_index_valid, other.m_barcode_index_valid);
+
+    // Particles and vertices point back to their event
+    FOREACH( GenParticlePtr &p, m_particles )       p->m_event = this;
+    FOREACH( GenVertexPtr   &v, m_vertices )        v->m_event = this;
+    FOREACH( GenParticlePtr &p, other.m_particles ) p->m_event = &other;
+    FOREACH( GenVertexPtr   &v, other.m_vertices )  v->m_event = &other;
+}
+
+
+int GenEvent::barcode(const GenParticlePtr &p) const {
+    if( !p || p->parent_event() != this ) return 0;
+
+    size_t idx = p->id() - 1;
+    return ( idx < m_particle_barcodes.size() ) ? m_particle_barcodes[idx] : 0;
+}
+
+
+int GenEvent::barcode(const GenVertexPtr &v) const {
+    if( !v || v->parent_event() != this ) return 0;
+
+    size_t idx = -v->id() - 1;
+    return ( idx < m_vertex_barcodes.size() ) ? m_vertex_barcodes[idx] : 0;
+}
+
+
+void GenEvent::set_barcode(const GenParticlePtr &p, int barcode) {
+    if( !p || p->parent_event() != this ) return;
+
+    if( m_particle_barcodes.size() < m_particles.size() ) m_particle_barcodes.resize( m_particles.size(), 0 );
+
+    m_particle_barcodes[ p->id() - 1 ] = barcode;
+    m_barcode_index_valid = false;
+}
+
+
+void GenEvent::set_barcode(const GenVertexPtr &v, int barcode) {
+    if( !v || v->parent_event() != this ) return;
+
+    if( m_vertex_barcodes.size() < m_vertices.size() ) m_vertex_barcodes.resize( m_vertices.size(), 0 );
+
+    m_vertex_barcodes[ -v->id() - 1 ] = barcode;
+    m_barcode_index_valid = false;
+}
+
+
+/// @brief Fill map of ids using barcode column indexed by id
+static void build_barcode_index(const vector<int> &barcodes, unordered_map<int,int> &index, int sign) {
+    index.clear();
+
+    for( size_t i=0; i<barcodes.size(); ++i ) {
+        if( barcodes[i] ) index[ barcodes[i] ] = sign*(int)(i+1);
+    }
+}
+
+
+void GenEvent::update_barcode_indexes() const {
+    if( m_barcode_index_valid ) return;
+
+    build_barcode_index( m_particle_barcodes, m_particle_barcode_index,  1 );
+    build_barcode_index( m_vertex_barcodes,   m_vertex_barcode_index,   -1 );
+    m_barcode_index_valid = true;
+}
+
+
+GenParticlePtr GenEvent::particle_by_barcode(int barcode) const {
+
+    update_barcode_indexes();
+
+    unordered_map<int,int>::const_iterator it = m_particle_barcode_index.find(barcode);
+
+    return ( barcode == 0 || it == m_particle_barcode_index.end() ) ? GenParticlePtr() : m_particles[ it->second - 1 ];
+}
+
+
+GenVertexPtr GenEvent::vertex_by_barcode(int barcode) const {
+
+    update_barcode_indexes();
+
+    unordered_map<int,int>::const_iterator it = m_vertex_barcode_index.find(barcode);
+
+    return ( barcode == 0 || it == m_vertex_barcode_index.end() ) ? GenVertexPtr() : m_vertices[ -it->second - 1 ];
+}
+
+
+void GenEvent::clear_barcodes() {
+    m_particle_barcodes.clear();
+    m_vertex_barcodes.clear();
+    m_particle_barcode_index.clear();
+    m_vertex_barcode_index.clear();
+    m_barcode_index_valid = false;
+}
+
+
+/// @brief Fill map of particles using given property as a key
+template<class Key>
+static void build_index(const vector<GenParticlePtr> &particles, map< int, vector<GenParticlePtr> > &index, Key key) {
+
+    // Keep allocated lists for reuse, events usually have similar content
+    for( map< int, vector<GenParticlePtr> >::iterator it = index.begin(); it != index.end(); ++it ) {
+        it->second.clear();
+    }
+
+    FOREACH( const GenParticlePtr &p, particles ) {
+        index[ key(*p) ].push_back(p);
+    }
+}
+
+namespace {
+    struct pid_key    { int operator()(const GenParticle &p) const { return p.pid();    } };
+    struct status_key { int operator()(const GenParticle &p) const { return p.status(); } };
+
+    const vector<GenParticlePtr> empty_particle_list;
+}
+
+
+const vector<GenParticlePtr>& GenEvent::particles_with_pid(int pid) const {
+
+    if( !m_pid_index_valid ) {
+        build_index( m_particles, m_pid_index, pid_key() );
+        m_pid_index_valid = true;
+    }
+
+    map< int, vector<GenParticlePtr> >::const_iterator it = m_pid_index.find(pid);
+
+    return ( it == m_pid_index.end() ) ? empty_particle_list : it->second;
+}
+
+
+vector<GenParticlePtr> GenEvent::particles_with_abs_pid(int abs_pid) const {
+
+    if( abs_pid <  0 ) return vector<GenParticlePtr>();
+    if( abs_pid == 0 ) return particles_with_pid(0);
+
+    const vector<GenParticlePtr> &p1 = particles_with_pid(  abs_pid );
+    const vector<GenParticlePtr> &p2 = particles_with_pid( -abs_pid );
+
+    // Merge both lists keeping order of particle id
+    vector<GenParticlePtr> results;
+    results.reserve( p1.size() + p2.size() );
+
+    vector<GenParticlePtr>::const_iterator i1 = p1.begin(), i2 = p2.begin();
+
+    while( i1 != p1.end() && i2 != p2.end() ) {
+        if( (*i1)->id() < (*i2)->id() ) results.push_back( *i1++ );
+        else                            results.push_back( *i2++ );
+    }
+
+    results.insert( results.end(), i1, p1.end() );
+    results.insert( results.end(), i2, p2.end() );
+
+    return results;
+}
+
+
+const vector<GenParticlePtr>& GenEvent::particles_with_status(int status) const {
+
+    if( !m_status_index_valid ) {
+        build_index( m_particles, m_status_index, status_key() );
+        m_status_index_valid = true;
+    }
+
+    map< int, vector<GenParticlePtr> >::const_iterator it = m_status_index.find(status);
+
+    return ( it == m_status_index.end() ) ? empty_particle_list : it->second;
 }
 
 
@@ -9,6 +9,7 @@
  *
  */
 #include "HepMC/GenHeavyIon.h"
+#include "HepMC/Formatter.h"
 #include <cstring> // memcmp
 #include <cstdlib> // atoi
 #include <cstdio> // sprintf
@@ -65,7 +66,9 @@ bool GenHeavyIon::from_string(const string &att) {
 bool GenHeavyIon::to_string(string &att) const {
     char buf[255];
 
-    sprintf(buf,"%i %i %i %i %i %i %i %i %i %.8e %.8e %.8e %.8e %.8e",
+    char *cursor = buf;
+
+    cursor += sprintf(cursor,"%i %i %i %i %i %i %i %i %i",
             Ncoll_hard,
             Npart_proj,
             Npart_targ,
@@ -74,12 +77,13 @@ bool GenHeavyIon::to_string(string &att) const {
             spectator_protons,
             N_Nwounded_collisions,
             Nwounded_N_collisions,
-            Nwounded_Nwounded_collisions,
-            impact_parameter,
-            event_plane_angle,
-            eccentricity,
-            sigma_inel_NN,
-            centrality);
+            Nwounded_Nwounded_collisions);
+
+    const double values[] = { impact_parameter, event_plane_angle, eccentricity, sigma_inel_NN, centrality };
+    for( int i = 0; i < 5; ++i ) {
+        *cursor++ = ' ';
+        cursor += Formatter::format_double(cursor, values[i], 9);
+    }
 
     att = buf;
 
@@ -20,18 +20,25 @@ namespace HepMC {
 
 GenParticle::GenParticle( const FourVector &mom, int pidin, int stat):
 m_event(NULL),
-m_id(0) {
+m_id(0),
+m_production_vertex_ptr(NULL),
+m_end_vertex_ptr(NULL) {
     m_data.pid               = pidin;
     m_data.momentum          = mom;
     m_data.status            = stat;
     m_data.is_mass_set       = false;
     m_data.mass              = 0.0;
+
+    m_flags = PdgProperties::properties(pidin) | status_flags(stat);
 }
 
 GenParticle::GenParticle( const GenParticleData &dat ):
 m_event(NULL),
 m_id(0),
-m_data(dat) {
+m_data(dat),
+m_production_vertex_ptr(NULL),
+m_end_vertex_ptr(NULL) {
+    m_flags = PdgProperties::properties(dat.pid) | status_flags(dat.status);
 }
 
 double GenParticle::generated_mass() const {
@@ -41,10 +48,16 @@ double GenParticle::generated_mass() const {
 
 void GenParticle::set_pid(int pidin) {
     m_data.pid = pidin;
+    m_flags    = PdgProperties::properties(pidin) | status_flags(m_data.status);
+
+    if( m_event ) m_event->reset_indexes();
 }
 
 void GenParticle::set_status(int stat) {
     m_data.status = stat;
+    m_flags       = ( m_flags & ~( (unsigned int)FLAG_FINAL_STATE | FLAG_BEAM ) ) | status_flags(stat);
+
+    if( m_event ) m_event->reset_indexes();
 }
 
 void GenParticle::set_momentum(const FourVector& mom) {
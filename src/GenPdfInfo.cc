@@ -9,6 +9,7 @@
  *
  */
 #include "HepMC/GenPdfInfo.h"
+#include "HepMC/Formatter.h"
 #include <cstring> // memcmp
 #include <cstdlib> // atoi
 #include <cstdio> // sprintf
@@ -49,15 +50,19 @@ bool GenPdfInfo::from_string(const string &att) {
 
 bool GenPdfInfo::to_string(string &att) const {
     char buf[255];
+    char *cursor = buf;
 
-    sprintf(buf,"%i %i %.8e %.8e %.8e %.8e %.8e %i %i",
+    cursor += sprintf(cursor,"%i %i",
                 parton_id[0],
-                parton_id[1],
-                x[0],
-                x[1],
-                scale,
-                xf[0],
-                xf[1],
+                parton_id[1]);
+
+    const double values[] = { x[0], x[1], scale, xf[0], xf[1] };
+    for( int i = 0; i < 5; ++i ) {
+        *cursor++ = ' ';
+        cursor += Formatter::format_double(cursor, values[i], 9);
+    }
+
+    sprintf(cursor," %i %i",
                 pdf_id[0],
                 pdf_id[1]);
 
@@ -45,7 +45,7 @@ void GenVertex::add_particle_in( GenParticlePtr p ) {
 
     if( p->end_vertex() ) p->end_vertex()->remove_particle_in(p);
 
-    p->m_end_vertex = m_this.lock();
+    p->set_end_vertex( m_this.lock() );
 
     if(m_event) m_event->add_particle(p);
 }
@@ -63,26 +63,31 @@ void GenVertex::add_particle_out( GenParticlePtr p ) {
 
     if( p->production_vertex() ) p->production_vertex()->remove_particle_out(p);
 
-    p->m_production_vertex = m_this.lock();
+    p->set_production_vertex( m_this.lock() );
 
     if(m_event) m_event->add_particle(p);
 }
 
 
 void GenVertex::remove_particle_in( GenParticlePtr p ) {
-    p->m_end_vertex.reset();
+    p->set_end_vertex( shared_ptr<GenVertex>() );
     m_particles_in.erase( std::remove( m_particles_in.begin(), m_particles_in.end(), p), m_particles_in.end());
 }
 
 
 void GenVertex::remove_particle_out( GenParticlePtr p ) {
-    p->m_production_vertex.reset();
+    p->set_production_vertex( shared_ptr<GenVertex>() );
     m_particles_out.erase( std::remove( m_particles_out.begin(), m_particles_out.end(), p), m_particles_out.end());
 }
 
 
 const vector<GenParticlePtr> GenVertex::particles(Relationship range) const {
-  return findParticles(GenVertexPtr(const_cast<GenVertex*>(this)), range);
+    vector<GenParticlePtr> results;
+    SearchBuffer           buffer;
+
+    FindParticles::collect( *this, range, CompiledFilter(), results, buffer );
+
+    return results;
 }
 
 
@@ -0,0 +1,112 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file MemoryUsage.cc
+/// @brief Implementation of \b struct MemoryUsage and \b class MemoryUsageSummary
+///
+#include "HepMC/MemoryUsage.h"
+#include "HepMC/Common.h"
+
+namespace HepMC {
+
+
+size_t MemoryUsage::attributes_total() const {
+    size_t result = 0;
+
+    for( std::map<std::string, size_t>::const_iterator it = attributes.begin(); it != attributes.end(); ++it ) {
+        result += it->second;
+    }
+
+    return result;
+}
+
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage &rhs) {
+    particles += rhs.particles;
+    vertices  += rhs.vertices;
+    links     += rhs.links;
+    event     += rhs.event;
+    weights   += rhs.weights;
+    run_info  += rhs.run_info;
+
+    for( std::map<std::string, size_t>::const_iterator it = rhs.attributes.begin(); it != rhs.attributes.end(); ++it ) {
+        attributes[it->first] += it->second;
+    }
+
+    return *this;
+}
+
+
+void MemoryUsage::print(std::ostream &os) const {
+    os << "Memory usage [bytes]:" << std::endl;
+    os << "  particles:  " << particles          << std::endl;
+    os << "  vertices:   " << vertices           << std::endl;
+    os << "  links:      " << links              << std::endl;
+    os << "  event:      " << event              << std::endl;
+    os << "  weights:    " << weights            << std::endl;
+    os << "  attributes: " << attributes_total() << std::endl;
+
+    for( std::map<std::string, size_t>::const_iterator it = attributes.begin(); it != attributes.end(); ++it ) {
+        os << "    " << it->first << ": " << it->second << std::endl;
+    }
+
+    os << "  total:      " << total()            << std::endl;
+    os << "  run info:   " << run_info           << " (shared)" << std::endl;
+}
+
+
+void MemoryUsageSummary::add(const MemoryUsage &usage) {
+    ++m_events;
+
+    // Run info is shared between events, keep the last one
+    size_t run_info = usage.run_info;
+
+    m_sum += usage;
+    m_sum.run_info = run_info;
+
+    if( usage.total() > m_max_total ) m_max_total = usage.total();
+}
+
+
+void MemoryUsageSummary::clear() {
+    m_events    = 0;
+    m_sum       = MemoryUsage();
+    m_max_total = 0;
+}
+
+
+MemoryUsage MemoryUsageSummary::mean() const {
+    MemoryUsage result;
+
+    if( m_events == 0 ) return result;
+
+    result.particles = m_sum.particles / m_events;
+    result.vertices  = m_sum.vertices  / m_events;
+    result.links     = m_sum.links     / m_events;
+    result.event     = m_sum.event     / m_events;
+    result.weights   = m_sum.weights   / m_events;
+    result.run_info  = m_sum.run_info;
+
+    for( std::map<std::string, size_t>::const_iterator it = m_sum.attributes.begin(); it != m_sum.attributes.end(); ++it ) {
+        result.attributes[it->first] = it->second / m_events;
+    }
+
+    return result;
+}
+
+
+void MemoryUsageSummary::print(std::ostream &os) const {
+    os << "Events: " << m_events << std::endl;
+
+    if( m_events == 0 ) return;
+
+    os << "Mean ";
+    mean().print(os);
+    os << "Largest event: " << m_max_total << " bytes" << std::endl;
+    os << "All events:    " << m_sum.total() << " bytes" << std::endl;
+}
+
+} // namespace HepMC
@@ -0,0 +1,50 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file Reader.cc
+/// @brief Implementation of \b class Reader
+///
+#include "HepMC/Reader.h"
+
+#include "HepMC/EventSlimmer.h"
+#include "HepMC/GenParticle.h"
+#include <utility>
+
+namespace HepMC {
+
+
+void Reader::apply_read_options(GenEvent &evt) const {
+    const ReadOptions &options = m_read_options;
+
+    if( !options.keeps_weights() ) evt.weights().clear();
+
+    if( !options.keeps_all_attributes() ) {
+        std::vector< std::pair<string,int> > dropped;
+
+        typedef std::map< string, std::map<int, shared_ptr<Attribute> > >::value_type value_type1;
+        typedef std::map<int, shared_ptr<Attribute> >::value_type                     value_type2;
+        FOREACH( const value_type1 &vt1, evt.attributes() ) {
+            if( options.keeps_attribute(vt1.first) ) continue;
+
+            FOREACH( const value_type2 &vt2, vt1.second ) dropped.push_back( std::make_pair(vt1.first, vt2.first) );
+        }
+
+        for( unsigned int i=0; i<dropped.size(); ++i ) evt.remove_attribute( dropped[i].first, dropped[i].second );
+    }
+
+    if( options.has_particle_filter() ) {
+        const ReadOptions::ParticleFilter &filter = options.particle_filter();
+
+        EventSlimmer slimmer( [&filter](const GenParticlePtr &p) { return filter( p->data() ); } );
+
+        GenEvent slim;
+        slimmer.slim( evt, slim );
+        evt.swap( slim );
+    }
+}
+
+
+} // namespace HepMC
@@ -13,17 +13,73 @@
 #include "HepMC/GenParticle.h"
 #include "HepMC/GenVertex.h"
 #include "HepMC/Units.h"
+#include "HepMC/Tokenizer.h"
 #include <cstring>
-#include <sstream>
+#include <deque>
+#include <limits>
+#include <exception>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace HepMC {
 
 
-ReaderAscii::ReaderAscii(const string &filename)
- : m_file(filename), m_stream(0), m_isstream(false)
+/// @brief Particles and vertices of the input mapped to the kept ones
+///
+/// Vertices without kept incoming particles are merged with the production
+/// vertex of their first incoming particle that has one, as in EventSlimmer.
+/// Vertex indices are positions in the input, i.e. -id-1.
+struct ReaderAscii::Projection {
+
+    /// @brief Attribute of particle or vertex, added when its id is known
+    struct PendingAttribute {
+        int                   id;        //!< Id of particle or vertex in the input
+        string                name;      //!< Name of attribute
+        shared_ptr<Attribute> attribute; //!< Attribute
+    };
+
+    /// @brief Remove all particles, vertices and attributes
+    void clear() {
+        particles.clear();
+        production.clear();
+        end.clear();
+        vertices.clear();
+        top.clear();
+        attributes.clear();
+    }
+
+    /// @brief Kept vertex merged with the production vertex of input particle @a p, NULL for the root vertex
+    GenVertexPtr production_vertex(int p) const {
+        return production[p] >= 0 ? vertices[ production[p] ] : GenVertexPtr();
+    }
+
+    vector<GenParticlePtr>   particles;  //!< Kept particle of each input particle, NULL if dropped
+    vector<int>              production; //!< Production vertex index of each input particle, -1 for root vertex
+    vector<int>              end;        //!< End vertex index of each input particle, -1 if none
+    vector<GenVertexPtr>     vertices;   //!< Kept vertex each input vertex is merged with, NULL for root vertex
+    vector<bool>             top;        //!< Is the input vertex kept?
+    vector<int>              incoming;   //!< Incoming particles of the vertex being parsed
+    vector<PendingAttribute> attributes; //!< Attributes of particles and vertices
+};
+
+
+ReaderAscii::ReaderAscii(const string &filename, bool map_file)
+ : m_stream(0), m_isstream(false),
+   m_map_begin(NULL), m_map_end(NULL), m_map_cursor(NULL), m_map_failed(false),
+   m_parallel(NULL), m_projection(NULL)
 {
-    if( !m_file.is_open() ) {
-        ERROR( "ReaderAscii: could not open input file: "<<filename )
+    if( !map_file || !map(filename) ) {
+        m_file.open(filename.c_str());
+
+        if( !m_file.is_open() ) {
+            ERROR( "ReaderAscii: could not open input file: "<<filename )
+        }
     }
     set_run_info(make_shared<GenRunInfo>());
 }
@@ -31,7 +87,9 @@ ReaderAscii::ReaderAscii(const string &filename)
 
 // Ctor for reading from stdin
 ReaderAscii::ReaderAscii(std::istream & stream)
- : m_stream(&stream), m_isstream(true)
+ : m_stream(&stream), m_isstream(true),
+   m_map_begin(NULL), m_map_end(NULL), m_map_cursor(NULL), m_map_failed(false),
+   m_parallel(NULL), m_projection(NULL)
 {
     if( !m_stream ) {
         ERROR( "ReaderAscii: could not open input stream " )
@@ -41,32 +99,94 @@ ReaderAscii::ReaderAscii(std::istream & stream)
 
 
 
-ReaderAscii::~ReaderAscii() { if (!m_isstream) close(); }
+ReaderAscii::~ReaderAscii() {
+    if (!m_isstream) close();
+    delete m_projection;
+}
+
+
+bool ReaderAscii::map(const string &filename) {
+    int fd = open( filename.c_str(), O_RDONLY );
+    if( fd < 0 ) return false;
+
+    struct stat st;
+    void *addr = MAP_FAILED;
+
+    // Pipes and devices are read as stream
+    if( fstat(fd,&st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 ) {
+        addr = mmap( NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
+
+    ::close(fd);
+
+    if( addr == MAP_FAILED ) return false;
+
+    const char *begin = static_cast<const char*>(addr);
+
+    // Parsing relies on the last line being terminated, compressed files are read as stream
+    if( begin[st.st_size-1] != '\n' || Codec::find_magic( begin, st.st_size ) ) {
+        munmap( addr, st.st_size );
+        return false;
+    }
+
+    madvise( addr, st.st_size, MADV_SEQUENTIAL );
+
+    m_map_begin  = begin;
+    m_map_end    = begin + st.st_size;
+    m_map_cursor = begin;
+
+    return true;
+}
 
 
 bool ReaderAscii::read_event(GenEvent &evt) {
-    if ( (!m_file.is_open()) && (!m_isstream) ) return false;
+    if ( (!m_file.is_open()) && (!m_isstream) && (!m_map_begin) ) return false;
+
+    // Events parsed ahead by worker threads, run information is parsed below
+    if ( m_parallel && !failed() ) {
+        int result = read_parsed_event(evt);
+        if ( result >= 0 ) return result;
+    }
 
     char               peek;
     char               buf[512*512];
+    const char        *line                   = buf;
     bool               parsed_event_header    = false;
     bool               is_parsing_successful  = true;
     pair<int,int> vertices_and_particles(0,0);
+    Projection        *projection             = NULL;
 
     evt.clear();
     evt.set_run_info(run_info());
 
+    if( read_options().has_particle_filter() ) {
+        if( !m_projection ) m_projection = new Projection();
+        projection = m_projection;
+    }
+
     //
     // Parse event, vertex and particle information
     //
     while(!failed()) {
 
-        m_isstream ? m_stream->getline(buf,512*512) : m_file.getline(buf,512*512);
+        if( m_map_begin ) {
+            if( m_map_cursor == m_map_end ) {
+                m_map_failed = true;
+                continue;
+            }
+
+            // Parse line in place, the file is known to end with new line
+            line         = m_map_cursor;
+            m_map_cursor = static_cast<const char*>( memchr(m_map_cursor,'\n',m_map_end-m_map_cursor) ) + 1;
+        }
+        else {
+            m_isstream ? m_stream->getline(buf,512*512) : m_file.getline(buf,512*512);
+        }
 
-        if( strlen(buf) == 0 ) continue;
+        if( line[0] == '\0' || line[0] == '\n' ) continue;
 
         // Check for ReaderAscii header/footer
-        if( strncmp(buf,"HepMC",5) == 0 ) {
+        if( strncmp(line,"HepMC",5) == 0 ) {
             if(parsed_event_header) {
                 is_parsing_successful = true;
                 break;
@@ -74,10 +194,10 @@ bool ReaderAscii::read_event(GenEvent &evt) {
             continue;
         }
 
-        switch(buf[0]) {
+        switch(line[0]) {
             /// @todo Should consider exceptions for reporting parsing problems more locally to the source of trouble
             case 'E':
-                vertices_and_particles = parse_event_information(evt,buf);
+                vertices_and_particles = parse_event_information(evt,line);
                 if (vertices_and_particles.second < 0) {
                     is_parsing_successful = false;
                 } else {
@@ -86,31 +206,31 @@ bool ReaderAscii::read_event(GenEvent &evt) {
                 }
                 break;
             case 'V':
-                is_parsing_successful = parse_vertex_information(evt,buf);
+                is_parsing_successful = parse_vertex_information(evt,line,projection);
                 break;
             case 'P':
-                is_parsing_successful = parse_particle_information(evt,buf);
+                is_parsing_successful = parse_particle_information(evt,line,projection);
                 break;
             case 'W':
                 if ( parsed_event_header )
-                  is_parsing_successful = parse_weight_values(evt,buf);
+                  is_parsing_successful = parse_weight_values(evt,line);
                 else
-                  is_parsing_successful = parse_weight_names(buf);
+                  is_parsing_successful = parse_weight_names(line);
                 break;
             case 'U':
-                is_parsing_successful = parse_units(evt,buf);
+                is_parsing_successful = parse_units(evt,line);
                 break;
             case 'T':
-                is_parsing_successful = parse_tool(buf);
+                is_parsing_successful = parse_tool(line);
                 break;
             case 'A':
                 if ( parsed_event_header )
-                    is_parsing_successful = parse_attribute(evt,buf);
+                    is_parsing_successful = parse_attribute(evt,line,projection);
                 else
-                    is_parsing_successful = parse_run_attribute(buf);
+                    is_parsing_successful = parse_run_attribute(line);
                 break;
             default:
-                WARNING( "ReaderAscii: skipping unrecognised prefix: " << buf[0] )
+                WARNING( "ReaderAscii: skipping unrecognised prefix: " << line[0] )
                 is_parsing_successful = true;
                 break;
         }
@@ -118,76 +238,401 @@ bool ReaderAscii::read_event(GenEvent &evt) {
         if( !is_parsing_successful ) break;
 
         // Check for next event
-        m_isstream ? peek = m_stream->peek() : peek = m_file.peek();
+        if( m_map_begin ) peek = ( m_map_cursor != m_map_end ) ? *m_map_cursor : 0;
+        else m_isstream ? peek = m_stream->peek() : peek = m_file.peek();
         if( parsed_event_header && peek=='E' ) break;
     }
 
 
     // Check if all particles and vertices were parsed
-    if ((int)evt.particles().size() != vertices_and_particles.second ) {
+    int particles_parsed = projection ? projection->particles.size() : evt.particles().size();
+    int vertices_parsed  = projection ? projection->vertices.size()  : evt.vertices().size();
+
+    if (particles_parsed != vertices_and_particles.second ) {
         ERROR( "ReaderAscii: too few or too many particles were parsed" )
         is_parsing_successful = false;
     }
 
-    if ((int)evt.vertices().size()  != vertices_and_particles.first) {
+    if (vertices_parsed  != vertices_and_particles.first) {
        ERROR( "ReaderAscii: too few or too many vertices were parsed" )
         is_parsing_successful =  false;
     }
+
+    if( projection ) {
+        if( is_parsing_successful ) finish_projection(evt,*projection);
+        else projection->clear();
+    }
     // Check if there were errors during parsing
     if( !is_parsing_successful ) {
         ERROR( "ReaderAscii: event parsing failed. Returning empty event" )
-        DEBUG( 1, "Parsing failed at line:" << endl << buf )
+        DEBUG( 1, "Parsing failed at line:" << endl << string(line,Tokenizer::line_end(line)) )
 
         evt.clear();
-        m_isstream ? m_stream->clear(ios::badbit) : m_file.clear(ios::badbit);
+        if( m_map_begin ) m_map_failed = true;
+        else m_isstream ? m_stream->clear(ios::badbit) : m_file.clear(ios::badbit);
 
         return false;
     }
 
+    account_memory(evt);
+
     return true;
 }
 
 
+/// @brief Worker threads parsing events ahead of read_event()
+///
+/// Worker threads take tasks from the queue and parse them into events of
+/// the tasks. Tasks are returned by read_event() in the order of pending,
+/// after which they are reused.
+struct ReaderAscii::ParallelParser {
+
+    /// @brief Status of a task
+    enum Status {
+        PARSING,   //!< Not parsed yet
+        PARSED,    //!< Event parsed successfully
+        FAILED,    //!< Event could not be parsed
+        RUN_INFO   //!< Event contains run information and has to be parsed sequentially
+    };
+
+    /// @brief Event parsed by a worker thread
+    struct Task {
+        const char         *begin;       //!< First line of the event
+        const char         *end;         //!< End of last line of the event
+        GenEvent            event;       //!< Parsed event
+        pair<int,int>       counts;      //!< Numbers of vertices and particles in the E line
+        pair<int,int>       parsed;      //!< Numbers of vertices and particles parsed
+        Projection          projection;  //!< Particles dropped by the read options
+        int                 status;      //!< Status of parsing
+        const char         *failed_line; //!< Line that could not be parsed
+        std::exception_ptr  error;       //!< Exception thrown by parsing
+    };
+
+    ParallelParser(): look_ahead(0), cursor(NULL), stop(false) {}
+
+    ~ParallelParser() {
+        FOREACH( Task *task, pending )    delete task;
+        FOREACH( Task *task, free_tasks ) delete task;
+    }
+
+    /// @brief Return task for reuse
+    void recycle(Task *task) {
+        task->error = std::exception_ptr();
+        free_tasks.push_back(task);
+    }
+
+    std::vector<std::thread> workers;    //!< Worker threads
+    unsigned int             look_ahead; //!< Maximum number of pending tasks
+    const char              *cursor;     //!< Start of the first line not passed to workers
+
+    std::deque<Task*>        pending;    //!< Tasks not returned by read_event(), in order of input
+    std::vector<Task*>       free_tasks; //!< Tasks for reuse
+
+    std::mutex               mutex;      //!< Guards queue, stop and status of tasks
+    std::condition_variable  work_ready; //!< Signals new tasks and stop to workers
+    std::condition_variable  task_done;  //!< Signals parsed tasks to read_event()
+    std::deque<Task*>        queue;      //!< Tasks not taken by a worker yet
+    bool                     stop;       //!< Should workers stop?
+};
+
+
+void ReaderAscii::set_parallel(unsigned int threads, unsigned int look_ahead) {
+    if( !m_map_begin ) {
+        WARNING( "ReaderAscii: input is not mapped, events will be parsed sequentially" )
+        return;
+    }
+
+    if( m_map_cursor != m_map_begin ) {
+        WARNING( "ReaderAscii: parallel parsing has to be set before reading events" )
+        return;
+    }
+
+    stop_parallel();
+
+    if( threads < 2 ) return;
+
+    m_parallel = new ParallelParser();
+    m_parallel->look_ahead = look_ahead ? look_ahead : 2*threads;
+    m_parallel->cursor     = m_map_cursor;
+
+    for( unsigned int i = 0; i < threads; ++i ) {
+        m_parallel->workers.push_back( std::thread( &ReaderAscii::run_worker, this ) );
+    }
+}
+
+
+unsigned int ReaderAscii::parallel_threads() const {
+    return m_parallel ? m_parallel->workers.size() : 0;
+}
+
+
+void ReaderAscii::stop_parallel() {
+    if( !m_parallel ) return;
+
+    {
+        std::lock_guard<std::mutex> lock( m_parallel->mutex );
+        m_parallel->stop = true;
+    }
+    m_parallel->work_ready.notify_all();
+
+    FOREACH( std::thread &worker, m_parallel->workers ) worker.join();
+
+    delete m_parallel;
+    m_parallel = NULL;
+}
+
+
+int ReaderAscii::read_parsed_event(GenEvent &evt) {
+    typedef ParallelParser::Task Task;
+
+    ParallelParser &parallel = *m_parallel;
+
+    // All lines up to m_map_cursor have been parsed
+    if( parallel.pending.empty() ) parallel.cursor = m_map_cursor;
+
+    dispatch_events();
+
+    // Run information and end of file
+    if( parallel.pending.empty() ) return -1;
+
+    Task *task = parallel.pending.front();
+    parallel.pending.pop_front();
+
+    {
+        std::unique_lock<std::mutex> lock( parallel.mutex );
+        while( task->status == ParallelParser::PARSING ) parallel.task_done.wait(lock);
+    }
+
+    if( task->error ) {
+        std::exception_ptr error = task->error;
+        m_map_cursor = task->end;
+        parallel.recycle(task);
+        std::rethrow_exception(error);
+    }
+
+    if( task->status == ParallelParser::RUN_INFO ) {
+        parallel.recycle(task);
+        return -1;
+    }
+
+    m_map_cursor = task->end;
+
+    bool is_parsing_successful = ( task->status == ParallelParser::PARSED );
+
+    if( is_parsing_successful ) {
+        // Check if all particles and vertices were parsed
+        if (task->parsed.second != task->counts.second ) {
+            ERROR( "ReaderAscii: too few or too many particles were parsed" )
+            is_parsing_successful = false;
+        }
+
+        if (task->parsed.first  != task->counts.first) {
+            ERROR( "ReaderAscii: too few or too many vertices were parsed" )
+            is_parsing_successful = false;
+        }
+    }
+
+    if( !is_parsing_successful ) {
+        ERROR( "ReaderAscii: event parsing failed. Returning empty event" )
+        if( task->failed_line ) {
+            DEBUG( 1, "Parsing failed at line:" << endl << string(task->failed_line,Tokenizer::line_end(task->failed_line)) )
+        }
+
+        parallel.recycle(task);
+        evt.clear();
+        m_map_failed = true;
+
+        return 0;
+    }
+
+    evt.swap( task->event );
+    parallel.recycle(task);
+
+    // Keep workers busy while the event is processed
+    dispatch_events();
+
+    account_memory(evt);
+
+    return 1;
+}
+
+
+void ReaderAscii::dispatch_events() {
+    typedef ParallelParser::Task Task;
+
+    ParallelParser &parallel = *m_parallel;
+    std::vector<Task*> tasks;
+
+    // Run information after the events is parsed when all of them are returned
+    while( parallel.pending.size() < parallel.look_ahead
+           && parallel.cursor != m_map_end && *parallel.cursor == 'E' ) {
+
+        // Event ends before the next event or the next header or footer
+        const char *end = parallel.cursor;
+        do {
+            end = static_cast<const char*>( memchr(end,'\n',m_map_end-end) ) + 1;
+        } while( end != m_map_end && *end != 'E'
+                 && !( m_map_end - end >= 5 && strncmp(end,"HepMC",5) == 0 ) );
+
+        Task *task;
+        if( parallel.free_tasks.empty() ) task = new Task();
+        else {
+            task = parallel.free_tasks.back();
+            parallel.free_tasks.pop_back();
+        }
+
+        task->begin       = parallel.cursor;
+        task->end         = end;
+        task->status      = ParallelParser::PARSING;
+        task->failed_line = NULL;
+
+        tasks.push_back(task);
+        parallel.pending.push_back(task);
+        parallel.cursor = end;
+    }
+
+    if( tasks.empty() ) return;
+
+    {
+        std::lock_guard<std::mutex> lock( parallel.mutex );
+        parallel.queue.insert( parallel.queue.end(), tasks.begin(), tasks.end() );
+    }
+
+    if( tasks.size() == 1 ) parallel.work_ready.notify_one();
+    else                    parallel.work_ready.notify_all();
+}
+
+
+void ReaderAscii::run_worker() {
+    typedef ParallelParser::Task Task;
+
+    ParallelParser &parallel = *m_parallel;
+    std::unique_lock<std::mutex> lock( parallel.mutex );
+
+    while( true ) {
+        while( !parallel.stop && parallel.queue.empty() ) parallel.work_ready.wait(lock);
+
+        if( parallel.stop ) return;
+
+        Task *task = parallel.queue.front();
+        parallel.queue.pop_front();
+
+        lock.unlock();
+
+        // Contents of the event returned before are released here
+        task->event.clear();
+        task->event.set_run_info(run_info());
+
+        Projection *projection = read_options().has_particle_filter() ? &task->projection : NULL;
+        int         status;
+
+        try {
+            status = parse_event_lines( task->event, task->begin, task->end, task->counts, task->failed_line, projection );
+        }
+        catch(...) {
+            task->error = std::current_exception();
+            status      = ParallelParser::FAILED;
+        }
+
+        if( projection ) {
+            task->parsed = pair<int,int>( projection->vertices.size(), projection->particles.size() );
+
+            if( status == ParallelParser::PARSED ) finish_projection( task->event, *projection );
+            else projection->clear();
+        }
+        else task->parsed = pair<int,int>( task->event.vertices().size(), task->event.particles().size() );
+
+        lock.lock();
+        task->status = status;
+        parallel.task_done.notify_one();
+    }
+}
+
+
+int ReaderAscii::parse_event_lines(GenEvent &evt, const char *begin, const char *end,
+                                   pair<int,int> &vertices_and_particles, const char *&failed_line,
+                                   Projection *projection) {
+    bool is_parsing_successful = true;
+
+    vertices_and_particles = pair<int,int>(0,0);
+
+    for( const char *line = begin; line != end; line = static_cast<const char*>( memchr(line,'\n',end-line) ) + 1 ) {
+
+        switch(line[0]) {
+            case 'E':
+                vertices_and_particles = parse_event_information(evt,line);
+                is_parsing_successful  = vertices_and_particles.second >= 0;
+                break;
+            case 'V':
+                is_parsing_successful = parse_vertex_information(evt,line,projection);
+                break;
+            case 'P':
+                is_parsing_successful = parse_particle_information(evt,line,projection);
+                break;
+            case 'W':
+                is_parsing_successful = parse_weight_values(evt,line);
+                break;
+            case 'U':
+                is_parsing_successful = parse_units(evt,line);
+                break;
+            case 'A': {
+                // Run attributes repeated between events
+                Tokenizer tok(line+1);
+                tok.read_int();
+                if( tok.failed() ) return ParallelParser::RUN_INFO;
+
+                is_parsing_successful = parse_attribute(evt,line,projection);
+                break;
+            }
+            case 'T':
+                return ParallelParser::RUN_INFO;
+            case '\n':
+                break;
+            default:
+                WARNING( "ReaderAscii: skipping unrecognised prefix: " << line[0] )
+                break;
+        }
+
+        if( !is_parsing_successful ) {
+            failed_line = line;
+            return ParallelParser::FAILED;
+        }
+    }
+
+    return ParallelParser::PARSED;
+}
+
+
 pair<int,int> ReaderAscii::parse_event_information(GenEvent &evt, const char *buf) {
     static const pair<int,int>  err(-1,-1);
     pair<int,int>               ret(-1,-1);
-    const char                 *cursor   = buf;
+    Tokenizer                   tok(buf+1);
     int                         event_no = 0;
     FourVector                  position;
 
     // event number
-    if( !(cursor = strchr(cursor+1,' ')) ) return err;
-    event_no = atoi(cursor);
-    evt.set_event_number(event_no);
+    event_no = tok.read_int();
 
     // num_vertices
-    if( !(cursor = strchr(cursor+1,' ')) ) return err;
-    ret.first = atoi(cursor);
+    ret.first = tok.read_int();
 
     // num_particles
-    if( !(cursor = strchr(cursor+1,' ')) ) return err;
-    ret.second = atoi(cursor);
+    ret.second = tok.read_int();
 
     // check if there is position information
-    if( (cursor = strchr(cursor+1,'@')) ) {
+    bool has_position = tok.skip('@');
 
-        // x
-        if( !(cursor = strchr(cursor+1,' ')) ) return err;
-        position.setX(atof(cursor));
-
-        // y
-        if( !(cursor = strchr(cursor+1,' ')) ) return err;
-        position.setY(atof(cursor));
+    if( has_position ) {
+        position.setX( tok.read_double() );
+        position.setY( tok.read_double() );
+        position.setZ( tok.read_double() );
+        position.setT( tok.read_double() );
+    }
 
-        // z
-        if( !(cursor = strchr(cursor+1,' ')) ) return err;
-        position.setZ(atof(cursor));
+    if( tok.failed() ) return err;
 
-        // t
-        if( !(cursor = strchr(cursor+1,' ')) ) return err;
-        position.setT(atof(cursor));
-        evt.shift_position_to( position );
-    }
+    evt.set_event_number(event_no);
+    if( has_position ) evt.shift_position_to( position );
 
     DEBUG( 10, "ReaderAscii: E: "<<event_no<<" ("<<ret.first<<"V, "<<ret.second<<"P)" )
 
@@ -196,11 +641,12 @@ pair<int,int> ReaderAscii::parse_event_information(GenEvent &evt, const char *bu
 
 
 bool ReaderAscii::parse_weight_values(GenEvent &evt, const char *buf) {
+    if ( !read_options().keeps_weights() ) return true;
 
-    std::istringstream iss(buf + 1);
+    Tokenizer tok(buf+1);
     vector<double> wts;
-    double w;
-    while ( iss >> w ) wts.push_back(w);
+    while ( !tok.at_end() ) wts.push_back( tok.read_double() );
+    if ( tok.failed() ) return false;
     if ( run_info() && run_info()->weight_names().size()
      && run_info()->weight_names().size() != wts.size() )
     throw std::logic_error("ReaderAscii::parse_weight_values: "
@@ -213,19 +659,17 @@ bool ReaderAscii::parse_weight_values(GenEvent &evt, const char *buf) {
 
 
 bool ReaderAscii::parse_units(GenEvent &evt, const char *buf) {
-    const char *cursor = buf;
+    Tokenizer tok(buf+1);
 
     // momentum
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    ++cursor;
-    Units::MomentumUnit momentum_unit = Units::momentum_unit(cursor);
+    string momentum = tok.read_string();
 
     // length
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    ++cursor;
-    Units::LengthUnit length_unit = Units::length_unit(cursor);
+    string length   = tok.read_string();
 
-    evt.set_units(momentum_unit,length_unit);
+    if( tok.failed() ) return false;
+
+    evt.set_units( Units::momentum_unit(momentum), Units::length_unit(length) );
 
     DEBUG( 10, "ReaderAscii: U: " << Units::name(evt.momentum_unit()) << " " << Units::name(evt.length_unit()) )
 
@@ -233,29 +677,26 @@ bool ReaderAscii::parse_units(GenEvent &evt, const char *buf) {
 }
 
 
-bool ReaderAscii::parse_vertex_information(GenEvent &evt, const char *buf) {
+bool ReaderAscii::parse_vertex_information(GenEvent &evt, const char *buf, Projection *projection) {
+    if( projection ) return project_vertex(evt,buf,*projection);
+
     GenVertexPtr  data = make_shared<GenVertex>();
     FourVector    position;
-    const char   *cursor          = buf;
-    const char   *cursor2         = NULL;
+    Tokenizer     tok(buf+1);
     int           id              = 0;
     int           highest_id      = evt.particles().size();
 
     // id
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    id = atoi(cursor);
+    id = tok.read_int();
 
     // status
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    data->set_status( atoi(cursor) );
+    data->set_status( tok.read_int() );
 
     // skip to the list of particles
-    if( !(cursor = strchr(cursor+1,'[')) ) return false;
+    if( !tok.skip('[') ) return false;
 
     while(true) {
-        ++cursor;             // skip the '[' or ',' character
-        cursor2     = cursor; // save cursor position
-        int  particle_in = atoi(cursor);
+        int particle_in = tok.read_int();
 
         // add incoming particle to the vertex
         if( particle_in > 0 && particle_in <= highest_id) {
@@ -266,34 +707,22 @@ bool ReaderAscii::parse_vertex_information(GenEvent &evt, const char *buf) {
         }
 
         // check for next particle or end of particle list
-        if( !(cursor = strchr(cursor+1,',')) ) {
-            if( !(cursor = strchr(cursor2+1,']')) ) return false;
-            break;
-        }
+        if( tok.skip(',') ) continue;
+        if( !tok.skip(']') ) return false;
+        break;
     }
 
     // check if there is position information
-    if( (cursor = strchr(cursor+1,'@')) ) {
-
-        // x
-        if( !(cursor = strchr(cursor+1,' ')) ) return false;
-        position.setX(atof(cursor));
-
-        // y
-        if( !(cursor = strchr(cursor+1,' ')) ) return false;
-        position.setY(atof(cursor));
-
-        // z
-        if( !(cursor = strchr(cursor+1,' ')) ) return false;
-        position.setZ(atof(cursor));
-
-        // t
-        if( !(cursor = strchr(cursor+1,' ')) ) return false;
-        position.setT(atof(cursor));
+    if( tok.skip('@') ) {
+        position.setX( tok.read_double() );
+        position.setY( tok.read_double() );
+        position.setZ( tok.read_double() );
+        position.setT( tok.read_double() );
         data->set_position( position );
-
     }
 
+    if( tok.failed() ) return false;
+
     DEBUG( 10, "ReaderAscii: V: "<<id<<" with "<<data->particles_in().size()<<" particles)" )
 
     evt.add_vertex(data);
@@ -302,24 +731,46 @@ bool ReaderAscii::parse_vertex_information(GenEvent &evt, const char *buf) {
 }
 
 
-bool ReaderAscii::parse_particle_information(GenEvent &evt, const char *buf) {
-    GenParticlePtr  data = make_shared<GenParticle>();
-    FourVector      momentum;
-    const char     *cursor  = buf;
+bool ReaderAscii::parse_particle_information(GenEvent &evt, const char *buf, Projection *projection) {
+    GenParticleData data;
+    Tokenizer       tok(buf+1);
     int             mother_id = 0;
+    int             parsed    = projection ? projection->particles.size() : evt.particles().size();
 
     // verify id
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-
-    if( atoi(cursor) != (int)evt.particles().size() + 1 ) {
+    if( tok.read_int() != parsed + 1 ) {
         /// @todo Should be an exception
         ERROR( "ReaderAscii: particle ID mismatch" )
         return false;
     }
 
     // mother id
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    mother_id = atoi(cursor);
+    mother_id = tok.read_int();
+
+    // pdg id
+    data.pid = tok.read_int();
+
+    // momentum
+    data.momentum.setPx( tok.read_double() );
+    data.momentum.setPy( tok.read_double() );
+    data.momentum.setPz( tok.read_double() );
+    data.momentum.setE(  tok.read_double() );
+
+    // m
+    data.mass        = tok.read_double();
+    data.is_mass_set = true;
+
+    // status
+    data.status = tok.read_int();
+
+    if( tok.failed() ) return false;
+
+    if( projection ) {
+        project_particle(evt,data,mother_id,*projection);
+        return true;
+    }
+
+    GenParticlePtr particle = make_shared<GenParticle>(data);
 
     // add particle to corresponding vertex
     if( mother_id > 0 && mother_id <= (int)evt.particles().size() ) {
@@ -333,92 +784,211 @@ bool ReaderAscii::parse_particle_information(GenEvent &evt, const char *buf) {
             vertex->add_particle_in(mother);
         }
 
-        vertex->add_particle_out(data);
+        vertex->add_particle_out(particle);
         evt.add_vertex(vertex);
     }
     else if( mother_id < 0 && -mother_id <= (int)evt.vertices().size() ) {
-        evt.vertices()[ (-mother_id)-1 ]->add_particle_out(data);
+        evt.vertices()[ (-mother_id)-1 ]->add_particle_out(particle);
     }
 
-    // pdg id
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    data->set_pid( atoi(cursor) );
+    evt.add_particle(particle);
 
-    // px
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    momentum.setPx(atof(cursor));
+    DEBUG( 10, "ReaderAscii: P: "<<particle->id()<<" ( mother: "<<mother_id<<", pid: "<<particle->pid()<<")" )
 
-    // py
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    momentum.setPy(atof(cursor));
+    return true;
+}
 
-    // pz
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    momentum.setPz(atof(cursor));
 
-    // pe
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    momentum.setE(atof(cursor));
-    data->set_momentum(momentum);
+bool ReaderAscii::parse_attribute(GenEvent &evt, const char *buf, Projection *projection) {
+    Tokenizer tok(buf+1);
 
-    // m
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    data->set_generated_mass( atof(cursor) );
+    int id = tok.read_int();
 
-    // status
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    data->set_status( atoi(cursor) );
+    // Run attributes may be repeated between events
+    if( tok.failed() ) return parse_run_attribute(buf);
+
+    string name = tok.read_string();
 
-    evt.add_particle(data);
+    // value follows a single space
+    if( tok.failed() || *tok.cursor() != ' ' ) return false;
 
-    DEBUG( 10, "ReaderAscii: P: "<<data->id()<<" ( mother: "<<mother_id<<", pid: "<<data->pid()<<")" )
+    if( !read_options().keeps_attribute(name) ) return true;
+
+    shared_ptr<Attribute> att =
+    make_shared<StringAttribute>( StringAttribute(unescape(tok.cursor()+1)) );
+
+    // Ids of particles and vertices are known when the whole event is parsed
+    if( projection && id != 0 ) {
+        Projection::PendingAttribute pending = { id, name, att };
+        projection->attributes.push_back(pending);
+        return true;
+    }
+
+    evt.add_attribute(name, att, id);
 
     return true;
 }
 
 
-bool ReaderAscii::parse_attribute(GenEvent &evt, const char *buf) {
-    const char     *cursor  = buf;
-    const char     *cursor2 = buf;
-    char            name[64];
-    int             id = 0;
+void ReaderAscii::project_particle(GenEvent &evt, const GenParticleData &data, int mother_id, Projection &projection) {
+    int production = -1;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    id = atoi(cursor);
+    if( mother_id > 0 && mother_id <= (int)projection.particles.size() ) {
+        int mother = mother_id-1;
 
-    if( !(cursor  = strchr(cursor+1,' ')) ) return false;
-    ++cursor;
+        production = projection.end[mother];
 
-    if( !(cursor2 = strchr(cursor,' ')) ) return false;
-    sprintf(name,"%.*s", (int)(cursor2-cursor), cursor);
+        // create new vertex if needed
+        if( production < 0 ) {
+            production = projection.vertices.size();
+            projection.end[mother] = production;
 
-    cursor = cursor2+1;
+            GenVertexPtr vertex;
+            bool         top = projection.particles[mother];
 
-    shared_ptr<Attribute> att =
-    make_shared<StringAttribute>( StringAttribute(unescape(cursor)) );
+            if( top ) {
+                vertex = make_shared<GenVertex>();
+                vertex->add_particle_in( projection.particles[mother] );
+                evt.add_vertex(vertex);
+            }
+            else vertex = projection.production_vertex(mother);
+
+            projection.vertices.push_back(vertex);
+            projection.top.push_back(top);
+        }
+    }
+    else if( mother_id < 0 && -mother_id <= (int)projection.vertices.size() ) {
+        production = (-mother_id)-1;
+    }
+
+    projection.production.push_back(production);
+    projection.end.push_back(-1);
+
+    if( !read_options().particle_filter()(data) ) {
+        projection.particles.push_back( GenParticlePtr() );
+        return;
+    }
+
+    GenParticlePtr particle = make_shared<GenParticle>(data);
+    projection.particles.push_back(particle);
+
+    // Merged vertices can have many outgoing particles, which are new,
+    // so they are linked without checking for duplicates
+    if( production >= 0 && projection.vertices[production] ) {
+        GenVertexPtr &vertex = projection.vertices[production];
+
+        vertex->m_particles_out.push_back(particle);
+        particle->set_production_vertex( vertex->m_this.lock() );
+    }
+
+    evt.add_particle(particle);
+}
+
+
+bool ReaderAscii::project_vertex(GenEvent &evt, const char *buf, Projection &projection) {
+    Tokenizer tok(buf+1);
+    int       highest_id = projection.particles.size();
+    bool      top        = false;
+
+    // id
+    tok.read_int();
+
+    // status
+    int status = tok.read_int();
+
+    // skip to the list of particles
+    if( !tok.skip('[') ) return false;
+
+    projection.incoming.clear();
+
+    while(true) {
+        int particle_in = tok.read_int();
+
+        if( particle_in <= 0 || particle_in > highest_id ) return false;
+
+        projection.incoming.push_back(particle_in-1);
+        if( projection.particles[particle_in-1] ) top = true;
+
+        // check for next particle or end of particle list
+        if( tok.skip(',') ) continue;
+        if( !tok.skip(']') ) return false;
+        break;
+    }
+
+    FourVector position;
+    bool       has_position = tok.skip('@');
+
+    if( has_position ) {
+        position.setX( tok.read_double() );
+        position.setY( tok.read_double() );
+        position.setZ( tok.read_double() );
+        position.setT( tok.read_double() );
+    }
+
+    if( tok.failed() ) return false;
 
-    evt.add_attribute(string(name), att, id);
+    GenVertexPtr vertex;
+
+    if( top ) {
+        vertex = make_shared<GenVertex>();
+        vertex->set_status(status);
+        if( has_position ) vertex->set_position(position);
+
+        FOREACH( int p, projection.incoming ) {
+            if( projection.particles[p] ) vertex->add_particle_in( projection.particles[p] );
+        }
+
+        evt.add_vertex(vertex);
+    }
+    else {
+        FOREACH( int p, projection.incoming ) {
+            if( projection.production[p] < 0 ) continue;
+
+            vertex = projection.production_vertex(p);
+            break;
+        }
+    }
+
+    FOREACH( int p, projection.incoming ) projection.end[p] = projection.vertices.size();
+
+    projection.vertices.push_back(vertex);
+    projection.top.push_back(top);
 
     return true;
 }
 
-bool ReaderAscii::parse_run_attribute(const char *buf) {
-    const char     *cursor  = buf;
-    const char     *cursor2 = buf;
-    char            name[64];
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    ++cursor;
+void ReaderAscii::finish_projection(GenEvent &evt, Projection &projection) {
+    FOREACH( const Projection::PendingAttribute &pending, projection.attributes ) {
+        int id = pending.id;
+
+        if( id > 0 ) {
+            if( id > (int)projection.particles.size() || !projection.particles[id-1] ) continue;
+            id = projection.particles[id-1]->id();
+        }
+        else {
+            if( -id > (int)projection.vertices.size() || !projection.top[-id-1] ) continue;
+            id = projection.vertices[-id-1]->id();
+        }
+
+        evt.add_attribute(pending.name, pending.attribute, id);
+    }
+
+    projection.clear();
+}
+
+bool ReaderAscii::parse_run_attribute(const char *buf) {
+    Tokenizer tok(buf+1);
 
-    if( !(cursor2 = strchr(cursor,' ')) ) return false;
-    sprintf(name,"%.*s", (int)(cursor2-cursor), cursor);
+    string name = tok.read_string();
 
-    cursor = cursor2+1;
+    // value follows a single space
+    if( tok.failed() || *tok.cursor() != ' ' ) return false;
 
      shared_ptr<StringAttribute> att =
-     make_shared<StringAttribute>( StringAttribute(unescape(cursor)) );
+     make_shared<StringAttribute>( StringAttribute(unescape(tok.cursor()+1)) );
 
-    run_info()->add_attribute(string(name), att);
+    run_info()->add_attribute(name, att);
 
     return true;
 
@@ -428,13 +998,18 @@ bool ReaderAscii::parse_run_attribute(const char *buf) {
 bool ReaderAscii::parse_weight_names(const char *buf) {
     const char     *cursor  = buf;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
+    if( !(cursor = Tokenizer::find_in_line(cursor+1,' ')) ) return false;
     ++cursor;
 
-    istringstream iss(unescape(cursor));
+    // names are separated by escaped new lines or spaces
+    string line = unescape(cursor);
     vector<string> names;
-    string name;
-    while ( iss >> name ) names.push_back(name);
+    string::size_type begin = line.find_first_not_of(" \t\n");
+    while ( begin != string::npos ) {
+        string::size_type end = line.find_first_of(" \t\n", begin);
+        names.push_back( line.substr(begin, end-begin) );
+        begin = line.find_first_not_of(" \t\n", end);
+    }
 
     run_info()->set_weight_names(names);
 
@@ -445,7 +1020,7 @@ bool ReaderAscii::parse_weight_names(const char *buf) {
 bool ReaderAscii::parse_tool(const char *buf) {
     const char     *cursor  = buf;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
+    if( !(cursor = Tokenizer::find_in_line(cursor+1,' ')) ) return false;
     ++cursor;
     string line = unescape(cursor);
     GenRunInfo::ToolInfo tool;
@@ -462,12 +1037,14 @@ bool ReaderAscii::parse_tool(const char *buf) {
 }
 
 
-string ReaderAscii::unescape(const string& s) {
+string ReaderAscii::unescape(const char *s) {
+    const char *end = Tokenizer::line_end(s);
     string ret;
-    ret.reserve(s.length());
-    for ( string::const_iterator it = s.begin(); it != s.end(); ++it ) {
+    ret.reserve(end-s);
+    for ( const char *it = s; it != end; ++it ) {
         if ( *it == '\\' ) {
             ++it;
+            if ( it == end ) break;
             if ( *it == '|' )
                 ret += '\n';
             else
@@ -480,7 +1057,271 @@ string ReaderAscii::unescape(const string& s) {
 }
 
 
+bool ReaderAscii::load_index(const std::string &filename) {
+    EventIndex index;
+    if( !index.read(filename) ) return false;
+
+    if( index.format() != EventIndex::HEPMC3 ) {
+        ERROR( "ReaderAscii: index does not belong to a HepMC3 file: " << filename )
+        return false;
+    }
+
+    std::streamoff size = input_size();
+    if( size >= 0 && (unsigned long long)size != index.file_size() ) {
+        ERROR( "ReaderAscii: index does not match size of the input: " << filename )
+        return false;
+    }
+
+    std::swap( m_index, index );
+    return true;
+}
+
+
+bool ReaderAscii::load_block_index(const std::string &filename) {
+    return m_file.load_block_index(filename);
+}
+
+
+bool ReaderAscii::seek_event(int event_number) {
+    if ( (!m_file.is_open()) && (!m_isstream) && (!m_map_begin) ) return false;
+
+    if( m_index.empty() ) {
+        ERROR( "ReaderAscii: seeking events requires an index, see load_index()" )
+        return false;
+    }
+
+    size_t i = m_index.find(event_number);
+    if( i == m_index.size() ) {
+        ERROR( "ReaderAscii: no event " << event_number << " in the index" )
+        return false;
+    }
+
+    discard_parsed_events();
+
+    // Run information in the header is parsed by scanning the first event
+    std::streamoff position = input_position();
+    if( position >= 0 && (unsigned long long)position < m_index[0].offset && !failed() ) {
+        EventIndex::Entry header;
+        scan_event(header);
+    }
+
+    return seek_offset( m_index[i].offset );
+}
+
+
+bool ReaderAscii::skip(int n) {
+    if ( (!m_file.is_open()) && (!m_isstream) && (!m_map_begin) ) return false;
+    if ( failed() ) return false;
+
+    EventIndex::Entry header;
+
+    if ( m_index.empty() || input_position() < 0 ) {
+        for ( int i = 0; i < n; ++i ) {
+            if ( !scan_event(header) ) return false;
+        }
+        return true;
+    }
+
+    if ( n <= 0 ) return true;
+
+    discard_parsed_events();
+
+    // Run information before the next event is parsed by scanning the event
+    if ( peek_input() != 'E' ) {
+        if ( !scan_event(header) ) return false;
+        if ( --n == 0 ) return true;
+    }
+
+    size_t next = m_index.position( input_position() ) + n;
+
+    // Skipping the remaining events leaves the input at its end
+    if ( next >= m_index.size() ) {
+        if( m_map_begin ) {
+            m_map_cursor = m_map_end;
+            m_map_failed = true;
+        }
+        else {
+            input().seekg( 0, std::ios::end );
+            input().setstate( std::ios::eofbit );
+        }
+        return next == m_index.size();
+    }
+
+    return seek_offset( m_index[next].offset );
+}
+
+
+bool ReaderAscii::scan_event(EventIndex::Entry &header) {
+    if ( (!m_file.is_open()) && (!m_isstream) && (!m_map_begin) ) return false;
+
+    discard_parsed_events();
+
+    std::string text;
+    const char *line                  = NULL;
+    bool        parsed_event_header   = false;
+    bool        is_parsing_successful = true;
+
+    while( !failed() ) {
+        char peek = peek_input();
+
+        // Event ends before the next event or the next header or footer
+        if( parsed_event_header && ( peek == 'E' || peek == 'H' || peek == 0 ) ) return true;
+
+        if( peek == 0 ) {
+            if( m_map_begin ) m_map_failed = true;
+            break;
+        }
+
+        // Lines of the event other than the E line are not needed
+        if( parsed_event_header || ( peek != 'E' && peek != 'W' && peek != 'T' && peek != 'A' ) ) {
+            skip_line();
+            continue;
+        }
+
+        std::streamoff position = input_position();
+        line = read_line(text);
+
+        switch(peek) {
+            case 'E': {
+                Tokenizer tok(line+1);
+                header.offset       = ( position < 0 ) ? 0 : position;
+                header.event_number = tok.read_int();
+                header.vertices     = tok.read_int();
+                header.particles    = tok.read_int();
+                is_parsing_successful = !tok.failed();
+                parsed_event_header   = true;
+                break;
+            }
+            case 'W':
+                is_parsing_successful = parse_weight_names(line);
+                break;
+            case 'T':
+                is_parsing_successful = parse_tool(line);
+                break;
+            case 'A':
+                is_parsing_successful = parse_run_attribute(line);
+                break;
+        }
+
+        if( !is_parsing_successful ) {
+            ERROR( "ReaderAscii: event scanning failed" )
+            DEBUG( 1, "Scanning failed at line:" << endl << string(line,Tokenizer::line_end(line)) )
+
+            if( m_map_begin ) m_map_failed = true;
+            else input().clear(ios::badbit);
+
+            return false;
+        }
+    }
+
+    return false;
+}
+
+
+std::streamoff ReaderAscii::input_position() {
+    if( m_map_begin ) return m_map_cursor - m_map_begin;
+    return input().tellg();
+}
+
+
+std::streamoff ReaderAscii::input_size() {
+    if( m_map_begin ) return m_map_end - m_map_begin;
+
+    std::istream  &in       = input();
+    std::streamoff position = in.tellg();
+    if( position < 0 ) return -1;
+
+    // The end of compressed input is unknown, seeking there fails
+    std::ios::iostate state = in.rdstate();
+    in.seekg( 0, std::ios::end );
+    std::streamoff size = in.tellg();
+    in.clear(state);
+    in.seekg( position );
+
+    return size;
+}
+
+
+char ReaderAscii::peek_input() {
+    if( m_map_begin ) return ( m_map_cursor != m_map_end ) ? *m_map_cursor : 0;
+
+    int c = input().peek();
+    return ( c == std::char_traits<char>::eof() ) ? 0 : c;
+}
+
+
+bool ReaderAscii::seek_offset(unsigned long long offset) {
+    if( m_map_begin ) {
+        if( offset < (unsigned long long)(m_map_end - m_map_begin) ) {
+            m_map_cursor = m_map_begin + offset;
+            m_map_failed = false;
+        }
+        else m_map_failed = true;
+    }
+    else {
+        input().clear();
+        input().seekg( offset );
+    }
+
+    if( failed() || peek_input() != 'E' ) {
+        ERROR( "ReaderAscii: index does not match the input, no event at offset " << offset )
+        if( m_map_begin ) m_map_failed = true;
+        else input().clear(ios::badbit);
+        return false;
+    }
+
+    return true;
+}
+
+
+void ReaderAscii::skip_line() {
+    if( m_map_begin ) m_map_cursor = static_cast<const char*>( memchr(m_map_cursor,'\n',m_map_end-m_map_cursor) ) + 1;
+    else input().ignore( std::numeric_limits<std::streamsize>::max(), '\n' );
+}
+
+
+const char* ReaderAscii::read_line(std::string &text) {
+    if( m_map_begin ) {
+        const char *line = m_map_cursor;
+        skip_line();
+        return line;
+    }
+
+    std::getline( input(), text );
+    return text.c_str();
+}
+
+
+void ReaderAscii::discard_parsed_events() {
+    typedef ParallelParser::Task Task;
+
+    if( !m_parallel || m_parallel->pending.empty() ) return;
+
+    ParallelParser &parallel = *m_parallel;
+    std::unique_lock<std::mutex> lock( parallel.mutex );
+
+    // Tasks not taken by workers are dropped, the others have to be finished
+    FOREACH( Task *task, parallel.queue ) task->status = ParallelParser::FAILED;
+    parallel.queue.clear();
+
+    FOREACH( Task *task, parallel.pending ) {
+        while( task->status == ParallelParser::PARSING ) parallel.task_done.wait(lock);
+        parallel.recycle(task);
+    }
+
+    parallel.pending.clear();
+}
+
+
 void ReaderAscii::close() {
+    // Workers parse the mapped file
+    stop_parallel();
+
+    if( m_map_begin ) {
+        munmap( const_cast<char*>(m_map_begin), m_map_end-m_map_begin );
+        m_map_begin = m_map_end = m_map_cursor = NULL;
+        m_map_failed = false;
+    }
     if( !m_file.is_open()) return;
     m_file.close();
 }
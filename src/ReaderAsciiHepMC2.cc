@@ -16,9 +16,10 @@
 #include "HepMC/GenHeavyIon.h"
 #include "HepMC/GenPdfInfo.h"
 #include "HepMC/Setup.h"
+#include "HepMC/Tokenizer.h"
 
 #include <cstring>
-#include <cstdlib>
+#include <limits>
 
 namespace HepMC {
 
@@ -48,6 +49,7 @@ bool ReaderAsciiHepMC2::read_event(GenEvent &evt) {
     m_vertex_barcodes.clear();
 
     m_particle_cache.clear();
+    m_particle_barcodes.clear();
     m_end_vertex_barcodes.clear();
     m_particle_cache_ghost.clear();
     //
@@ -78,6 +80,7 @@ bool ReaderAsciiHepMC2::read_event(GenEvent &evt) {
                     vertices_count = parsing_result;
                     m_vertex_cache.reserve(vertices_count);
                     m_particle_cache.reserve(vertices_count*3);
+                    m_particle_barcodes.reserve(vertices_count*3);
                     m_vertex_barcodes.reserve(vertices_count);
                     m_end_vertex_barcodes.reserve(vertices_count*3);
                     is_parsing_successful = true;
@@ -172,15 +175,18 @@ bool ReaderAsciiHepMC2::read_event(GenEvent &evt) {
     }
 
     // Restore production vertex pointers
+    m_vertex_barcode_index.clear();
+
+    for(unsigned int j=m_vertex_cache.size(); j>0; --j) {
+        m_vertex_barcode_index[ m_vertex_barcodes[j-1] ] = j-1;
+    }
+
     for(unsigned int i=0; i<m_particle_cache.size(); ++i) {
         if( !m_end_vertex_barcodes[i] ) continue;
 
-        for(unsigned int j=0; j<m_vertex_cache.size(); ++j) {
-            if( m_vertex_barcodes[j] == m_end_vertex_barcodes[i] ) {
-                m_vertex_cache[j]->add_particle_in(m_particle_cache[i]);
-                break;
-            }
-        }
+        std::unordered_map<int,unsigned int>::const_iterator it = m_vertex_barcode_index.find( m_end_vertex_barcodes[i] );
+
+        if( it != m_vertex_barcode_index.end() ) m_vertex_cache[it->second]->add_particle_in(m_particle_cache[i]);
     }
 
     // Remove vertices with no incoming particles or no outgoing particles
@@ -199,6 +205,15 @@ bool ReaderAsciiHepMC2::read_event(GenEvent &evt) {
     // Add whole event tree in topological order
     evt.add_tree( m_particle_cache );
 
+    // Keep original barcodes
+    for(unsigned int i=0; i<m_particle_cache.size(); ++i) {
+        evt.set_barcode( m_particle_cache[i], m_particle_barcodes[i] );
+    }
+
+    for(unsigned int i=0; i<m_vertex_cache.size(); ++i) {
+        if( m_vertex_cache[i] ) evt.set_barcode( m_vertex_cache[i], m_vertex_barcodes[i] );
+    }
+
     for(unsigned int i=0; i<m_particle_cache.size(); ++i) {
      if(m_particle_cache_ghost[i]->attribute_names().size()) 
      {
@@ -214,11 +229,15 @@ bool ReaderAsciiHepMC2::read_event(GenEvent &evt) {
     }
     m_particle_cache_ghost.clear();
     m_event_ghost->clear(); 
+
+    apply_read_options(evt);
+    account_memory(evt);
+
     return 1;
 }
 
 int ReaderAsciiHepMC2::parse_event_information(GenEvent &evt, const char *buf) {
-    const char          *cursor             = buf;
+    Tokenizer            tok(buf+1);
     int                  event_no           = 0;
     int                  vertices_count     = 0;
     int                  random_states_size = 0;
@@ -227,73 +246,66 @@ int ReaderAsciiHepMC2::parse_event_information(GenEvent &evt, const char *buf) {
     std::vector<double>  weights(0);
 
     // event number
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    event_no = atoi(cursor);
-    evt.set_event_number(event_no);
+    event_no = tok.read_int();
 
     //mpi
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<IntAttribute> mpi = make_shared<IntAttribute>(atoi(cursor));
-    evt.add_attribute("mpi",mpi);
+    int mpi = tok.read_int();
 
     //event scale
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<DoubleAttribute> event_scale = make_shared<DoubleAttribute>(atof(cursor));
-    evt.add_attribute("event_scale",event_scale);
+    double event_scale = tok.read_double();
 
     //alpha_qcd
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<DoubleAttribute> alphaQCD = make_shared<DoubleAttribute>(atof(cursor));
-    evt.add_attribute("alphaQCD",alphaQCD);
+    double alphaQCD = tok.read_double();
 
     //alpha_qed
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<DoubleAttribute> alphaQED = make_shared<DoubleAttribute>(atof(cursor));
-    evt.add_attribute("alphaQED",alphaQED);
+    double alphaQED = tok.read_double();
 
     //signal_process_id
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<IntAttribute> signal_process_id = make_shared<IntAttribute>(atoi(cursor));
-    evt.add_attribute("signal_process_id",signal_process_id);
+    int signal_process_id = tok.read_int();
 
     //signal_process_vertex
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<IntAttribute> signal_process_vertex = make_shared<IntAttribute>(atoi(cursor));
-    evt.add_attribute("signal_process_vertex",signal_process_vertex);
+    int signal_process_vertex = tok.read_int();
 
     // num_vertices
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    vertices_count = atoi(cursor);
+    vertices_count = tok.read_int();
 
     // SKIPPED: beam 1
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
+    tok.skip_field();
 
     // SKIPPED: beam 2
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
+    tok.skip_field();
 
     //random states
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    random_states_size = atoi(cursor);
+    random_states_size = tok.read_int();
+    if( tok.failed() || random_states_size < 0 ) return -1;
     random_states.resize(random_states_size);
 
     for ( int i = 0; i < random_states_size; ++i ) {
-        if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-        random_states[i] = atoi(cursor);
+        random_states[i] = tok.read_long();
     }
-    
-    for ( int i = 0; i < random_states_size; ++i ) 
-    evt.add_attribute("random_states"+to_string(i),make_shared<IntAttribute>(random_states[i]));
 
     // weights
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    weights_size = atoi(cursor);
+    weights_size = tok.read_int();
+    if( tok.failed() || weights_size < 0 ) return -1;
     weights.resize(weights_size);
 
     for ( int i = 0; i < weights_size; ++i ) {
-        if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-        weights[i] = atof(cursor);
+        weights[i] = tok.read_double();
     }
 
+    if( tok.failed() ) return -1;
+
+    evt.set_event_number(event_no);
+    evt.add_attribute("mpi",make_shared<IntAttribute>(mpi));
+    evt.add_attribute("event_scale",make_shared<DoubleAttribute>(event_scale));
+    evt.add_attribute("alphaQCD",make_shared<DoubleAttribute>(alphaQCD));
+    evt.add_attribute("alphaQED",make_shared<DoubleAttribute>(alphaQED));
+    evt.add_attribute("signal_process_id",make_shared<IntAttribute>(signal_process_id));
+    evt.add_attribute("signal_process_vertex",make_shared<IntAttribute>(signal_process_vertex));
+
+    for ( int i = 0; i < random_states_size; ++i ) 
+    evt.add_attribute("random_states"+to_string(i),make_shared<IntAttribute>(random_states[i]));
+
     evt.weights() = weights;
 
     DEBUG( 10, "ReaderAsciiHepMC2: E: "<<event_no<<" ("<<vertices_count<<"V, "<<weights_size<<"W, "<<random_states_size<<"RS)" )
@@ -302,19 +314,17 @@ int ReaderAsciiHepMC2::parse_event_information(GenEvent &evt, const char *buf) {
 }
 
 bool ReaderAsciiHepMC2::parse_units(GenEvent &evt, const char *buf) {
-    const char *cursor  = buf;
+    Tokenizer tok(buf+1);
 
     // momentum
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    ++cursor;
-    Units::MomentumUnit momentum_unit = Units::momentum_unit(cursor);
+    string momentum = tok.read_string();
 
     // length
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    ++cursor;
-    Units::LengthUnit length_unit = Units::length_unit(cursor);
+    string length   = tok.read_string();
+
+    if( tok.failed() ) return false;
 
-    evt.set_units(momentum_unit,length_unit);
+    evt.set_units( Units::momentum_unit(momentum), Units::length_unit(length) );
 
     DEBUG( 10, "ReaderAsciiHepMC2: U: " << Units::name(evt.momentum_unit()) << " " << Units::name(evt.length_unit()) )
 
@@ -324,43 +334,33 @@ bool ReaderAsciiHepMC2::parse_units(GenEvent &evt, const char *buf) {
 int ReaderAsciiHepMC2::parse_vertex_information(const char *buf) {
     GenVertexPtr  data = make_shared<GenVertex>();
     FourVector    position;
-    const char   *cursor            = buf;
+    Tokenizer     tok(buf+1);
     int           barcode           = 0;
     int           num_particles_out = 0;
 
     // barcode
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    barcode = atoi(cursor);
+    barcode = tok.read_int();
 
     // SKIPPED: id
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-
-    // x
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    position.setX(atof(cursor));
-
-    // y
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    position.setY(atof(cursor));
-
-    // z
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    position.setZ(atof(cursor));
+    tok.skip_field();
 
-    // t
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    position.setT(atof(cursor));
+    // position
+    position.setX( tok.read_double() );
+    position.setY( tok.read_double() );
+    position.setZ( tok.read_double() );
+    position.setT( tok.read_double() );
     data->set_position( position );
 
     // SKIPPED: num_orphans_in
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
+    tok.skip_field();
 
     // num_particles_out
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    num_particles_out = atoi(cursor);
+    num_particles_out = tok.read_int();
 
     // SKIPPING: weights_size, weights
 
+    if( tok.failed() ) return -1;
+
     // Add original vertex barcode to the cache
     m_vertex_cache.push_back( data );
     m_vertex_barcodes.push_back( barcode );
@@ -373,70 +373,59 @@ int ReaderAsciiHepMC2::parse_vertex_information(const char *buf) {
 int ReaderAsciiHepMC2::parse_particle_information(const char *buf) {
     GenParticlePtr  data = make_shared<GenParticle>();
     GenParticlePtr  data_ghost = make_shared<GenParticle>();
-    m_event_ghost->add_particle(data_ghost);
     FourVector      momentum;
-    const char     *cursor  = buf;
+    Tokenizer       tok(buf+1);
+    int             barcode = 0;
     int             end_vtx = 0;
 
-    /// @todo barcode ignored but maybe should be put as an attribute?...
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
+    // barcode
+    barcode = tok.read_int();
 
     // id
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    data->set_pid( atoi(cursor) );
-
-    // px
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    momentum.setPx(atof(cursor));
+    data->set_pid( tok.read_int() );
 
-    // py
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    momentum.setPy(atof(cursor));
-
-    // pz
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    momentum.setPz(atof(cursor));
-
-    // pe
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    momentum.setE(atof(cursor));
+    // momentum
+    momentum.setPx( tok.read_double() );
+    momentum.setPy( tok.read_double() );
+    momentum.setPz( tok.read_double() );
+    momentum.setE(  tok.read_double() );
     data->set_momentum(momentum);
 
     // m
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    data->set_generated_mass( atof(cursor) );
+    data->set_generated_mass( tok.read_double() );
 
     // status
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    data->set_status( atoi(cursor) );
+    data->set_status( tok.read_int() );
 
     //theta
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<DoubleAttribute> theta = make_shared<DoubleAttribute>(atof(cursor));
-    if (theta->value()!=0.0) data_ghost->add_attribute("theta",theta);
+    double theta = tok.read_double();
 
     //phi
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    shared_ptr<DoubleAttribute> phi = make_shared<DoubleAttribute>(atof(cursor));
-    if (phi->value()!=0.0) data_ghost->add_attribute("phi",phi);
+    double phi = tok.read_double();
 
     // end_vtx_code
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    end_vtx = atoi(cursor);
+    end_vtx = tok.read_int();
 
     //flow
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    int flowsize=atoi(cursor);
-    
+    int flowsize = tok.read_int();
+    if( tok.failed() ) return -1;
+
+    m_event_ghost->add_particle(data_ghost);
+
+    if (theta!=0.0) data_ghost->add_attribute("theta",make_shared<DoubleAttribute>(theta));
+    if (phi!=0.0)   data_ghost->add_attribute("phi",make_shared<DoubleAttribute>(phi));
+
     for (int i=0;i<flowsize;i++)
     {
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    int flowindex=atoi(cursor);
-    if( !(cursor = strchr(cursor+1,' ')) ) return -1;
-    int flowvalue=atoi(cursor);
+    int flowindex = tok.read_int();
+    int flowvalue = tok.read_int();
+    if( tok.failed() ) return -1;
     data_ghost->add_attribute("flow"+to_string(flowindex),make_shared<IntAttribute>(flowvalue));
     }
 
+    // Particle must follow a vertex
+    if( m_vertex_cache.empty() ) return -1;
+
     // Set prod_vtx link
     if( end_vtx == m_vertex_barcodes.back() ) {
         m_vertex_cache.back()->add_particle_in(data);
@@ -447,6 +436,7 @@ int ReaderAsciiHepMC2::parse_particle_information(const char *buf) {
     }
 
     m_particle_cache.push_back( data );
+    m_particle_barcodes.push_back( barcode );
     m_particle_cache_ghost.push_back( data_ghost );
     m_end_vertex_barcodes.push_back( end_vtx );
 
@@ -456,14 +446,13 @@ int ReaderAsciiHepMC2::parse_particle_information(const char *buf) {
 }
 
 bool ReaderAsciiHepMC2::parse_xs_info(GenEvent &evt, const char *buf) {
-    const char *cursor  = buf;
+    Tokenizer                    tok(buf+1);
     shared_ptr<GenCrossSection>  xs     = make_shared<GenCrossSection>();
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    double xs_val  = atof(cursor);
+    double xs_val = tok.read_double();
+    double xs_err = tok.read_double();
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    double xs_err = atof(cursor);
+    if( tok.failed() ) return false;
 
     xs->set_cross_section( xs_val , xs_err);
     evt.add_attribute("GenCrossSection",xs);
@@ -472,6 +461,7 @@ bool ReaderAsciiHepMC2::parse_xs_info(GenEvent &evt, const char *buf) {
 }
 
 bool ReaderAsciiHepMC2::parse_weight_names(const char *buf) {
+    Tokenizer       tok(buf+1);
     const char     *cursor  = buf;
     const char     *cursor2 = buf;
     int             w_count = 0;
@@ -480,24 +470,25 @@ bool ReaderAsciiHepMC2::parse_weight_names(const char *buf) {
     // Ignore weight names if no GenRunInfo object
     if( !run_info() ) return true;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    w_count = atoi(cursor);
+    w_count = tok.read_int();
 
-    if( w_count <= 0 ) return false;
+    if( tok.failed() || w_count <= 0 ) return false;
 
     w_names.resize(w_count);
 
+    cursor = tok.cursor();
+
     for( int i=0; i < w_count; ++i ) {
         // Find pair of '"' characters
-        if( !(cursor  = strchr(cursor+1,'"')) ) return false;
-        if( !(cursor2 = strchr(cursor+1,'"')) ) return false;
+        if( !(cursor  = Tokenizer::find_in_line(cursor,'"')) ) return false;
+        if( !(cursor2 = Tokenizer::find_in_line(cursor+1,'"')) ) return false;
 
         // Strip cursor of leading '"' character
         ++cursor;
 
         w_names[i].assign(cursor, cursor2-cursor);
 
-        cursor = cursor2;
+        cursor = cursor2+1;
     }
 
     run_info()->set_weight_names(w_names);
@@ -507,87 +498,189 @@ bool ReaderAsciiHepMC2::parse_weight_names(const char *buf) {
 
 bool ReaderAsciiHepMC2::parse_heavy_ion(GenEvent &evt, const char *buf) {
     shared_ptr<GenHeavyIon>  hi     = make_shared<GenHeavyIon>();
-    const char              *cursor = buf;
+    Tokenizer                tok(buf+1);
+
+    hi->Ncoll_hard                   = tok.read_int();
+    hi->Npart_proj                   = tok.read_int();
+    hi->Npart_targ                   = tok.read_int();
+    hi->Ncoll                        = tok.read_int();
+    hi->spectator_neutrons           = tok.read_int();
+    hi->spectator_protons            = tok.read_int();
+    hi->N_Nwounded_collisions        = tok.read_int();
+    hi->Nwounded_N_collisions        = tok.read_int();
+    hi->Nwounded_Nwounded_collisions = tok.read_int();
+    hi->impact_parameter             = tok.read_double();
+    hi->event_plane_angle            = tok.read_double();
+    hi->eccentricity                 = tok.read_double();
+    hi->sigma_inel_NN                = tok.read_double();
+
+    if( tok.failed() ) return false;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->Ncoll_hard = atoi(cursor);
-
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->Npart_proj = atoi(cursor);
+    // Not in HepMC2:
+    hi->centrality = 0.0;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->Npart_targ = atoi(cursor);
+    evt.add_attribute("GenHeavyIon",hi);
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->Ncoll = atoi(cursor);
+    return true;
+}
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->spectator_neutrons = atoi(cursor);
+bool ReaderAsciiHepMC2::parse_pdf_info(GenEvent &evt, const char *buf) {
+    shared_ptr<GenPdfInfo>  pi     = make_shared<GenPdfInfo>();
+    Tokenizer               tok(buf+1);
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->spectator_protons = atoi(cursor);
+    pi->parton_id[0] = tok.read_int();
+    pi->parton_id[1] = tok.read_int();
+    pi->x[0]         = tok.read_double();
+    pi->x[1]         = tok.read_double();
+    pi->scale        = tok.read_double();
+    pi->xf[0]        = tok.read_double();
+    pi->xf[1]        = tok.read_double();
+    pi->pdf_id[0]    = tok.read_int();
+    pi->pdf_id[1]    = tok.read_int();
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->N_Nwounded_collisions = atoi(cursor);
+    if( tok.failed() ) return false;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->Nwounded_N_collisions = atoi(cursor);
+    evt.add_attribute("GenPdfInfo",pi);
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->Nwounded_Nwounded_collisions = atoi(cursor);
+    return true;
+}
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->impact_parameter = atof(cursor);
+bool ReaderAsciiHepMC2::load_index(const std::string &filename) {
+    EventIndex index;
+    if( !index.read(filename) ) return false;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->event_plane_angle = atof(cursor);
+    if( index.format() != EventIndex::HEPMC2 ) {
+        ERROR( "ReaderAsciiHepMC2: index does not belong to a HepMC2 file: " << filename )
+        return false;
+    }
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->eccentricity = atof(cursor);
+    // The end of compressed input is unknown, seeking there fails
+    std::ios::iostate state = m_file.rdstate();
+    std::streamoff position = m_file.tellg();
+    m_file.seekg( 0, std::ios::end );
+    std::streamoff size = m_file.tellg();
+    m_file.clear(state);
+    m_file.seekg( position );
+
+    if( size >= 0 && (unsigned long long)size != index.file_size() ) {
+        ERROR( "ReaderAsciiHepMC2: index does not match size of the input: " << filename )
+        return false;
+    }
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    hi->sigma_inel_NN = atof(cursor);
+    std::swap( m_index, index );
+    return true;
+}
 
-    // Not in HepMC2:
-    hi->centrality = 0.0;
+bool ReaderAsciiHepMC2::seek_event(int event_number) {
+    if( m_index.empty() ) {
+        ERROR( "ReaderAsciiHepMC2: seeking events requires an index, see load_index()" )
+        return false;
+    }
 
-    evt.add_attribute("GenHeavyIon",hi);
+    size_t i = m_index.find(event_number);
+    if( i == m_index.size() ) {
+        ERROR( "ReaderAsciiHepMC2: no event " << event_number << " in the index" )
+        return false;
+    }
 
-    return true;
+    return seek_offset( m_index[i].offset );
 }
 
-bool ReaderAsciiHepMC2::parse_pdf_info(GenEvent &evt, const char *buf) {
-    shared_ptr<GenPdfInfo>  pi     = make_shared<GenPdfInfo>();
-    const char             *cursor = buf;
+bool ReaderAsciiHepMC2::skip(int n) {
+    if( failed() ) return false;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->parton_id[0] = atoi(cursor);
+    // Move to the next event, e.g. after the header
+    while( m_file.peek() != 'E' ) {
+        m_file.ignore( std::numeric_limits<std::streamsize>::max(), '\n' );
+        if( failed() ) return false;
+    }
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->parton_id[1] = atoi(cursor);
+    if( n <= 0 ) return true;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->x[0] = atof(cursor);
+    std::streamoff position = m_file.tellg();
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->x[1] = atof(cursor);
+    if( !m_index.empty() && position >= 0 ) {
+        size_t next = m_index.position(position) + n;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->scale = atof(cursor);
+        // Skipping the remaining events leaves the input at its end
+        if( next >= m_index.size() ) {
+            m_file.seekg( 0, std::ios::end );
+            m_file.setstate( std::ios::eofbit );
+            return next == m_index.size();
+        }
+
+        return seek_offset( m_index[next].offset );
+    }
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->xf[0] = atof(cursor);
+    // Without index events are found by their E lines
+    while( true ) {
+        m_file.ignore( std::numeric_limits<std::streamsize>::max(), '\n' );
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->xf[1] = atof(cursor);
+        int c = m_file.peek();
+        // The last event ends at the end of the input
+        if( c == std::char_traits<char>::eof() ) return n == 1;
+        if( c == 'E' && --n == 0 ) return true;
+    }
+}
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->pdf_id[0] = atoi(cursor);
+bool ReaderAsciiHepMC2::scan_event(EventIndex::Entry &header) {
+    std::string line;
+    bool        parsed_event_header   = false;
+    bool        is_parsing_successful = true;
 
-    if( !(cursor = strchr(cursor+1,' ')) ) return false;
-    pi->pdf_id[1] = atoi(cursor);
+    while( !failed() ) {
+        int peek = m_file.peek();
 
-    evt.add_attribute("GenPdfInfo",pi);
+        // Event ends before the next event or the footer
+        if( parsed_event_header && ( peek == 'E' || peek == 'H' || peek == std::char_traits<char>::eof() ) ) return true;
+
+        if( parsed_event_header && peek == 'P' ) ++header.particles;
+
+        // Lines other than the E line and weight names are not needed
+        if( peek != 'E' && !( parsed_event_header && peek == 'N' ) ) {
+            m_file.ignore( std::numeric_limits<std::streamsize>::max(), '\n' );
+            continue;
+        }
+
+        std::streamoff position = m_file.tellg();
+        std::getline( m_file, line );
+
+        if( peek == 'E' ) {
+            Tokenizer tok(line.c_str()+1);
+            header.offset       = ( position < 0 ) ? 0 : position;
+            header.event_number = tok.read_int();
+            tok.skip_field(); // mpi
+            tok.skip_field(); // event scale
+            tok.skip_field(); // alpha_qcd
+            tok.skip_field(); // alpha_qed
+            tok.skip_field(); // signal_process_id
+            tok.skip_field(); // signal_process_vertex
+            header.vertices     = tok.read_int();
+            header.particles    = 0;
+            is_parsing_successful = !tok.failed();
+            parsed_event_header   = true;
+        }
+        else is_parsing_successful = parse_weight_names(line.c_str());
+
+        if( !is_parsing_successful ) {
+            ERROR( "ReaderAsciiHepMC2: event scanning failed" )
+            m_file.clear(std::ios::badbit);
+            return false;
+        }
+    }
+
+    return false;
+}
+
+bool ReaderAsciiHepMC2::seek_offset(unsigned long long offset) {
+    m_file.clear();
+    m_file.seekg( offset );
+
+    if( failed() || m_file.peek() != 'E' ) {
+        ERROR( "ReaderAsciiHepMC2: index does not match the input, no event at offset " << offset )
+        m_file.clear(std::ios::badbit);
+        return false;
+    }
 
     return true;
 }
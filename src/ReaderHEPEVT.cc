@@ -6,8 +6,9 @@
  */
 #include "HepMC/ReaderHEPEVT.h"
 #include "HepMC/HEPEVT_Wrapper.h"
+#include "HepMC/Tokenizer.h"
 
-#include <sstream>
+#include <cmath>
 namespace HepMC
 {
 
@@ -36,19 +37,12 @@ bool ReaderHEPEVT::read_hepevt_event_header()
     while(!eventline)
         {
             if (fgets(buf_e,READERHEPEVTBUFFERSIZE,m_file)==NULL) break;
-            std::stringstream st_e(buf_e);
-            char attr=' ';
-            eventline=false;
-            while (!eventline)
-                {
-                    if (!(st_e>>attr)) break;
-                    if (attr==' ') continue;
-                    else eventline=false;
-                    if (attr=='E')
-                        {
-                            eventline=static_cast<bool>(st_e>>m_i>>m_p);
-                        }
-                }
+            const char *cursor=Tokenizer::find_in_line(buf_e,'E');
+            if (!cursor) continue;
+            Tokenizer tok(cursor+1);
+            m_i=tok.read_int();
+            m_p=tok.read_int();
+            eventline=!tok.failed();
         }
     HEPEVT_Wrapper::set_event_number(m_i);
     HEPEVT_Wrapper::set_number_entries(m_p);
@@ -65,16 +59,27 @@ bool ReaderHEPEVT::read_hepevt_particle( int i, bool iflong )
     double fltcodes2[4];
     if (fgets(buf_p,READERHEPEVTBUFFERSIZE,m_file)==NULL) return false;
     if (iflong) if (fgets(buf_v,READERHEPEVTBUFFERSIZE,m_file)==NULL) return false;
-    std::stringstream st_p(buf_p);
-    std::stringstream st_v(buf_v);
+    Tokenizer st_p(buf_p);
     if (iflong)
         {
-            if (!static_cast<bool>(st_p>>intcodes[0]>>intcodes[1]>>intcodes[2]>>intcodes[3]>>intcodes[4]>>intcodes[5]>>fltcodes1[0]>>fltcodes1[1]>>fltcodes1[2]>>fltcodes1[3]>>fltcodes1[4])) { ERROR( "ReaderHEPEVT: Error reading particle momenta"); 	return false;}
-            if (!static_cast<bool>(st_v>>fltcodes2[0]>>fltcodes2[1]>>fltcodes2[2]>>fltcodes2[3])) { ERROR( "ReaderHEPEVT: Error reading particle vertex");  return false;}
+            Tokenizer st_v(buf_v);
+            for (int k=0; k<6; k++) intcodes[k]=st_p.read_int();
+            for (int k=0; k<5; k++) fltcodes1[k]=st_p.read_double();
+            if (st_p.failed()) { ERROR( "ReaderHEPEVT: Error reading particle momenta"); 	return false;}
+            for (int k=0; k<4; k++) fltcodes2[k]=st_v.read_double();
+            if (st_v.failed()) { ERROR( "ReaderHEPEVT: Error reading particle vertex");  return false;}
         }
     else
         {
-            if (!static_cast<bool>(st_p>>intcodes[0]>>intcodes[1]>>intcodes[4]>>intcodes[5]>>fltcodes1[0]>>fltcodes1[1]>>fltcodes1[2]>>fltcodes1[4])) {ERROR( "ReaderHEPEVT: Error reading particle momenta"); 	return false;}
+            intcodes[0]=st_p.read_int();
+            intcodes[1]=st_p.read_int();
+            intcodes[4]=st_p.read_int();
+            intcodes[5]=st_p.read_int();
+            fltcodes1[0]=st_p.read_double();
+            fltcodes1[1]=st_p.read_double();
+            fltcodes1[2]=st_p.read_double();
+            fltcodes1[4]=st_p.read_double();
+            if (st_p.failed()) {ERROR( "ReaderHEPEVT: Error reading particle momenta"); 	return false;}
             intcodes[2]=0;//FIXME!
             intcodes[3]=0;//FIXME!
             fltcodes1[3]=std::sqrt(fltcodes1[0]*fltcodes1[0]+fltcodes1[1]*fltcodes1[1]+fltcodes1[2]*fltcodes1[2]+fltcodes1[4]*fltcodes1[4]);
@@ -114,6 +119,11 @@ bool ReaderHEPEVT::read_event(GenEvent& evt, bool iflong)
             g->set_weight_names(weightnames);
             evt.set_run_info(g);
             evt.weights()=wts;
+            if (result)
+                {
+                    apply_read_options(evt);
+                    account_memory(evt);
+                }
         }
     else m_failed=true;
     return result;
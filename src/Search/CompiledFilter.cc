@@ -0,0 +1,675 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+/**
+ *  @file CompiledFilter.cc
+ *  @brief Implementation of \b class CompiledFilter
+ *
+ */
+#include "HepMC/Search/CompiledFilter.h"
+#include "HepMC/Search/Filter.h"
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenVertex.h"
+#include "HepMC/GenParticle.h"
+#include "HepMC/Setup.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+
+namespace HepMC {
+
+
+CompiledFilter::CompiledFilter():m_checked(0),m_reorder_interval(0),m_collect_statistics(false),m_never(false) {}
+
+
+CompiledFilter::CompiledFilter(const FilterList &filter_list):m_checked(0),m_reorder_interval(0),m_collect_statistics(false),m_never(false) {
+
+    FOREACH( const Filter &f, filter_list.filters() ) {
+        compile(f);
+    }
+
+    std::stable_sort( m_code.begin(), m_code.end(), cheaper );
+
+    DEBUG( 10, "CompiledFilter: "<<filter_list.filters().size()<<" filters compiled into "<<m_code.size()<<" instructions" )
+}
+
+
+void CompiledFilter::compile(const Filter &f) {
+
+    Instruction ins;
+    ins.negate = false;
+    ins.lo     = 0;
+    ins.hi     = 0;
+    ins.dlo    = 0.;
+    ins.dhi    = 0.;
+    ins.mask   = 0;
+    ins.bits   = 0;
+
+    switch( f.m_value_type ) {
+        case Filter::INTEGER_PARAM: {
+
+            OpCode op = OP_STATUS_RANGE;
+
+            switch( f.m_int ) {
+                case Filter::STATUS:     op = OP_STATUS_RANGE;     break;
+                case Filter::PDG_ID:     op = OP_PDG_ID_RANGE;     break;
+                case Filter::ABS_PDG_ID: op = OP_ABS_PDG_ID_RANGE; break;
+            }
+
+            // Every operator is expressed as (negated) closed range
+            int v = f.m_int_value;
+
+            switch( f.m_operator ) {
+                case Filter::EQUAL:            add_range(op, v,       v,       false); break;
+                case Filter::NOT_EQUAL:        add_range(op, v,       v,       true ); break;
+                case Filter::GREATER_OR_EQUAL: add_range(op, v,       INT_MAX, false); break;
+                case Filter::LESS_OR_EQUAL:    add_range(op, INT_MIN, v,       false); break;
+                case Filter::GREATER:
+                    if( v == INT_MAX ) m_never = true;
+                    else add_range(op, v+1, INT_MAX, false);
+                    break;
+                case Filter::LESS:
+                    if( v == INT_MIN ) m_never = true;
+                    else add_range(op, INT_MIN, v-1, false);
+                    break;
+            }
+            return;
+        }
+        case Filter::DOUBLE_PARAM: {
+
+            OpCode op = OP_PT_RANGE;
+
+            switch( f.m_double ) {
+                case Filter::PT:                op = OP_PT_RANGE;                break;
+                case Filter::ETA:               op = OP_ETA_RANGE;               break;
+                case Filter::ABS_ETA:           op = OP_ABS_ETA_RANGE;           break;
+                case Filter::RAPIDITY:          op = OP_RAPIDITY_RANGE;          break;
+                case Filter::ABS_RAPIDITY:      op = OP_ABS_RAPIDITY_RANGE;      break;
+                case Filter::ENERGY:            op = OP_ENERGY_RANGE;            break;
+                case Filter::MASS:              op = OP_MASS_RANGE;              break;
+                case Filter::PRODUCTION_RADIUS: op = OP_PRODUCTION_RADIUS_RANGE; break;
+            }
+
+            // Strict comparisons are turned into closed ranges
+            // using the nearest representable value
+            double v   = f.m_double_value;
+            double inf = HUGE_VAL;
+
+            switch( f.m_operator ) {
+                case Filter::EQUAL:            add_range(op, v,                    v,                     false); break;
+                case Filter::NOT_EQUAL:        add_range(op, v,                    v,                     true ); break;
+                case Filter::GREATER_OR_EQUAL: add_range(op, v,                    inf,                   false); break;
+                case Filter::LESS_OR_EQUAL:    add_range(op, -inf,                 v,                     false); break;
+                case Filter::GREATER:          add_range(op, std::nextafter(v,inf), inf,                  false); break;
+                case Filter::LESS:             add_range(op, -inf,                 std::nextafter(v,-inf), false); break;
+            }
+            return;
+        }
+        case Filter::BOOL_PARAM:
+
+            switch( f.m_bool ) {
+                // Status checks are merged with other status filters
+                case Filter::IS_STABLE: add_range(OP_STATUS_RANGE, 1, 1, !f.m_bool_value); return;
+                case Filter::IS_BEAM:   add_range(OP_STATUS_RANGE, 4, 4, !f.m_bool_value); return;
+
+                case Filter::HAS_PRODUCTION_VERTEX:    ins.op = OP_HAS_PRODUCTION_VERTEX;    break;
+                case Filter::HAS_SAME_PDG_ID_DAUGHTER: ins.op = OP_HAS_SAME_PDG_ID_DAUGHTER; break;
+
+                // All remaining filters test particle flags
+                default: add_flag( Filter::flag_mask(f.m_bool), f.m_bool_value ); return;
+            }
+
+            ins.negate = !f.m_bool_value;
+            break;
+        case Filter::ATTRIBUTE_PARAM:
+
+            switch( f.m_attribute ) {
+                case Filter::ATTRIBUTE_EXISTS:   ins.op = OP_ATTRIBUTE_EXISTS;   break;
+                case Filter::ATTRIBUTE_IS_EQUAL: ins.op = OP_ATTRIBUTE_IS_EQUAL; break;
+            }
+
+            ins.negate = !f.m_bool_value;
+            ins.name   = f.m_attribute_name;
+            ins.value  = f.m_attribute_str;
+            break;
+    }
+
+    m_code.push_back(ins);
+}
+
+
+void CompiledFilter::add_range(OpCode op, int lo, int hi, bool negate) {
+
+    // Ranges that are not negated can be intersected with existing ones
+    if( !negate ) {
+        FOREACH( Instruction &ins, m_code ) {
+            if( ins.op != op || ins.negate ) continue;
+
+            if( lo > ins.lo ) ins.lo = lo;
+            if( hi < ins.hi ) ins.hi = hi;
+
+            if( ins.lo > ins.hi ) m_never = true;
+            return;
+        }
+    }
+
+    // abs(pid) is never negative
+    if( op == OP_ABS_PDG_ID_RANGE && lo < 0 ) lo = 0;
+
+    if( lo > hi ) {
+        if( !negate ) m_never = true;
+        return;
+    }
+
+    Instruction ins;
+    ins.op     = op;
+    ins.negate = negate;
+    ins.lo     = lo;
+    ins.hi     = hi;
+    ins.dlo    = 0.;
+    ins.dhi    = 0.;
+    ins.mask   = 0;
+    ins.bits   = 0;
+
+    m_code.push_back(ins);
+}
+
+
+void CompiledFilter::add_range(OpCode op, double lo, double hi, bool negate) {
+
+    // NaN never passes any comparison other than !=
+    if( std::isnan(lo) || std::isnan(hi) ) {
+        if( !negate ) m_never = true;
+        return;
+    }
+
+    if( !negate ) {
+        FOREACH( Instruction &ins, m_code ) {
+            if( ins.op != op || ins.negate ) continue;
+
+            if( lo > ins.dlo ) ins.dlo = lo;
+            if( hi < ins.dhi ) ins.dhi = hi;
+
+            if( ins.dlo > ins.dhi ) m_never = true;
+            return;
+        }
+    }
+
+    if( lo > hi ) {
+        if( !negate ) m_never = true;
+        return;
+    }
+
+    Instruction ins;
+    ins.op     = op;
+    ins.negate = negate;
+    ins.lo     = 0;
+    ins.hi     = 0;
+    ins.dlo    = lo;
+    ins.dhi    = hi;
+    ins.mask   = 0;
+    ins.bits   = 0;
+
+    m_code.push_back(ins);
+}
+
+
+void CompiledFilter::add_flag(unsigned int mask, bool value) {
+
+    unsigned int bits = value ? mask : 0;
+
+    FOREACH( Instruction &ins, m_code ) {
+        if( ins.op != OP_FLAGS ) continue;
+
+        // Same flag required to be both set and unset
+        if( ( ins.mask & mask ) && ( ins.bits & mask ) != bits ) m_never = true;
+
+        ins.mask |= mask;
+        ins.bits |= bits;
+        return;
+    }
+
+    Instruction ins;
+    ins.op     = OP_FLAGS;
+    ins.negate = false;
+    ins.lo     = 0;
+    ins.hi     = 0;
+    ins.dlo    = 0.;
+    ins.dhi    = 0.;
+    ins.mask   = mask;
+    ins.bits   = bits;
+
+    m_code.push_back(ins);
+}
+
+
+/** @brief Check if @a value is within closed range [lo,hi] using single comparison */
+static inline bool in_range(int value, int lo, int hi) {
+    return ( (unsigned int)value - (unsigned int)lo ) <= ( (unsigned int)hi - (unsigned int)lo );
+}
+
+/** @brief Check if @a value is within closed range [lo,hi] */
+static inline bool in_range(double value, double lo, double hi) {
+    return value >= lo && value <= hi;
+}
+
+namespace {
+
+/** @brief Accessors of particle properties used by batch evaluation */
+struct EnergyValue   { double operator()(const GenParticle &p) const { return p.momentum().e();       } };
+struct MassValue     { double operator()(const GenParticle &p) const { return p.generated_mass();     } };
+struct PtValue       { double operator()(const GenParticle &p) const { return p.momentum().pt();      } };
+struct EtaValue      { double operator()(const GenParticle &p) const { return p.momentum().eta();     } };
+struct AbsEtaValue   { double operator()(const GenParticle &p) const { return p.momentum().abs_eta(); } };
+struct RapValue      { double operator()(const GenParticle &p) const { return p.momentum().rap();     } };
+struct AbsRapValue   { double operator()(const GenParticle &p) const { return p.momentum().abs_rap(); } };
+struct StatusValue   { int    operator()(const GenParticle &p) const { return p.status();             } };
+struct PdgIdValue    { int    operator()(const GenParticle &p) const { return p.pid();                } };
+struct AbsPdgIdValue { int    operator()(const GenParticle &p) const { return abs( p.pid() );         } };
+
+/** @brief Keep only selected particles with given flags
+ *
+ *  @return Number of particles left in the selection
+ */
+size_t refine_flags(const vector<GenParticlePtr> &particles, vector<unsigned int> &selection, size_t n, unsigned int mask, unsigned int bits) {
+    size_t kept = 0;
+
+    for(size_t i=0; i<n; ++i) {
+        unsigned int idx = selection[i];
+        if( ( (*particles[idx]).flags() & mask ) == bits ) selection[kept++] = idx;
+    }
+
+    return kept;
+}
+
+/** @brief Keep only selected particles whose property is within range
+ *
+ *  @return Number of particles left in the selection
+ */
+template<class Value, class T>
+size_t refine_range(const vector<GenParticlePtr> &particles, vector<unsigned int> &selection, size_t n, T lo, T hi, bool negate, Value value) {
+    size_t kept = 0;
+
+    for(size_t i=0; i<n; ++i) {
+        unsigned int idx = selection[i];
+        if( in_range( value(*particles[idx]), lo, hi ) != negate ) selection[kept++] = idx;
+    }
+
+    return kept;
+}
+
+} // anonymous namespace
+
+
+bool CompiledFilter::passed_instruction(const Instruction &ins, const GenParticle &p) {
+
+    bool result = false;
+
+    switch( ins.op ) {
+        case OP_STATUS_RANGE:     result = in_range( p.status(),      ins.lo, ins.hi ); break;
+        case OP_PDG_ID_RANGE:     result = in_range( p.pid(),         ins.lo, ins.hi ); break;
+        case OP_ABS_PDG_ID_RANGE: result = in_range( abs( p.pid() ), ins.lo, ins.hi ); break;
+
+        case OP_ENERGY_RANGE:            result = in_range( p.momentum().e(),       ins.dlo, ins.dhi ); break;
+        case OP_MASS_RANGE:              result = in_range( p.generated_mass(),     ins.dlo, ins.dhi ); break;
+        case OP_PT_RANGE:                result = in_range( p.momentum().pt(),      ins.dlo, ins.dhi ); break;
+        case OP_ETA_RANGE:               result = in_range( p.momentum().eta(),     ins.dlo, ins.dhi ); break;
+        case OP_ABS_ETA_RANGE:           result = in_range( p.momentum().abs_eta(), ins.dlo, ins.dhi ); break;
+        case OP_RAPIDITY_RANGE:          result = in_range( p.momentum().rap(),     ins.dlo, ins.dhi ); break;
+        case OP_ABS_RAPIDITY_RANGE:      result = in_range( p.momentum().abs_rap(), ins.dlo, ins.dhi ); break;
+        case OP_PRODUCTION_RADIUS_RANGE: {
+            // Transverse distance of the production vertex from the beam axis
+            const GenVertex *v = p.production_vertex_ptr();
+            result = in_range( v ? v->position().perp() : 0., ins.dlo, ins.dhi );
+            break;
+        }
+
+        case OP_FLAGS:                 result = ( p.flags() & ins.mask ) == ins.bits; break;
+        case OP_HAS_PRODUCTION_VERTEX: result = ( p.production_vertex_ptr() != NULL ); break;
+        case OP_HAS_SAME_PDG_ID_DAUGHTER: {
+            const GenVertex *v = p.end_vertex_ptr();
+            if( !v ) break;
+
+            FOREACH( const GenParticlePtr &p_out, v->particles_out() ) {
+                if( (*p_out).pid() == p.pid() ) {
+                    result = true;
+                    break;
+                }
+            }
+            break;
+        }
+        case OP_ATTRIBUTE_EXISTS:
+        case OP_ATTRIBUTE_IS_EQUAL: {
+            // Compared as by Filter, using the string form of the attribute.
+            // A missing attribute is an empty string
+            const GenEvent *evt = p.parent_event();
+            const Attribute *att = NULL;
+
+            if( evt ) {
+                // Look up the attribute directly instead of through GenParticle
+                std::map< string, std::map<int, shared_ptr<Attribute> > >::const_iterator i1 = evt->attributes().find(ins.name);
+
+                if( i1 != evt->attributes().end() ) {
+                    std::map<int, shared_ptr<Attribute> >::const_iterator i2 = i1->second.find(p.id());
+                    if( i2 != i1->second.end() ) att = i2->second.get();
+                }
+            }
+
+            if( !att ) {
+                result = ( ins.op == OP_ATTRIBUTE_IS_EQUAL && ins.value.empty() );
+                break;
+            }
+
+            // Unparsed attributes hold their string form, only parsed
+            // ones have to be converted
+            if( !att->is_parsed() ) {
+                const string &st = att->unparsed_string();
+
+                if( ins.op == OP_ATTRIBUTE_EXISTS ) result = ( st.length() > 0 );
+                else                                result = ( ins.value == st );
+                break;
+            }
+
+            string st;
+            att->to_string(st);
+
+            if( ins.op == OP_ATTRIBUTE_EXISTS ) result = ( st.length() > 0 );
+            else                                result = ( ins.value == st );
+            break;
+        }
+    };
+
+    return ins.negate ? !result : result;
+}
+
+
+bool CompiledFilter::passed_filter(const GenParticle &p) const {
+
+    if( m_never ) return false;
+
+    if( m_collect_statistics ) return passed_filter_with_statistics(p);
+
+    FOREACH( const Instruction &ins, m_code ) {
+        if( !passed_instruction(ins,p) ) return false;
+    }
+
+    return true;
+}
+
+
+bool CompiledFilter::passed_filter_with_statistics(const GenParticle &p) const {
+
+    bool result = true;
+
+    for(size_t i=0; i<m_code.size(); ++i) {
+        ++m_statistics[i].evaluated;
+
+        if( !passed_instruction(m_code[i],p) ) {
+            result = false;
+            break;
+        }
+
+        ++m_statistics[i].passed;
+    }
+
+    count_checked(1);
+
+    return result;
+}
+
+
+CompiledFilter::IndexHint CompiledFilter::index_hint(int &value) const {
+
+    // Ordered from the most selective index
+    const OpCode    ops  [] = { OP_PDG_ID_RANGE, OP_ABS_PDG_ID_RANGE, OP_STATUS_RANGE };
+    const IndexHint hints[] = { PDG_ID_INDEX,    ABS_PDG_ID_INDEX,    STATUS_INDEX    };
+
+    for( int i=0; i<3; ++i ) {
+        FOREACH( const Instruction &ins, m_code ) {
+            if( ins.op != ops[i] || ins.negate || ins.lo != ins.hi ) continue;
+
+            value = ins.lo;
+            return hints[i];
+        }
+    }
+
+    return NO_INDEX;
+}
+
+
+void CompiledFilter::select(const vector<GenParticlePtr> &particles, vector<GenParticlePtr> &results) const {
+
+    if( m_never ) return;
+
+    if( m_code.empty() ) {
+        results.insert( results.end(), particles.begin(), particles.end() );
+        return;
+    }
+
+    // Indices of particles that passed all instructions executed so far
+    vector<unsigned int> selection( particles.size() );
+    for(unsigned int i=0; i<selection.size(); ++i) selection[i] = i;
+
+    size_t n = selection.size();
+
+    for(size_t k=0; k<m_code.size(); ++k) {
+        if( n == 0 ) break;
+
+        const Instruction &ins = m_code[k];
+
+        std::chrono::steady_clock::time_point start;
+
+        if( m_collect_statistics ) {
+            m_statistics[k].evaluated += n;
+            m_statistics[k].timed     += n;
+            start = std::chrono::steady_clock::now();
+        }
+
+        switch( ins.op ) {
+            case OP_STATUS_RANGE:            n = refine_range( particles, selection, n, ins.lo,  ins.hi,  ins.negate, StatusValue()   ); break;
+            case OP_PDG_ID_RANGE:            n = refine_range( particles, selection, n, ins.lo,  ins.hi,  ins.negate, PdgIdValue()    ); break;
+            case OP_ABS_PDG_ID_RANGE:        n = refine_range( particles, selection, n, ins.lo,  ins.hi,  ins.negate, AbsPdgIdValue() ); break;
+            case OP_FLAGS:                   n = refine_flags( particles, selection, n, ins.mask, ins.bits ); break;
+            case OP_ENERGY_RANGE:            n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, EnergyValue()   ); break;
+            case OP_MASS_RANGE:              n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, MassValue()     ); break;
+            case OP_PT_RANGE:                n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, PtValue()       ); break;
+            case OP_ETA_RANGE:               n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, EtaValue()      ); break;
+            case OP_ABS_ETA_RANGE:           n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, AbsEtaValue()   ); break;
+            case OP_RAPIDITY_RANGE:          n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, RapValue()      ); break;
+            case OP_ABS_RAPIDITY_RANGE:      n = refine_range( particles, selection, n, ins.dlo, ins.dhi, ins.negate, AbsRapValue()   ); break;
+            default: {
+                size_t kept = 0;
+
+                for(size_t i=0; i<n; ++i) {
+                    if( passed_instruction( ins, *particles[selection[i]] ) ) selection[kept++] = selection[i];
+                }
+
+                n = kept;
+                break;
+            }
+        }
+
+        if( m_collect_statistics ) {
+            m_statistics[k].passed += n;
+            m_statistics[k].time   += std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+        }
+    }
+
+    if( m_collect_statistics ) count_checked( particles.size() );
+
+    if( n == 0 ) return;
+
+    results.reserve( results.size() + n );
+
+    for(size_t i=0; i<n; ++i) results.push_back( particles[selection[i]] );
+}
+
+
+void CompiledFilter::enable_statistics(unsigned long reorder_interval) {
+    m_reorder_interval   = reorder_interval;
+    m_collect_statistics = true;
+
+    if( m_statistics.size() != m_code.size() ) reset_statistics();
+}
+
+
+void CompiledFilter::reset_statistics() {
+
+    Statistics empty;
+    empty.evaluated = 0;
+    empty.passed    = 0;
+    empty.timed     = 0;
+    empty.time      = 0.;
+
+    m_statistics.assign( m_code.size(), empty );
+    m_checked = 0;
+}
+
+
+void CompiledFilter::count_checked(unsigned long n) const {
+
+    if( m_reorder_interval == 0 ) return;
+
+    m_checked += n;
+
+    if( m_checked < m_reorder_interval ) return;
+
+    m_checked = 0;
+    reorder();
+}
+
+
+void CompiledFilter::reorder() const {
+
+    if( m_statistics.size() != m_code.size() || m_code.size() < 2 ) return;
+
+    // Optimal order of independent checks: increasing cost per rejected
+    // particle. Measured time is used whenever available, per particle
+    // checked in batch evaluation as other checks are not timed
+    vector< std::pair<double, size_t> > rank( m_code.size() );
+
+    for(size_t i=0; i<m_code.size(); ++i) {
+        const Statistics &st = m_statistics[i];
+
+        double cost = ( st.timed && st.time > 0. ) ? st.time/st.timed : estimated_cost( m_code[i].op );
+        double rejected = 1.0 - st.pass_rate();
+
+        rank[i].first  = ( rejected > 0. ) ? cost/rejected : HUGE_VAL;
+        rank[i].second = i;
+    }
+
+    std::stable_sort( rank.begin(), rank.end() );
+
+    vector<Instruction> code;
+    vector<Statistics>  statistics;
+
+    code.reserve( m_code.size() );
+    statistics.reserve( m_code.size() );
+
+    for(size_t i=0; i<rank.size(); ++i) {
+        code.push_back      ( m_code      [rank[i].second] );
+        statistics.push_back( m_statistics[rank[i].second] );
+    }
+
+    m_code.swap( code );
+    m_statistics.swap( statistics );
+
+    DEBUG( 10, "CompiledFilter: instructions reordered, first: "<<describe(m_code.front()) )
+}
+
+
+vector<CompiledFilter::Statistics> CompiledFilter::statistics() const {
+
+    vector<Statistics> results( m_statistics );
+
+    for(size_t i=0; i<results.size(); ++i) results[i].description = describe( m_code[i] );
+
+    return results;
+}
+
+
+void CompiledFilter::print_statistics(std::ostream& ostr) const {
+
+    ostr << "CompiledFilter statistics:" << std::endl;
+
+    FOREACH( const Statistics &st, statistics() ) {
+        ostr << "  " << st.description
+             << "  evaluated: " << st.evaluated
+             << "  pass rate: " << st.pass_rate()
+             << "  time: "      << st.time << " s" << std::endl;
+    }
+}
+
+
+double CompiledFilter::estimated_cost(OpCode op) {
+
+    switch( op ) {
+        case OP_STATUS_RANGE:
+        case OP_PDG_ID_RANGE:
+        case OP_ABS_PDG_ID_RANGE:
+        case OP_FLAGS:
+        case OP_ENERGY_RANGE:             return 1e-9;
+        case OP_MASS_RANGE:
+        case OP_PT_RANGE:
+        case OP_HAS_PRODUCTION_VERTEX:    return 3e-9;
+        case OP_ETA_RANGE:
+        case OP_ABS_ETA_RANGE:
+        case OP_RAPIDITY_RANGE:
+        case OP_ABS_RAPIDITY_RANGE:       return 2e-8;
+        case OP_PRODUCTION_RADIUS_RANGE:
+        case OP_HAS_SAME_PDG_ID_DAUGHTER: return 3e-8;
+        case OP_ATTRIBUTE_EXISTS:         return 1e-7;
+        case OP_ATTRIBUTE_IS_EQUAL:       return 2e-7;
+    };
+
+    return 1e-7;
+}
+
+
+string CompiledFilter::describe(const Instruction &ins) {
+
+    static const char *names[] = {
+        "STATUS", "PDG_ID", "ABS_PDG_ID", "FLAGS", "ENERGY", "MASS", "PT", "ETA", "ABS_ETA",
+        "RAPIDITY", "ABS_RAPIDITY", "HAS_PRODUCTION_VERTEX", "PRODUCTION_RADIUS",
+        "HAS_SAME_PDG_ID_DAUGHTER", "ATTRIBUTE", "ATTRIBUTE"
+    };
+
+    std::ostringstream os;
+
+    if( ins.negate ) os << "!";
+
+    switch( ins.op ) {
+        case OP_STATUS_RANGE:
+        case OP_PDG_ID_RANGE:
+        case OP_ABS_PDG_ID_RANGE:
+            os << names[ins.op] << " in [" << ins.lo << "," << ins.hi << "]";
+            break;
+        case OP_FLAGS:
+            os << std::hex << "( FLAGS & 0x" << ins.mask << " ) == 0x" << ins.bits;
+            break;
+        case OP_HAS_PRODUCTION_VERTEX:
+        case OP_HAS_SAME_PDG_ID_DAUGHTER:
+            os << names[ins.op];
+            break;
+        case OP_ATTRIBUTE_EXISTS:
+            os << "ATTRIBUTE(\"" << ins.name << "\")";
+            break;
+        case OP_ATTRIBUTE_IS_EQUAL:
+            os << "ATTRIBUTE(\"" << ins.name << "\") == \"" << ins.value << "\"";
+            break;
+        default:
+            os << names[ins.op] << " in [" << ins.dlo << "," << ins.dhi << "]";
+            break;
+    };
+
+    return os.str();
+}
+
+} // namespace HepMC
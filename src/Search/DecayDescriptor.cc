@@ -0,0 +1,37 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+/**
+ *  @file DecayDescriptor.cc
+ *  @brief Implementation of \b class DecayDescriptor
+ *
+ */
+#include "HepMC/Search/DecayDescriptor.h"
+
+namespace HepMC {
+
+DecayDescriptor::DecayDescriptor(const FilterList &filter_list):m_filter(filter_list) {}
+
+DecayDescriptor& DecayDescriptor::add_daughter(const FilterList &filter_list) {
+    m_daughters.push_back( DecayDescriptor(filter_list) );
+    return *this;
+}
+
+DecayDescriptor& DecayDescriptor::add_daughter(const DecayDescriptor &daughter) {
+    m_daughters.push_back( daughter );
+    return *this;
+}
+
+size_t DecayDescriptor::size() const {
+    size_t n = 1;
+
+    FOREACH( const DecayDescriptor &d, m_daughters ) {
+        n += d.size();
+    }
+
+    return n;
+}
+
+} // namespace HepMC
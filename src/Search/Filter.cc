@@ -21,6 +21,7 @@ bool Filter::passed_filter(const GenParticlePtr &p) const {
 
     switch( m_value_type) {
         case INTEGER_PARAM:   return passed_int_filter (p);
+        case DOUBLE_PARAM:    return passed_double_filter(p);
         case BOOL_PARAM:      return passed_bool_filter(p);
         case ATTRIBUTE_PARAM: return passed_attribute_filter(p);
     }
@@ -56,6 +57,41 @@ bool Filter::passed_int_filter(const GenParticlePtr &p ) const {
     return false;
 }
 
+bool Filter::passed_double_filter(const GenParticlePtr &p ) const {
+
+    double value = 0.;
+
+    switch(m_double) {
+        case PT:                value = p->momentum().pt();      break;
+        case ETA:               value = p->momentum().eta();     break;
+        case ABS_ETA:           value = p->momentum().abs_eta(); break;
+        case RAPIDITY:          value = p->momentum().rap();     break;
+        case ABS_RAPIDITY:      value = p->momentum().abs_rap(); break;
+        case ENERGY:            value = p->momentum().e();       break;
+        case MASS:              value = p->generated_mass();     break;
+        case PRODUCTION_RADIUS:
+            if( p->production_vertex() ) value = p->production_vertex()->position().perp();
+            break;
+        default:
+            // This should never happen
+            ERROR( "Unsupported filter ("<<m_double<<")" )
+            return false;
+    };
+
+    DEBUG( 10, "Filter: checking id="<<p->id()<<" param="<<m_double<<" operator="<<m_operator<<" value="<<value<<" compare to="<<m_double_value )
+
+    switch(m_operator) {
+        case EQUAL:            return (value==m_double_value);
+        case GREATER:          return (value> m_double_value);
+        case LESS:             return (value< m_double_value);
+        case GREATER_OR_EQUAL: return (value>=m_double_value);
+        case LESS_OR_EQUAL:    return (value<=m_double_value);
+        case NOT_EQUAL:        return (value!=m_double_value);
+    };
+
+    return false;
+}
+
 bool Filter::passed_bool_filter(const GenParticlePtr &p ) const {
 
     bool         result = false;
@@ -89,6 +125,7 @@ bool Filter::passed_bool_filter(const GenParticlePtr &p ) const {
             break;
         case IS_STABLE: result = (bool) (p->status() == 1); break;
         case IS_BEAM:   result = (bool) (p->status() == 4); break;
+        default:        result = (bool) (p->flags() & flag_mask(m_bool)); break;
     };
 
     if( m_bool_value == false ) result = !result;
@@ -96,6 +133,28 @@ bool Filter::passed_bool_filter(const GenParticlePtr &p ) const {
     return result;
 }
 
+unsigned int Filter::flag_mask(FilterBoolParam p) {
+
+    switch( p ) {
+        case HAS_END_VERTEX: return GenParticle::FLAG_HAS_END_VERTEX;
+        case IS_STABLE:      return GenParticle::FLAG_FINAL_STATE;
+        case IS_BEAM:        return GenParticle::FLAG_BEAM;
+        case IS_CHARGED:     return PdgProperties::CHARGED;
+        case IS_QUARK:       return PdgProperties::QUARK;
+        case IS_LEPTON:      return PdgProperties::LEPTON;
+        case IS_NEUTRINO:    return PdgProperties::NEUTRINO;
+        case IS_HADRON:      return PdgProperties::HADRON;
+        case IS_MESON:       return PdgProperties::MESON;
+        case IS_BARYON:      return PdgProperties::BARYON;
+        case IS_NUCLEUS:     return PdgProperties::NUCLEUS;
+        case HAS_STRANGE:    return PdgProperties::HAS_STRANGE;
+        case HAS_CHARM:      return PdgProperties::HAS_CHARM;
+        case HAS_BOTTOM:     return PdgProperties::HAS_BOTTOM;
+        case HAS_TOP:        return PdgProperties::HAS_TOP;
+        default:             return 0;
+    };
+}
+
 bool Filter::passed_attribute_filter(const GenParticlePtr &p ) const {
 
     bool ret = false;
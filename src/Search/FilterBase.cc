@@ -10,16 +10,40 @@
  */
 #include "HepMC/Search/FilterBase.h"
 #include "HepMC/Search/Filter.h"
+#include "HepMC/Errors.h"
 
 namespace HepMC {
 
 // Define operators for integer-type filters
-Filter FilterBase::operator==(int value) const { return Filter(m_int,EQUAL,           value); }
-Filter FilterBase::operator!=(int value) const { return Filter(m_int,NOT_EQUAL,       value); }
-Filter FilterBase::operator> (int value) const { return Filter(m_int,GREATER,         value); }
-Filter FilterBase::operator>=(int value) const { return Filter(m_int,GREATER_OR_EQUAL,value); }
-Filter FilterBase::operator< (int value) const { return Filter(m_int,LESS,            value); }
-Filter FilterBase::operator<=(int value) const { return Filter(m_int,LESS_OR_EQUAL,   value); }
+Filter FilterBase::operator==(int value) const { return make_filter(EQUAL,           value); }
+Filter FilterBase::operator!=(int value) const { return make_filter(NOT_EQUAL,       value); }
+Filter FilterBase::operator> (int value) const { return make_filter(GREATER,         value); }
+Filter FilterBase::operator>=(int value) const { return make_filter(GREATER_OR_EQUAL,value); }
+Filter FilterBase::operator< (int value) const { return make_filter(LESS,            value); }
+Filter FilterBase::operator<=(int value) const { return make_filter(LESS_OR_EQUAL,   value); }
+
+// Define operators for floating-point-type filters
+Filter FilterBase::operator==(double value) const { return make_filter(EQUAL,           value); }
+Filter FilterBase::operator!=(double value) const { return make_filter(NOT_EQUAL,       value); }
+Filter FilterBase::operator> (double value) const { return make_filter(GREATER,         value); }
+Filter FilterBase::operator>=(double value) const { return make_filter(GREATER_OR_EQUAL,value); }
+Filter FilterBase::operator< (double value) const { return make_filter(LESS,            value); }
+Filter FilterBase::operator<=(double value) const { return make_filter(LESS_OR_EQUAL,   value); }
+
+Filter FilterBase::make_filter(FilterOperator o, int value) const {
+
+    // Integer values can be used with floating-point filters, e.g. PT > 20
+    if( m_value_type == DOUBLE_PARAM ) return Filter(m_double,o,(double)value);
+
+    return Filter(m_int,o,value);
+}
+
+Filter FilterBase::make_filter(FilterOperator o, double value) const {
+
+    if( m_value_type != DOUBLE_PARAM ) throw Exception("FilterBase: floating-point value used with integer filter");
+
+    return Filter(m_double,o,value);
+}
 
 // Define initializators for boolean-type filters
 const Filter FilterBase::init_has_end_vertex()           { return Filter(HAS_END_VERTEX);           }
@@ -27,5 +51,17 @@ const Filter FilterBase::init_has_production_vertex()    { return Filter(HAS_PRO
 const Filter FilterBase::init_has_same_pdg_id_daughter() { return Filter(HAS_SAME_PDG_ID_DAUGHTER); }
 const Filter FilterBase::init_is_stable()                { return Filter(IS_STABLE);                }
 const Filter FilterBase::init_is_beam()                  { return Filter(IS_BEAM);                  }
+const Filter FilterBase::init_is_charged()               { return Filter(IS_CHARGED);               }
+const Filter FilterBase::init_is_quark()                 { return Filter(IS_QUARK);                 }
+const Filter FilterBase::init_is_lepton()                { return Filter(IS_LEPTON);                }
+const Filter FilterBase::init_is_neutrino()              { return Filter(IS_NEUTRINO);              }
+const Filter FilterBase::init_is_hadron()                { return Filter(IS_HADRON);                }
+const Filter FilterBase::init_is_meson()                 { return Filter(IS_MESON);                 }
+const Filter FilterBase::init_is_baryon()                { return Filter(IS_BARYON);                }
+const Filter FilterBase::init_is_nucleus()               { return Filter(IS_NUCLEUS);               }
+const Filter FilterBase::init_has_strange()              { return Filter(HAS_STRANGE);              }
+const Filter FilterBase::init_has_charm()                { return Filter(HAS_CHARM);                }
+const Filter FilterBase::init_has_bottom()               { return Filter(HAS_BOTTOM);               }
+const Filter FilterBase::init_has_top()                  { return Filter(HAS_TOP);                  }
 
 } // namespace HepMC
@@ -0,0 +1,191 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+/**
+ *  @file FindDecays.cc
+ *  @brief Implementation of \b class FindDecays
+ *
+ */
+#include "HepMC/Search/FindDecays.h"
+#include "HepMC/Search/FindParticles.h"
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenVertex.h"
+#include "HepMC/GenParticle.h"
+
+#include <algorithm>
+
+namespace HepMC {
+
+
+FindDecays::FindDecays(const GenEvent &evt, const DecayDescriptor &descriptor, int options):m_options(options) {
+
+    // Candidates are preselected using particle index of the event
+    FindParticles candidates( evt, FIND_ALL, descriptor.filter() );
+
+    FOREACH( const GenParticlePtr &p, candidates.results() ) {
+        if( is_copy(p) ) continue;
+
+        match( descriptor, p, m_results );
+    }
+}
+
+
+FindDecays::FindDecays(const GenParticlePtr &p, const DecayDescriptor &descriptor, int options):m_options(options) {
+    match( descriptor, p, m_results );
+}
+
+
+void FindDecays::match(const DecayDescriptor &d, const GenParticlePtr &p, vector< vector<GenParticlePtr> > &tuples) const {
+
+    if( !d.filter().passed_filter(*p) ) return;
+
+    // No requirements on decay products
+    if( d.daughters().empty() ) {
+        tuples.push_back( vector<GenParticlePtr>(1,p) );
+        return;
+    }
+
+    const GenVertexPtr v = last_copy(p)->end_vertex();
+    if( !v ) return;
+
+    vector<GenParticlePtr> products = v->particles_out();
+
+    // Fast rejection if number of decay products cannot match
+    if( !(m_options & ALLOW_INTERMEDIATE_RESONANCES) && products.size() < d.daughters().size() ) return;
+    if( !(m_options & ALLOW_PHOTON_RADIATION)        && products.size() > d.daughters().size() ) return;
+
+    vector< vector< vector<GenParticlePtr> > > assigned( d.daughters().size() );
+    vector<GenVertexPtr>                       expanded( 1, v );
+
+    match_products( d, products, 0, d.daughters().size(), assigned, expanded, p, tuples );
+}
+
+
+void FindDecays::match_products(const DecayDescriptor &d, vector<GenParticlePtr> &products, size_t i, size_t unassigned,
+                                vector< vector< vector<GenParticlePtr> > > &assigned, vector<GenVertexPtr> &expanded,
+                                const GenParticlePtr &mother, vector< vector<GenParticlePtr> > &tuples) const {
+
+    size_t remaining = products.size() - i;
+
+    if( remaining == 0 ) {
+        if( unassigned > 0 ) return;
+
+        vector<GenParticlePtr> tuple( 1, mother );
+        combine( assigned, 0, tuple, tuples );
+        return;
+    }
+
+    // Without intermediate resonances the list of products cannot grow
+    if( !(m_options & ALLOW_INTERMEDIATE_RESONANCES) && remaining < unassigned ) return;
+
+    // Without photon radiation no product can be left unassigned
+    if( !(m_options & ALLOW_PHOTON_RADIATION) && !(m_options & ALLOW_INTERMEDIATE_RESONANCES) && remaining != unassigned ) return;
+
+    // Copy, as the list can be reallocated when resonances are expanded
+    GenParticlePtr p = products[i];
+
+    // Assign particle to one of the daughters
+    for( size_t k=0; k<assigned.size(); ++k ) {
+        if( !assigned[k].empty() ) continue;
+
+        match( d.daughters()[k], p, assigned[k] );
+        if( assigned[k].empty() ) continue;
+
+        match_products( d, products, i+1, unassigned-1, assigned, expanded, mother, tuples );
+
+        assigned[k].clear();
+    }
+
+    // Ignore radiated photon
+    if( (m_options & ALLOW_PHOTON_RADIATION) && p->pid() == 22 ) {
+        match_products( d, products, i+1, unassigned, assigned, expanded, mother, tuples );
+    }
+
+    // Replace intermediate resonance with its decay products
+    if( (m_options & ALLOW_INTERMEDIATE_RESONANCES) && unassigned > 0 ) {
+        const GenVertexPtr v = last_copy(p)->end_vertex();
+
+        if( !v || v->particles_out().empty() ) return;
+
+        // Decay products of vertices with several incoming particles
+        // are already on the list
+        if( std::find( expanded.begin(), expanded.end(), v ) != expanded.end() ) {
+            match_products( d, products, i+1, unassigned, assigned, expanded, mother, tuples );
+            return;
+        }
+
+        size_t size = products.size();
+
+        expanded.push_back( v );
+        products.insert( products.end(), v->particles_out().begin(), v->particles_out().end() );
+
+        match_products( d, products, i+1, unassigned, assigned, expanded, mother, tuples );
+
+        products.resize( size );
+        expanded.pop_back();
+    }
+}
+
+
+void FindDecays::combine(const vector< vector< vector<GenParticlePtr> > > &assigned, size_t k,
+                         vector<GenParticlePtr> &tuple, vector< vector<GenParticlePtr> > &tuples) {
+
+    if( k == assigned.size() ) {
+        tuples.push_back( tuple );
+        return;
+    }
+
+    size_t size = tuple.size();
+
+    FOREACH( const vector<GenParticlePtr> &sub, assigned[k] ) {
+        tuple.insert( tuple.end(), sub.begin(), sub.end() );
+
+        combine( assigned, k+1, tuple, tuples );
+
+        tuple.resize( size );
+    }
+}
+
+
+GenParticlePtr FindDecays::last_copy(const GenParticlePtr &p) {
+
+    GenParticlePtr last = p;
+
+    while( true ) {
+        const GenVertexPtr v = last->end_vertex();
+        if( !v ) break;
+
+        GenParticlePtr copy;
+
+        FOREACH( const GenParticlePtr &p_out, v->particles_out() ) {
+            if( p_out->pid() == last->pid() ) {
+                copy = p_out;
+                break;
+            }
+        }
+
+        if( !copy ) break;
+
+        last = copy;
+    }
+
+    return last;
+}
+
+
+bool FindDecays::is_copy(const GenParticlePtr &p) {
+
+    const GenVertexPtr v = p->production_vertex();
+    if( !v ) return false;
+
+    FOREACH( const GenParticlePtr &p_in, v->particles_in() ) {
+        if( p_in->pid() == p->pid() ) return true;
+    }
+
+    return false;
+}
+
+} // namespace HepMC
@@ -11,99 +11,172 @@
 #include "HepMC/Search/FindParticles.h"
 #include "HepMC/Search/FilterList.h"
 #include "HepMC/Search/Filter.h"
+#include "HepMC/Search/CompiledFilter.h"
 
 #include "HepMC/GenEvent.h"
 #include "HepMC/GenVertex.h"
 #include "HepMC/GenParticle.h"
 
+#include <algorithm>
+
 namespace HepMC {
 
 
 FindParticles::FindParticles(const GenEvent &evt, FilterEvent filter_type, FilterList filter_list) {
+    collect( evt, filter_type, CompiledFilter(filter_list), m_results );
+}
+
+
+FindParticles::FindParticles(const GenParticlePtr &p, FilterParticle filter_type, FilterList filter_list) {
+    SearchBuffer buffer;
+    collect( *p, filter_type, CompiledFilter(filter_list), m_results, buffer );
+}
+
+
+FindParticles::FindParticles(const GenVertexPtr &v, FilterParticle filter_type, FilterList filter_list) {
+    SearchBuffer buffer;
+    collect( *v, filter_type, CompiledFilter(filter_list), m_results, buffer );
+}
+
+
+FindParticles::FindParticles(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter) {
+    collect( evt, filter_type, filter, m_results );
+}
+
+
+FindParticles::FindParticles(const GenParticlePtr &p, FilterParticle filter_type, const CompiledFilter &filter) {
+    SearchBuffer buffer;
+    collect( *p, filter_type, filter, m_results, buffer );
+}
+
+
+FindParticles::FindParticles(const GenVertexPtr &v, FilterParticle filter_type, const CompiledFilter &filter) {
+    SearchBuffer buffer;
+    collect( *v, filter_type, filter, m_results, buffer );
+}
+
+
+void FindParticles::narrow_down( FilterList filter_list ) {
+    narrow_down( CompiledFilter(filter_list) );
+}
+
+
+void FindParticles::narrow_down( const CompiledFilter &filter ) {
 
-    FOREACH( const GenParticlePtr &p, evt.particles() ) {
+    if( filter.accepts_all() ) return;
 
-        if( passed_all_filters(p,filter_list) ) {
-            if( filter_type == FIND_LAST ) m_results.clear();
+    vector<GenParticlePtr> results;
 
-            m_results.push_back( p );
+    filter.select( m_results, results );
 
-            if( filter_type == FIND_FIRST ) return;
+    m_results.swap( results );
+}
+
+
+bool FindParticles::visit(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter, Callback callback, void *data) {
+
+    if( filter.rejects_all() ) return true;
+
+    // Use particle index of the event if filters allow it.
+    // Lists of pid and -pid are merged on the fly keeping order of particle id
+    int                           value = 0;
+    const vector<GenParticlePtr> *l1    = &evt.particles();
+    const vector<GenParticlePtr> *l2    = NULL;
+
+    switch( filter.index_hint(value) ) {
+        case CompiledFilter::PDG_ID_INDEX:     l1 = &evt.particles_with_pid(value);    break;
+        case CompiledFilter::STATUS_INDEX:     l1 = &evt.particles_with_status(value); break;
+        case CompiledFilter::ABS_PDG_ID_INDEX:
+            if( value < 0 ) return true;
+
+            l1 = &evt.particles_with_pid(value);
+            if( value != 0 ) l2 = &evt.particles_with_pid(-value);
+            break;
+        case CompiledFilter::NO_INDEX:
+            break;
+    };
+
+    size_t n1 = l1->size();
+    size_t n2 = l2 ? l2->size() : 0;
+
+    if( filter_type == FIND_LAST ) {
+        size_t i1 = n1, i2 = n2;
+
+        while( i1 > 0 || i2 > 0 ) {
+            const GenParticlePtr &p = ( i2 == 0 || ( i1 > 0 && (*(*l1)[i1-1]).id() > (*(*l2)[i2-1]).id() ) ) ? (*l1)[--i1] : (*l2)[--i2];
+
+            if( filter.passed_filter(*p) ) return callback( p, data );
         }
+
+        return true;
+    }
+
+    size_t i1 = 0, i2 = 0;
+
+    while( i1 < n1 || i2 < n2 ) {
+        const GenParticlePtr &p = ( i2 == n2 || ( i1 < n1 && (*(*l1)[i1]).id() < (*(*l2)[i2]).id() ) ) ? (*l1)[i1++] : (*l2)[i2++];
+
+        if( !filter.passed_filter(*p) ) continue;
+
+        if( !callback( p, data ) )     return false;
+        if( filter_type == FIND_FIRST ) return true;
     }
+
+    return true;
 }
 
 
-FindParticles::FindParticles(const GenParticlePtr &p, FilterParticle filter_type, FilterList filter_list) {
+bool FindParticles::visit(const GenParticle &p, Relationship filter_type, const CompiledFilter &filter, Callback callback, void *data, SearchBuffer &buffer) {
+
+    if( filter.rejects_all() ) return true;
+
+    const GenVertex *v = NULL;
 
     switch(filter_type) {
         case FIND_ALL_ANCESTORS:
-            if( !p->production_vertex() ) break;
+            v = p.production_vertex_ptr();
+            if( !v ) break;
 
-            recursive_check_ancestors( p->production_vertex(), filter_list );
-            break;
+            return visit_tree( *v, true, filter, callback, data, buffer );
         case FIND_ALL_DESCENDANTS:
-            if( !p->end_vertex() ) break;
+            v = p.end_vertex_ptr();
+            if( !v ) break;
 
-            recursive_check_descendants( p->end_vertex(), filter_list );
-            break;
+            return visit_tree( *v, false, filter, callback, data, buffer );
         case FIND_MOTHERS:
-            if( !p->production_vertex() ) break;
+            v = p.production_vertex_ptr();
+            if( !v ) break;
 
-            FOREACH( const GenParticlePtr &p_in, p->production_vertex()->particles_in() ) {
-
-                if( passed_all_filters(p_in,filter_list) ) {
-                    m_results.push_back( p_in );
-                }
-            }
-            break;
+            return visit_list( v->particles_in(), filter, callback, data );
         case FIND_DAUGHTERS:
-            if( !p->end_vertex() ) break;
-
-            FOREACH( const GenParticlePtr &p_out, p->end_vertex()->particles_out() ) {
+            v = p.end_vertex_ptr();
+            if( !v ) break;
 
-                if( passed_all_filters(p_out,filter_list) ) {
-                    m_results.push_back( p_out );
-                }
-            }
-            break;
+            return visit_list( v->particles_out(), filter, callback, data );
         case FIND_PRODUCTION_SIBLINGS:
-            if( !p->end_vertex() ) break;
-
-            FOREACH( const GenParticlePtr &p_in, p->end_vertex()->particles_in() ) {
+            v = p.end_vertex_ptr();
+            if( !v ) break;
 
-                if( passed_all_filters(p_in,filter_list) ) {
-                    m_results.push_back( p_in );
-                }
-            }
-            break;
+            return visit_list( v->particles_in(), filter, callback, data );
     };
+
+    return true;
 }
 
 
-FindParticles::FindParticles(const GenVertexPtr &v, FilterParticle filter_type, FilterList filter_list) {
+bool FindParticles::visit(const GenVertex &v, Relationship filter_type, const CompiledFilter &filter, Callback callback, void *data, SearchBuffer &buffer) {
 
     switch(filter_type) {
         case FIND_ALL_ANCESTORS:
-            recursive_check_ancestors( v, filter_list );
-            break;
+            if( filter.rejects_all() ) return true;
+            return visit_tree( v, true, filter, callback, data, buffer );
         case FIND_ALL_DESCENDANTS:
-            recursive_check_descendants( v, filter_list );
-            break;
+            if( filter.rejects_all() ) return true;
+            return visit_tree( v, false, filter, callback, data, buffer );
         case FIND_MOTHERS:
-            FOREACH( const GenParticlePtr &p_in, v->particles_in() ) {
-                if ( passed_all_filters(p_in,filter_list) ) {
-                    m_results.push_back( p_in );
-                }
-            }
-            break;
+            return visit_list( v.particles_in(), filter, callback, data );
         case FIND_DAUGHTERS:
-            FOREACH( const GenParticlePtr &p_out, v->particles_out() ) {
-                if ( passed_all_filters(p_out,filter_list) ) {
-                    m_results.push_back( p_out );
-                }
-            }
-            break;
+            return visit_list( v.particles_out(), filter, callback, data );
         case FIND_PRODUCTION_SIBLINGS:
         default:
             throw Exception("Invalid filter type provided for FindParticles(GenVertexPtr)");
@@ -111,74 +184,121 @@ FindParticles::FindParticles(const GenVertexPtr &v, FilterParticle filter_type,
 }
 
 
-void FindParticles::narrow_down( FilterList filter_list ) {
+void FindParticles::collect(const GenEvent &evt, FilterEvent filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results) {
+
+    if( filter.rejects_all() ) return;
+
+    // Batch evaluation whenever the candidates form a single list
+    if( filter_type == FIND_ALL ) {
+        int value = 0;
+
+        switch( filter.index_hint(value) ) {
+            case CompiledFilter::NO_INDEX:     filter.select( evt.particles(),                   results ); return;
+            case CompiledFilter::PDG_ID_INDEX: filter.select( evt.particles_with_pid(value),    results ); return;
+            case CompiledFilter::STATUS_INDEX: filter.select( evt.particles_with_status(value), results ); return;
+            case CompiledFilter::ABS_PDG_ID_INDEX:
+                break;
+        };
+    }
+
+    visit( evt, filter_type, filter, &append, &results );
+}
+
 
-    int first_null = -1;
+void FindParticles::collect(const GenParticle &p, Relationship filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results, SearchBuffer &buffer) {
+    visit( p, filter_type, filter, &append, &results, buffer );
+}
+
+
+void FindParticles::collect(const GenVertex &v, Relationship filter_type, const CompiledFilter &filter, vector<GenParticlePtr> &results, SearchBuffer &buffer) {
+    visit( v, filter_type, filter, &append, &results, buffer );
+}
+
+
+bool FindParticles::visit_tree(const GenVertex &v, bool ancestors, const CompiledFilter &filter, Callback callback, void *data, SearchBuffer &buffer) {
 
-    // cost-efficient removing of particles that didn't pass filters
-    for(unsigned int i=0; i<m_results.size(); ++i) {
+    buffer.begin( v.parent_event() );
+    buffer.mark( v );
+    buffer.m_stack.push_back( std::make_pair( &v, 0u ) );
 
-        if( !passed_all_filters(m_results[i],filter_list) ) {
+    // Iterative equivalent of recursive depth-first search: each particle
+    // is checked before the vertex it leads to
+    while( !buffer.m_stack.empty() ) {
+        std::pair<const GenVertex*, unsigned int> &top = buffer.m_stack.back();
 
-            if( first_null < 0 ) first_null = i;
+        const vector<GenParticlePtr> &particles = ancestors ? top.first->particles_in() : top.first->particles_out();
+
+        if( top.second == particles.size() ) {
+            buffer.m_stack.pop_back();
+            continue;
         }
-        else {
-            if( first_null >= 0 ) {
-                m_results[first_null] = m_results[i];
-                ++first_null;
-            }
+
+        const GenParticlePtr &p = particles[top.second++];
+
+        if( filter.passed_filter(*p) && !callback( p, data ) ) {
+            buffer.m_stack.clear();
+            return false;
         }
+
+        const GenVertex *next = ancestors ? (*p).production_vertex_ptr() : (*p).end_vertex_ptr();
+
+        if( next && buffer.mark(*next) ) buffer.m_stack.push_back( std::make_pair( next, 0u ) );
     }
 
-    if( first_null >= 0 ) m_results.resize( first_null );
+    return true;
 }
 
-bool FindParticles::passed_all_filters(const GenParticlePtr &p, FilterList &filter_list) {
-    if( filter_list.filters().size() == 0 ) return true;
 
-    FOREACH( const Filter &f, filter_list.filters() ) {
-        if( f.passed_filter(p) == false ) return false;
+bool FindParticles::visit_list(const vector<GenParticlePtr> &particles, const CompiledFilter &filter, Callback callback, void *data) {
+
+    FOREACH( const GenParticlePtr &p, particles ) {
+        if( filter.passed_filter(*p) && !callback( p, data ) ) return false;
     }
 
-    DEBUG( 10, "Filter: passed" )
     return true;
 }
 
-void FindParticles::recursive_check_ancestors(const GenVertexPtr &v, FilterList &filter_list) {
 
-    FOREACH( const GenVertexPtr &v_list, m_checked_vertices ) {
-        if( v_list->id() == v->id() ) return;
-    }
+bool FindParticles::append(const GenParticlePtr &p, void *data) {
+    static_cast< vector<GenParticlePtr>* >(data)->push_back( p );
+    return true;
+}
 
-    m_checked_vertices.push_back(v);
 
-    FOREACH( const GenParticlePtr &p_in, v->particles_in() ) {
+void SearchBuffer::begin(const GenEvent *evt) {
 
-        if( passed_all_filters(p_in,filter_list) ) {
-            m_results.push_back(p_in);
-        }
+    m_event = evt;
+    m_visited.clear();
+    m_stack.clear();
 
-        if( !p_in->production_vertex() ) continue;
-        recursive_check_ancestors( p_in->production_vertex(), filter_list );
+    // Marks of previous searches become invalid
+    if( ++m_epoch == 0 ) {
+        std::fill( m_marks.begin(), m_marks.end(), 0 );
+        m_epoch = 1;
     }
+
+    if( evt && m_marks.size() < evt->vertices().size() ) m_marks.resize( evt->vertices().size(), 0 );
 }
 
-void FindParticles::recursive_check_descendants(const GenVertexPtr &v, FilterList &filter_list) {
 
-    FOREACH( const GenVertexPtr &v_list, m_checked_vertices ) {
-        if( v_list->id() == v->id() ) return;
-    }
+bool SearchBuffer::mark(const GenVertex &v) {
 
-    m_checked_vertices.push_back(v);
+    if( m_event && v.parent_event() == m_event && v.id() < 0 ) {
+        size_t i = -v.id() - 1;
 
-    FOREACH( const GenParticlePtr &p_out, v->particles_out() ) {
-        if( passed_all_filters(p_out,filter_list) ) {
-            m_results.push_back(p_out);
-        }
+        if( i >= m_marks.size() ) m_marks.resize( i+1, 0 );
+        if( m_marks[i] == m_epoch ) return false;
+
+        m_marks[i] = m_epoch;
+        return true;
+    }
 
-        if( !p_out->end_vertex() ) continue;
-        recursive_check_descendants( p_out->end_vertex(), filter_list );
+    FOREACH( const GenVertex *visited, m_visited ) {
+        if( visited == &v ) return false;
     }
+
+    m_visited.push_back( &v );
+    return true;
 }
 
 } // namespace HepMC
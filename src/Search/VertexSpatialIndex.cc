@@ -0,0 +1,239 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014 The HepMC collaboration (see AUTHORS for details)
+//
+/**
+ *  @file VertexSpatialIndex.cc
+ *  @brief Implementation of \b class VertexSpatialIndex
+ *
+ */
+#include "HepMC/Search/VertexSpatialIndex.h"
+
+#include "HepMC/GenEvent.h"
+#include "HepMC/GenVertex.h"
+#include "HepMC/GenParticle.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace HepMC {
+
+namespace {
+
+/** @brief Resolve vertex position as GenVertex::position() does, caching results by vertex id */
+const FourVector& resolved_position(const GenEvent &evt, const GenVertex &v, vector<const FourVector*> &cache) {
+
+    if( v.has_set_position() ) return v.data().position;
+
+    // Vertices outside of the vertex list, e.g. the root vertex of the event
+    if( v.parent_event() != &evt || v.id() >= 0 ) return v.position();
+
+    size_t i = -v.id() - 1;
+    if( cache[i] ) return *cache[i];
+
+    const FourVector *pos = &evt.event_pos();
+
+    FOREACH( const GenParticlePtr &p, v.particles_in() ) {
+        const GenVertexPtr pv = p->production_vertex();
+        if( !pv ) continue;
+
+        pos = &resolved_position( evt, *pv, cache );
+        break;
+    }
+
+    cache[i] = pos;
+    return *pos;
+}
+
+} // anonymous namespace
+
+
+VertexSpatialIndex::VertexSpatialIndex(const GenEvent &evt) {
+    build(evt);
+}
+
+
+void VertexSpatialIndex::build(const GenEvent &evt) {
+
+    const vector<GenVertexPtr> &vertices = evt.vertices();
+
+    vector<const FourVector*> cache( vertices.size(), (const FourVector*)NULL );
+
+    m_nodes.resize( vertices.size() );
+
+    for(size_t i=0; i<vertices.size(); ++i) {
+        const FourVector &pos = resolved_position( evt, *vertices[i], cache );
+
+        m_nodes[i].pos[0] = pos.x();
+        m_nodes[i].pos[1] = pos.y();
+        m_nodes[i].pos[2] = pos.z();
+        m_nodes[i].vertex = vertices[i];
+    }
+
+    build_tree( 0, m_nodes.size(), 0 );
+}
+
+
+void VertexSpatialIndex::build_tree(size_t lo, size_t hi, int depth) {
+
+    if( hi - lo < 2 ) return;
+
+    size_t mid = lo + (hi-lo)/2;
+
+    std::nth_element( m_nodes.begin()+lo, m_nodes.begin()+mid, m_nodes.begin()+hi, AxisLess(depth%3) );
+
+    build_tree( lo,    mid, depth+1 );
+    build_tree( mid+1, hi,  depth+1 );
+}
+
+
+vector<GenVertexPtr> VertexSpatialIndex::within_radius(const FourVector &point, double radius) const {
+
+    vector<GenVertexPtr> results;
+    if( m_nodes.empty() || !(radius >= 0.) ) return results;
+
+    const double p  [3] = { point.x(),        point.y(),        point.z()        };
+    const double min[3] = { point.x()-radius, point.y()-radius, point.z()-radius };
+    const double max[3] = { point.x()+radius, point.y()+radius, point.z()+radius };
+
+    vector<const Node*> candidates;
+    find_in_box( 0, m_nodes.size(), 0, min, max, candidates );
+
+    double radius2 = radius*radius;
+
+    FOREACH( const Node *n, candidates ) {
+        if( distance2(*n,p) <= radius2 ) results.push_back( n->vertex );
+    }
+
+    return results;
+}
+
+
+vector<GenVertexPtr> VertexSpatialIndex::in_box(const FourVector &min, const FourVector &max) const {
+
+    vector<GenVertexPtr> results;
+    if( m_nodes.empty() ) return results;
+
+    const double bmin[3] = { min.x(), min.y(), min.z() };
+    const double bmax[3] = { max.x(), max.y(), max.z() };
+
+    vector<const Node*> candidates;
+    find_in_box( 0, m_nodes.size(), 0, bmin, bmax, candidates );
+
+    results.reserve( candidates.size() );
+
+    FOREACH( const Node *n, candidates ) {
+        results.push_back( n->vertex );
+    }
+
+    return results;
+}
+
+
+vector<GenVertexPtr> VertexSpatialIndex::in_cylinder(double radius, double z_min, double z_max) const {
+
+    vector<GenVertexPtr> results;
+    if( m_nodes.empty() || !(radius >= 0.) ) return results;
+
+    const double min[3] = { -radius, -radius, z_min };
+    const double max[3] = {  radius,  radius, z_max };
+
+    vector<const Node*> candidates;
+    find_in_box( 0, m_nodes.size(), 0, min, max, candidates );
+
+    double radius2 = radius*radius;
+
+    FOREACH( const Node *n, candidates ) {
+        if( n->pos[0]*n->pos[0] + n->pos[1]*n->pos[1] <= radius2 ) results.push_back( n->vertex );
+    }
+
+    return results;
+}
+
+
+GenVertexPtr VertexSpatialIndex::nearest(const FourVector &point, double *distance) const {
+
+    if( m_nodes.empty() ) {
+        if( distance ) *distance = HUGE_VAL;
+        return GenVertexPtr();
+    }
+
+    const double p[3] = { point.x(), point.y(), point.z() };
+
+    const Node *best           = NULL;
+    double      best_distance2 = HUGE_VAL;
+
+    find_nearest( 0, m_nodes.size(), 0, p, best, best_distance2 );
+
+    if( distance ) *distance = std::sqrt(best_distance2);
+
+    // No finite distance, e.g. for positions that are not finite
+    if( !best ) return GenVertexPtr();
+
+    return best->vertex;
+}
+
+
+void VertexSpatialIndex::find_in_box(size_t lo, size_t hi, int depth, const double *min, const double *max, vector<const Node*> &results) const {
+
+    while( lo < hi ) {
+        size_t      mid  = lo + (hi-lo)/2;
+        int         axis = depth%3;
+        const Node &n    = m_nodes[mid];
+
+        if( n.pos[0] >= min[0] && n.pos[0] <= max[0] &&
+            n.pos[1] >= min[1] && n.pos[1] <= max[1] &&
+            n.pos[2] >= min[2] && n.pos[2] <= max[2] ) results.push_back( &n );
+
+        bool left  = min[axis] <= n.pos[axis];
+        bool right = max[axis] >= n.pos[axis];
+
+        // Recurse only when both subtrees overlap the box
+        if( left && right ) find_in_box( lo, mid, depth+1, min, max, results );
+
+        if( right ) lo = mid+1;
+        else        hi = mid;
+
+        ++depth;
+    }
+}
+
+
+void VertexSpatialIndex::find_nearest(size_t lo, size_t hi, int depth, const double *point, const Node *&best, double &best_distance2) const {
+
+    if( lo >= hi ) return;
+
+    size_t      mid  = lo + (hi-lo)/2;
+    int         axis = depth%3;
+    const Node &n    = m_nodes[mid];
+
+    double d2 = distance2(n,point);
+
+    if( d2 < best_distance2 ) {
+        best           = &n;
+        best_distance2 = d2;
+    }
+
+    double diff = point[axis] - n.pos[axis];
+
+    // Search the side containing the point first
+    if( diff < 0 ) find_nearest( lo,    mid, depth+1, point, best, best_distance2 );
+    else           find_nearest( mid+1, hi,  depth+1, point, best, best_distance2 );
+
+    if( diff*diff >= best_distance2 ) return;
+
+    if( diff < 0 ) find_nearest( mid+1, hi,  depth+1, point, best, best_distance2 );
+    else           find_nearest( lo,    mid, depth+1, point, best, best_distance2 );
+}
+
+
+double VertexSpatialIndex::distance2(const Node &n, const double *point) {
+    double dx = n.pos[0] - point[0];
+    double dy = n.pos[1] - point[1];
+    double dz = n.pos[2] - point[2];
+
+    return dx*dx + dy*dy + dz*dz;
+}
+
+} // namespace HepMC
@@ -0,0 +1,172 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file Subtree.cc
+/// @brief Implementation of \b class Subtree
+///
+#include "HepMC/Subtree.h"
+
+#include "HepMC/GenParticle.h"
+#include "HepMC/GenVertex.h"
+
+namespace HepMC {
+
+
+Subtree::Subtree(const GenParticlePtr &p) {
+    extract(p);
+}
+
+
+bool Subtree::extract(const GenParticlePtr &p) {
+
+    clear();
+
+    if( !p || !p->parent_event() ) {
+        WARNING( "Subtree::extract: particle does not belong to an event" )
+        return false;
+    }
+
+    const GenEvent &evt = *p->parent_event();
+
+    m_origin = p;
+
+    m_event.set_event_number( evt.event_number() );
+    m_event.set_units( evt.momentum_unit(), evt.length_unit() );
+    m_event.set_run_info( evt.run_info() );
+
+    GenParticlePtr head = make_shared<GenParticle>( p->data() );
+    m_event.add_particle(head);
+    m_particles[ &(*head) ] = p;
+
+    GenVertexPtr end = p->end_vertex();
+
+    if( end && end->parent_event() == &evt && end->id() < 0 ) {
+
+        PendingVertex &first = m_pending[ &(*end) ];
+        first.copy      = make_shared<GenVertex>( end->data() );
+        first.remaining = end->particles_in().size() - 1;
+        first.copy->add_particle_in(head);
+
+        if( first.remaining == 0 ) m_ready.push_back(end);
+
+        // Copy vertices once all their incoming particles are copied,
+        // so that the standalone event is in topological order
+        for(unsigned int i=0; i<m_ready.size(); ++i) {
+            GenVertexPtr        v  = m_ready[i];
+            GenVertexPtr        vc = m_pending[ &(*v) ].copy;
+
+            FOREACH( const GenParticlePtr &q, v->particles_out() ) {
+                GenParticlePtr qc = make_shared<GenParticle>( q->data() );
+                vc->add_particle_out(qc);
+                m_particles[ &(*qc) ] = q;
+
+                GenVertexPtr w = q->end_vertex();
+                if( !w || w->parent_event() != &evt || w->id() >= 0 ) continue;
+
+                std::unordered_map<const GenVertex*, PendingVertex>::iterator it = m_pending.find( &(*w) );
+
+                if( it == m_pending.end() ) {
+                    PendingVertex pending;
+                    pending.copy      = make_shared<GenVertex>( w->data() );
+                    pending.remaining = w->particles_in().size();
+
+                    it = m_pending.insert( std::make_pair( &(*w), pending ) ).first;
+                }
+
+                it->second.copy->add_particle_in(qc);
+
+                if( --it->second.remaining == 0 ) m_ready.push_back(w);
+            }
+
+            m_event.add_vertex(vc);
+            m_vertices[ &(*vc) ] = v;
+        }
+
+        // Vertices still waiting for incoming particles have other ancestors
+        if( m_ready.size() != m_pending.size() ) {
+            WARNING( "Subtree::extract: descendants of particle "<<p->id()<<" have other ancestors" )
+            clear();
+            return false;
+        }
+    }
+
+    // Attributes are shared with the original event
+    typedef std::map< string, std::map<int, shared_ptr<Attribute> > >::value_type att_key_t;
+
+    FOREACH( const att_key_t &vt1, evt.attributes() ) {
+        FOREACH( const GenParticlePtr &pc, m_event.particles() ) {
+            std::map<int, shared_ptr<Attribute> >::const_iterator it = vt1.second.find( original(pc)->id() );
+            if( it != vt1.second.end() ) m_event.add_attribute( vt1.first, it->second, pc->id() );
+        }
+
+        FOREACH( const GenVertexPtr &vc, m_event.vertices() ) {
+            std::map<int, shared_ptr<Attribute> >::const_iterator it = vt1.second.find( original(vc)->id() );
+            if( it != vt1.second.end() ) m_event.add_attribute( vt1.first, it->second, vc->id() );
+        }
+    }
+
+    if( evt.has_barcodes() ) {
+        FOREACH( const GenParticlePtr &pc, m_event.particles() ) m_event.set_barcode( pc, evt.barcode( original(pc) ) );
+        FOREACH( const GenVertexPtr   &vc, m_event.vertices()  ) m_event.set_barcode( vc, evt.barcode( original(vc) ) );
+    }
+
+    m_pending.clear();
+    m_ready.clear();
+
+    return true;
+}
+
+
+bool Subtree::splice() {
+
+    if( !m_origin || !m_origin->parent_event() || m_event.particles().empty() ) {
+        WARNING( "Subtree::splice: nothing to splice" )
+        return false;
+    }
+
+    bool result = m_origin->parent_event()->replace_subtree( m_origin, m_event );
+
+    if( result ) clear();
+
+    return result;
+}
+
+
+void Subtree::clear() {
+    m_origin = GenParticlePtr();
+    m_event.clear();
+    m_particles.clear();
+    m_vertices.clear();
+    m_pending.clear();
+    m_ready.clear();
+}
+
+
+GenParticlePtr Subtree::head() const {
+    if( m_event.particles().empty() ) return GenParticlePtr();
+
+    return m_event.particles()[0];
+}
+
+
+GenParticlePtr Subtree::original(const GenParticlePtr &p) const {
+    if( !p ) return GenParticlePtr();
+
+    std::unordered_map<const GenParticle*, GenParticlePtr>::const_iterator it = m_particles.find( &(*p) );
+
+    return it != m_particles.end() ? it->second : GenParticlePtr();
+}
+
+
+GenVertexPtr Subtree::original(const GenVertexPtr &v) const {
+    if( !v ) return GenVertexPtr();
+
+    std::unordered_map<const GenVertex*, GenVertexPtr>::const_iterator it = m_vertices.find( &(*v) );
+
+    return it != m_vertices.end() ? it->second : GenVertexPtr();
+}
+
+} // namespace HepMC
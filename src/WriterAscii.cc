@@ -14,18 +14,28 @@
 #include "HepMC/GenParticle.h"
 #include "HepMC/GenVertex.h"
 #include "HepMC/Units.h"
+#include "HepMC/Formatter.h"
 #include <cstring>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace HepMC {
 
 
-WriterAscii::WriterAscii(const std::string &filename, shared_ptr<GenRunInfo> run)
-  : m_file(filename),
+WriterAscii::WriterAscii(const std::string &filename, shared_ptr<GenRunInfo> run, const std::string &codec)
+  : m_file(filename,codec),
     m_stream(&m_file),
     m_precision(16),
     m_buffer(NULL),
     m_cursor(NULL),
-    m_buffer_size( 256*1024 )
+    m_buffer_size( 256*1024 ),
+    m_start_offset( -1 ),
+    m_bytes_written( 0 ),
+    m_async( NULL ),
+    m_reorder_policy( GenEvent::KEEP_ORDER )
 {
     set_run_info(run);
     if ( !m_file.is_open() ) {
@@ -33,6 +43,7 @@ WriterAscii::WriterAscii(const std::string &filename, shared_ptr<GenRunInfo> run
     } else {
         m_file << "HepMC::Version " << HepMC::version() << std::endl;
         m_file << "HepMC::IO_GenEvent-START_EVENT_LISTING" << std::endl;
+        m_start_offset = m_file.tellp();
 	    if ( run_info() ) write_run_info();
     }
 }
@@ -44,7 +55,11 @@ WriterAscii::WriterAscii(std::ostream &stream, shared_ptr<GenRunInfo> run)
     m_precision(16),
     m_buffer(NULL),
     m_cursor(NULL),
-    m_buffer_size( 256*1024 )
+    m_buffer_size( 256*1024 ),
+    m_start_offset( -1 ),
+    m_bytes_written( 0 ),
+    m_async( NULL ),
+    m_reorder_policy( GenEvent::KEEP_ORDER )
 {
     set_run_info(run);
     // if ( !m_file.is_open() ) {
@@ -54,6 +69,7 @@ WriterAscii::WriterAscii(std::ostream &stream, shared_ptr<GenRunInfo> run)
         // m_file << "HepMC::IO_GenEvent-START_EVENT_LISTING" << std::endl;
     (*m_stream) << "HepMC::Version " << HepMC::version() << std::endl;
     (*m_stream) << "HepMC::IO_GenEvent-START_EVENT_LISTING" << std::endl;
+    m_start_offset = m_stream->tellp();
 	if ( run_info() ) write_run_info();
     // }
 }
@@ -89,20 +105,24 @@ void WriterAscii::write_event(const GenEvent &evt) {
     }
 
     // Write event info
+    if ( !m_index_filename.empty() ) {
+        m_index.add( m_start_offset + m_bytes_written + (m_cursor - m_buffer),
+                     evt.event_number(), evt.particles().size(), evt.vertices().size() );
+    }
+
     m_cursor += sprintf(m_cursor, "E %d %lu %lu", evt.event_number(), evt.vertices().size(), evt.particles().size());
     flush();
 
     // Write event position if not zero
     const FourVector &pos = evt.event_pos();
     if ( !pos.is_zero() ) {
-        m_cursor += sprintf(m_cursor," @ %.*e",m_precision,pos.x());
-        flush();
-        m_cursor += sprintf(m_cursor," %.*e",  m_precision,pos.y());
-        flush();
-        m_cursor += sprintf(m_cursor," %.*e",  m_precision,pos.z());
-        flush();
-        m_cursor += sprintf(m_cursor," %.*e",  m_precision,pos.t());
-        flush();
+        const int digits = Formatter::precision_digits(m_precision);
+
+        m_cursor += sprintf(m_cursor," @");
+        write_double(pos.x(),digits);
+        write_double(pos.y(),digits);
+        write_double(pos.z(),digits);
+        write_double(pos.t(),digits);
     }
 
     m_cursor += sprintf(m_cursor,"\n");
@@ -114,13 +134,28 @@ void WriterAscii::write_event(const GenEvent &evt) {
 
     // Write weight values if present
     if ( evt.weights().size() ) {
+      const int digits = Formatter::precision_digits(std::min(3*m_precision,22));
+
       m_cursor += sprintf(m_cursor, "W");
       FOREACH (double w, evt.weights())
-        m_cursor += sprintf(m_cursor, " %.*e",std::min(3*m_precision,22), w);
+        write_double(w,digits);
       m_cursor += sprintf(m_cursor, "\n");
       flush();
     }
 
+    // Order of particles and vertices in the output
+    const bool reorder = ( m_reorder_policy != GenEvent::KEEP_ORDER );
+
+    if ( reorder ) {
+        evt.reorder_ids(m_reorder_policy, m_particle_order, m_vertex_order);
+
+        m_particle_id.resize(m_particle_order.size());
+        m_vertex_id.resize(m_vertex_order.size());
+
+        for ( unsigned int i=0; i<m_particle_order.size(); ++i ) m_particle_id[ m_particle_order[i]-1 ] =  (int)i+1;
+        for ( unsigned int i=0; i<m_vertex_order.size();   ++i ) m_vertex_id  [ -m_vertex_order[i]-1 ] = -(int)i-1;
+    }
+
     // Write attributes
     typedef map< string, map<int, shared_ptr<Attribute> > >::value_type value_type1;
     typedef map<int, shared_ptr<Attribute> >::value_type                value_type2;
@@ -136,7 +171,7 @@ void WriterAscii::write_event(const GenEvent &evt) {
             }
             else {
                 m_cursor +=
-                  sprintf(m_cursor, "A %i %s ",vt2.first,vt1.first.c_str());
+                  sprintf(m_cursor, "A %i %s ",output_id(vt2.first),vt1.first.c_str());
                 flush();
                 write_string(escape(st));
                 m_cursor += sprintf(m_cursor, "\n");
@@ -149,7 +184,8 @@ void WriterAscii::write_event(const GenEvent &evt) {
     int lowest_vertex_id   = 0;
 
     // Print particles
-    FOREACH ( const GenParticlePtr &p, evt.particles() ) {
+    for ( unsigned int i=0; i<evt.particles().size(); ++i ) {
+        const GenParticlePtr &p = evt.particles()[ reorder ? m_particle_order[i]-1 : i ];
 
         // Check to see if we need to write a vertex first
         const GenVertexPtr &v = p->production_vertex();
@@ -158,22 +194,23 @@ void WriterAscii::write_event(const GenEvent &evt) {
         if (v) {
 
             // Check if we need this vertex at all
-            if ( v->particles_in().size() > 1 || !v->data().is_zero() ) production_vertex = v->id();
-            else if ( v->particles_in().size() == 1 )                   production_vertex = v->particles_in()[0]->id();
+            if ( v->particles_in().size() > 1 || !v->data().is_zero() ) production_vertex = output_id(v->id());
+            else if ( v->particles_in().size() == 1 )                   production_vertex = output_id(v->particles_in()[0]->id());
 
             if (production_vertex < lowest_vertex_id) {
                 write_vertex(v);
             }
 
             ++vertices_processed;
-            lowest_vertex_id = v->id();
+            lowest_vertex_id = output_id(v->id());
         }
 
         write_particle( p, production_vertex );
     }
 
-    // Flush rest of the buffer to file
-    forced_flush();
+    // Flush rest of the buffer to file, in asynchronous mode
+    // buffers are passed to the background thread when full
+    if ( !m_async ) forced_flush();
 }
 
 
@@ -211,7 +248,7 @@ string WriterAscii::escape(const string& s) {
 
 void WriterAscii::write_vertex(const GenVertexPtr &v) {
 
-    m_cursor += sprintf( m_cursor, "V %i %i [",v->id(),v->status() );
+    m_cursor += sprintf( m_cursor, "V %i %i [",output_id(v->id()),v->status() );
     flush();
 
     bool printed_first = false;
@@ -219,23 +256,24 @@ void WriterAscii::write_vertex(const GenVertexPtr &v) {
     FOREACH( const GenParticlePtr &p, v->particles_in() ) {
 
         if ( !printed_first ) {
-            m_cursor  += sprintf(m_cursor,"%i", p->id());
+            m_cursor  += sprintf(m_cursor,"%i", output_id(p->id()));
             printed_first = true;
         }
-        else m_cursor += sprintf(m_cursor,",%i",p->id());
+        else m_cursor += sprintf(m_cursor,",%i",output_id(p->id()));
 
         flush();
     }
 
     const FourVector &pos = v->position();
     if ( !pos.is_zero() ) {
-        m_cursor += sprintf(m_cursor,"] @ %.*e",m_precision,pos.x());
-        flush();
-        m_cursor += sprintf(m_cursor," %.*e",   m_precision,pos.y());
-        flush();
-        m_cursor += sprintf(m_cursor," %.*e",   m_precision,pos.z());
-        flush();
-        m_cursor += sprintf(m_cursor," %.*e\n", m_precision,pos.t());
+        const int digits = Formatter::precision_digits(m_precision);
+
+        m_cursor += sprintf(m_cursor,"] @");
+        write_double(pos.x(),digits);
+        write_double(pos.y(),digits);
+        write_double(pos.z(),digits);
+        write_double(pos.t(),digits);
+        m_cursor += sprintf(m_cursor,"\n");
         flush();
     }
     else {
@@ -251,16 +289,33 @@ inline void WriterAscii::flush() {
     // we will not allow precision larger than 24 anyway
     unsigned long length = m_cursor - m_buffer;
     if ( m_buffer_size - length < 32 ) {
+        if ( m_async ) {
+            queue_buffer();
+            return;
+        }
         // m_file.write( m_buffer, length );
         m_stream->write( m_buffer, length );
+        m_bytes_written += length;
         m_cursor = m_buffer;
     }
 }
 
 
+inline void WriterAscii::write_double(double value, int digits) {
+    *m_cursor++ = ' ';
+    m_cursor += Formatter::format_double(m_cursor, value, digits);
+    flush();
+}
+
+
 inline void WriterAscii::forced_flush() {
+    if ( m_async ) {
+        queue_buffer();
+        return;
+    }
     // m_file.write( m_buffer, m_cursor-m_buffer );
     m_stream->write( m_buffer, m_cursor - m_buffer );
+    m_bytes_written += m_cursor - m_buffer;
     m_cursor = m_buffer;
 }
 
@@ -311,23 +366,21 @@ void WriterAscii::write_run_info() {
 
 void WriterAscii::write_particle(const GenParticlePtr &p, int second_field) {
 
-    m_cursor += sprintf(m_cursor,"P %i",p->id());
+    m_cursor += sprintf(m_cursor,"P %i",output_id(p->id()));
     flush();
 
     m_cursor += sprintf(m_cursor," %i",   second_field);
     flush();
     m_cursor += sprintf(m_cursor," %i",   p->pid() );
     flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().px() );
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().py());
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().pz() );
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().e() );
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->generated_mass() );
-    flush();
+
+    const int digits = Formatter::precision_digits(m_precision);
+
+    write_double(p->momentum().px(),digits);
+    write_double(p->momentum().py(),digits);
+    write_double(p->momentum().pz(),digits);
+    write_double(p->momentum().e(), digits);
+    write_double(p->generated_mass(),digits);
     m_cursor += sprintf(m_cursor," %i\n", p->status() );
     flush();
 }
@@ -343,26 +396,232 @@ inline void WriterAscii::write_string( const string &str ) {
         m_cursor += str.length();
         flush();
     }
+    // In asynchronous mode the stream is written by the background
+    // thread, so the string is passed to it in buffers
+    else if ( m_async ) {
+        const char   *data = str.data();
+        unsigned long left = str.length();
+
+        while ( left > 0 ) {
+            unsigned long n = std::min( left, m_buffer_size - (m_cursor-m_buffer) );
+            memcpy( m_cursor, data, n );
+            m_cursor += n;
+            data     += n;
+            left     -= n;
+            if ( m_cursor == m_buffer + m_buffer_size ) queue_buffer();
+        }
+        flush();
+    }
     // If not, flush the buffer and write the string directly
     else {
         forced_flush();
         // m_file.write( str.data(), str.length() );
         m_stream->write( str.data(), str.length() );
+        m_bytes_written += str.length();
+    }
+}
+
+
+void WriterAscii::set_reorder_policy(GenEvent::ReorderPolicy policy) {
+    if ( policy == GenEvent::BY_STATUS ) {
+        WARNING( "WriterAscii::set_reorder_policy: particles cannot be written grouped by status. Order not changed" )
+        return;
+    }
+
+    m_reorder_policy = policy;
+}
+
+
+bool WriterAscii::set_index_filename(const std::string &filename) {
+    if ( m_start_offset < 0 ) {
+        ERROR( "WriterAscii::set_index_filename: position in output stream is unknown, events cannot be indexed" )
+        return false;
     }
+
+    m_index.clear();
+    m_index.set_format(EventIndex::HEPMC3);
+    m_index_filename = filename;
+    return true;
+}
+
+
+bool WriterAscii::set_parallel_compression(unsigned int threads, size_t block_size) {
+    if ( m_stream != &m_file ) return false;
+    return m_file.set_parallel(threads,block_size);
+}
+
+
+bool WriterAscii::set_block_index_filename(const std::string &filename) {
+    if ( m_stream != &m_file ) return false;
+    return m_file.set_block_index_filename(filename);
+}
+
+
+/// @brief Background thread writing buffers filled by write_event()
+///
+/// Filled buffers are queued in order and written by the thread, after
+/// which they are reused by the writer.
+struct WriterAscii::AsyncOutput {
+
+    /// @brief Filled buffer
+    struct Block {
+        char          *data;   //!< Start of the buffer
+        unsigned long  length; //!< Number of bytes to write
+    };
+
+    AsyncOutput(): queue_depth(0), stop(false), failed(false) {}
+
+    ~AsyncOutput() {
+        FOREACH( char *buffer, free_buffers ) delete[] buffer;
+    }
+
+    std::thread             thread;       //!< Background thread
+    unsigned int            queue_depth;  //!< Maximum number of blocks in the queue
+
+    std::mutex              mutex;        //!< Guards all members but the thread
+    std::condition_variable block_ready;  //!< Signals new blocks and stop to the thread
+    std::condition_variable block_done;   //!< Signals written blocks to the writer
+    std::deque<Block>       queue;        //!< Blocks not written yet, the first one is being written
+    std::vector<char*>      free_buffers; //!< Written buffers for reuse
+    bool                    stop;         //!< Should the thread stop?
+    bool                    failed;       //!< Has writing the stream failed?
+};
+
+
+void WriterAscii::set_async(unsigned int queue_depth) {
+    if ( queue_depth == 0 ) {
+        stop_async();
+        return;
+    }
+
+    if ( m_async ) {
+        std::lock_guard<std::mutex> lock( m_async->mutex );
+        m_async->queue_depth = queue_depth;
+        return;
+    }
+
+    allocate_buffer();
+    if ( !m_buffer ) return;
+
+    bool failed_before = failed();
+
+    m_async = new AsyncOutput();
+    m_async->queue_depth = queue_depth;
+    m_async->failed      = failed_before;
+    m_async->thread      = std::thread( &WriterAscii::run_async, this );
+}
+
+
+unsigned int WriterAscii::async_queue_depth() const {
+    if ( !m_async ) return 0;
+
+    std::lock_guard<std::mutex> lock( m_async->mutex );
+    return m_async->queue_depth;
+}
+
+
+bool WriterAscii::failed() {
+    if ( m_async ) {
+        std::lock_guard<std::mutex> lock( m_async->mutex );
+        return m_async->failed;
+    }
+
+    return (bool)m_file.rdstate();
+}
+
+
+void WriterAscii::queue_buffer() {
+    AsyncOutput::Block block = { m_buffer, (unsigned long)(m_cursor - m_buffer) };
+    if ( block.length == 0 ) return;
+
+    {
+        std::unique_lock<std::mutex> lock( m_async->mutex );
+        while ( m_async->queue.size() >= m_async->queue_depth ) m_async->block_done.wait(lock);
+
+        m_async->queue.push_back(block);
+
+        if ( m_async->free_buffers.empty() ) m_buffer = NULL;
+        else {
+            m_buffer = m_async->free_buffers.back();
+            m_async->free_buffers.pop_back();
+        }
+    }
+    m_async->block_ready.notify_one();
+
+    // At most queue_depth+1 buffers are allocated
+    if ( !m_buffer ) m_buffer = new char[ m_buffer_size ];
+
+    m_bytes_written += block.length;
+    m_cursor = m_buffer;
+}
+
+
+void WriterAscii::run_async() {
+    AsyncOutput &async = *m_async;
+    std::unique_lock<std::mutex> lock( async.mutex );
+
+    while ( true ) {
+        while ( !async.stop && async.queue.empty() ) async.block_ready.wait(lock);
+
+        // Blocks queued before stopping are written
+        if ( async.queue.empty() ) return;
+
+        AsyncOutput::Block block = async.queue.front();
+
+        lock.unlock();
+        m_stream->write( block.data, block.length );
+        bool failed = !(*m_stream);
+        lock.lock();
+
+        if ( failed ) async.failed = true;
+
+        async.queue.pop_front();
+        async.free_buffers.push_back(block.data);
+        async.block_done.notify_one();
+    }
+}
+
+
+void WriterAscii::stop_async() {
+    if ( !m_async ) return;
+
+    {
+        std::lock_guard<std::mutex> lock( m_async->mutex );
+        m_async->stop = true;
+    }
+    m_async->block_ready.notify_all();
+    m_async->thread.join();
+
+    // Keep reporting errors of the background thread, also for streams given to the constructor
+    if ( m_async->failed ) m_file.setstate(std::ios_base::badbit);
+
+    delete m_async;
+    m_async = NULL;
 }
 
 
 void WriterAscii::close() {
+  // Buffers queued for the background thread precede the end of the listing
+  stop_async();
+
   std::ofstream* ofs = dynamic_cast<std::ofstream*>(m_stream);
   // if ( !m_file.is_open() ) return;
   if (ofs && !ofs->is_open()) return;
+  if (m_stream == &m_file && !m_file.is_open()) return;
 
   forced_flush();
   // m_file << "HepMC::IO_GenEvent-END_EVENT_LISTING" << endl << endl;
   (*m_stream) << "HepMC::IO_GenEvent-END_EVENT_LISTING" << endl << endl;
 
+  if ( !m_index_filename.empty() ) {
+      m_index.set_file_size( m_stream->tellp() );
+      m_index.write(m_index_filename);
+      m_index_filename.clear();
+  }
+
   // m_file.close();
   if (ofs) ofs->close();
+  if (m_stream == &m_file) m_file.close();
 }
 
 
@@ -14,19 +14,21 @@
 #include "HepMC/GenParticle.h"
 #include "HepMC/GenVertex.h"
 #include "HepMC/Units.h"
+#include "HepMC/Formatter.h"
 #include <cstring>
 
 namespace HepMC
 {
 
 
-WriterAsciiHepMC2::WriterAsciiHepMC2(const std::string &filename, shared_ptr<GenRunInfo> run)
-    : m_file(filename),
+WriterAsciiHepMC2::WriterAsciiHepMC2(const std::string &filename, shared_ptr<GenRunInfo> run, const std::string &codec)
+    : m_file(filename,codec),
       m_stream(&m_file),
       m_precision(16),
       m_buffer(NULL),
       m_cursor(NULL),
-      m_buffer_size( 256*1024 )
+      m_buffer_size( 256*1024 ),
+      m_use_barcodes(false)
 {
     WARNING( "WriterAsciiHepMC2::WriterAsciiHepMC2: HepMC2 format is outdated. Please use HepMC3 format instead." )
     set_run_info(run);
@@ -48,7 +50,8 @@ WriterAsciiHepMC2::WriterAsciiHepMC2(std::ostream &stream, shared_ptr<GenRunInfo
       m_precision(16),
       m_buffer(NULL),
       m_cursor(NULL),
-      m_buffer_size( 256*1024 )
+      m_buffer_size( 256*1024 ),
+      m_use_barcodes(false)
 {
     WARNING( "WriterAsciiHepMC2::WriterAsciiHepMC2: HepMC2 format is outdated. Please use HepMC3 format instead." )
     set_run_info(run);
@@ -103,9 +106,16 @@ void WriterAsciiHepMC2::write_event(const GenEvent &evt)
 
     std::vector<long> m_random_states;
 
+    // Keep original barcodes only if all particles and vertices have one,
+    // otherwise generated barcodes could collide with them
+    m_use_barcodes = evt.has_barcodes();
+    FOREACH ( const GenParticlePtr &p, evt.particles() ) if ( !m_use_barcodes || !evt.barcode(p) ) { m_use_barcodes = false; break; }
+    FOREACH ( const GenVertexPtr   &v, evt.vertices()  ) if ( !m_use_barcodes || !evt.barcode(v) ) { m_use_barcodes = false; break; }
+
     // Write event info
     //Find beam particles
     std::vector<int> beams;
+    std::vector<GenParticlePtr> beam_particles;
     int idbeam=0;
     FOREACH ( const GenVertexPtr &v, evt.vertices() )
     {
@@ -113,22 +123,29 @@ void WriterAsciiHepMC2::write_event(const GenEvent &evt)
         production_vertex=v->id();
         FOREACH ( const GenParticlePtr &p, v->particles_in())
         {
-            if (p->production_vertex()==NULL)         { if (p->status()==4) beams.push_back(idbeam); idbeam++;}
-            else if (p->production_vertex()->id()==0) { if (p->status()==4) beams.push_back(idbeam); idbeam++;}
+            if (p->production_vertex()==NULL)         { if (p->status()==4) { beams.push_back(idbeam); beam_particles.push_back(p); } idbeam++;}
+            else if (p->production_vertex()->id()==0) { if (p->status()==4) { beams.push_back(idbeam); beam_particles.push_back(p); } idbeam++;}
         }
-        FOREACH ( const GenParticlePtr &p, v->particles_out()) { if (p->status()==4) beams.push_back(idbeam); idbeam++;}
+        FOREACH ( const GenParticlePtr &p, v->particles_out()) { if (p->status()==4) { beams.push_back(idbeam); beam_particles.push_back(p); } idbeam++;}
     }
     //
     int idbeam1=10000;
     int idbeam2=10000;
     if (beams.size()>0) idbeam1+=beams[0]+1;
     if (beams.size()>1) idbeam2+=beams[1]+1;
-    m_cursor += sprintf(m_cursor, "E %d %d %e %e %e %d %d %lu %i %i",
-                        evt.event_number(),
-                        mpi,
-                        event_scale,
-                        alphaQCD,
-                        alphaQED,
+    // Particles are written with their original barcodes, so are the beams
+    if ( m_use_barcodes ) {
+        if (beam_particles.size()>0) idbeam1=evt.barcode(beam_particles[0]);
+        if (beam_particles.size()>1) idbeam2=evt.barcode(beam_particles[1]);
+    }
+    const int digits = Formatter::precision_digits(m_precision);
+
+    m_cursor += sprintf(m_cursor, "E %d %d", evt.event_number(), mpi);
+    flush();
+    write_double(event_scale,digits);
+    write_double(alphaQCD,digits);
+    write_double(alphaQED,digits);
+    m_cursor += sprintf(m_cursor, " %d %d %lu %i %i",
                         signal_process_id,
                         signal_process_vertex,
                         evt.vertices().size(),
@@ -146,7 +163,7 @@ void WriterAsciiHepMC2::write_event(const GenEvent &evt)
         {
             m_cursor += sprintf(m_cursor, " %lu",evt.weights().size());
             FOREACH (double w, evt.weights())
-            m_cursor += sprintf(m_cursor, " %.*e",m_precision, w);
+            write_double(w,digits);
             m_cursor += sprintf(m_cursor, "\n");
             flush();
         }
@@ -165,7 +182,13 @@ void WriterAsciiHepMC2::write_event(const GenEvent &evt)
     m_cursor += sprintf(m_cursor, "U %s %s\n", Units::name(evt.momentum_unit()).c_str(), Units::name(evt.length_unit()).c_str());
     flush();
     shared_ptr<GenCrossSection> cs = evt.attribute<GenCrossSection>("GenCrossSection");
-    if(cs) {m_cursor += sprintf(m_cursor, "C %.*e %.*e\n",m_precision, cs->cross_section,m_precision,cs->cross_section_error);  flush(); }
+    if(cs) {
+        m_cursor += sprintf(m_cursor, "C");
+        write_double(cs->cross_section,digits);
+        write_double(cs->cross_section_error,digits);
+        m_cursor += sprintf(m_cursor, "\n");
+        flush();
+    }
 
 
     // Write attributes
@@ -266,7 +289,7 @@ string WriterAsciiHepMC2::escape(const string s)
 
 void WriterAsciiHepMC2::write_vertex(const GenVertexPtr &v)
 {
-    m_cursor += sprintf( m_cursor, "V %i %i",v->id(),v->status() );
+    m_cursor += sprintf( m_cursor, "V %i %i",vertex_barcode(v),v->status() );
     flush();
     int orph=0;
     FOREACH ( const GenParticlePtr &p, v->particles_in())
@@ -284,20 +307,25 @@ void WriterAsciiHepMC2::write_vertex(const GenVertexPtr &v)
     }
     else
     {
-    m_cursor += sprintf(m_cursor," %.*e",m_precision,pos.x());
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e",   m_precision,pos.y());
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e",   m_precision,pos.z());
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,pos.t());
-    flush();
+    const int digits = Formatter::precision_digits(m_precision);
+    write_double(pos.x(),digits);
+    write_double(pos.y(),digits);
+    write_double(pos.z(),digits);
+    write_double(pos.t(),digits);
     }
     m_cursor += sprintf(m_cursor," %i %i %i\n",orph,v->particles_out().size(),0);
     flush();
 }
 
 
+int WriterAsciiHepMC2::vertex_barcode(const GenVertexPtr &v)
+{
+    if ( !m_use_barcodes || v->parent_event() == NULL ) return v->id();
+    int barcode = v->parent_event()->barcode(v);
+    return barcode ? barcode : v->id();
+}
+
+
 inline void WriterAsciiHepMC2::flush()
 {
     // The maximum size of single add to the buffer (other than by
@@ -312,6 +340,14 @@ inline void WriterAsciiHepMC2::flush()
 }
 
 
+inline void WriterAsciiHepMC2::write_double(double value, int digits)
+{
+    *m_cursor++ = ' ';
+    m_cursor += Formatter::format_double(m_cursor, value, digits);
+    flush();
+}
+
+
 inline void WriterAsciiHepMC2::forced_flush()
 {
     // m_file.write( m_buffer, m_cursor-m_buffer );
@@ -360,34 +396,32 @@ void WriterAsciiHepMC2::write_run_info()
 void WriterAsciiHepMC2::write_particle(const GenParticlePtr &p, int second_field)
 {
 
-    m_cursor += sprintf(m_cursor,"P %i",10001+m_particle_counter);
+    // Keep original barcode if all particles and vertices have one
+    int barcode = ( m_use_barcodes && p->parent_event() ) ? p->parent_event()->barcode(p) : 0;
+    if( !barcode ) barcode = 10001+m_particle_counter;
+
+    m_cursor += sprintf(m_cursor,"P %i",barcode);
     m_particle_counter++;
     flush();
     m_cursor += sprintf(m_cursor," %i",   p->pid() );
     flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().px() );
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().py());
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().pz() );
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->momentum().e() );
-    flush();
-    m_cursor += sprintf(m_cursor," %.*e", m_precision,p->generated_mass() );
-    flush();
+    const int digits = Formatter::precision_digits(m_precision);
+    write_double(p->momentum().px(),digits);
+    write_double(p->momentum().py(),digits);
+    write_double(p->momentum().pz(),digits);
+    write_double(p->momentum().e(), digits);
+    write_double(p->generated_mass(),digits);
     m_cursor += sprintf(m_cursor," %i", p->status() );
     flush();
     int ev=0;
     if (p->end_vertex())
         if (p->end_vertex()->id()!=0)
-            ev=p->end_vertex()->id();
+            ev=vertex_barcode(p->end_vertex());
 
     shared_ptr<DoubleAttribute> A_theta=p->attribute<DoubleAttribute>("theta");
     shared_ptr<DoubleAttribute> A_phi=p->attribute<DoubleAttribute>("phi");
-    if (A_theta) m_cursor += sprintf(m_cursor," %.*e", m_precision, A_theta->value()); else m_cursor += sprintf(m_cursor," 0");
-    flush();
-    if (A_phi) m_cursor += sprintf(m_cursor," %.*e", m_precision, A_phi->value()); else m_cursor += sprintf(m_cursor," 0");
-    flush();
+    if (A_theta) write_double(A_theta->value(),digits); else { m_cursor += sprintf(m_cursor," 0"); flush(); }
+    if (A_phi) write_double(A_phi->value(),digits); else { m_cursor += sprintf(m_cursor," 0"); flush(); }
     m_cursor += sprintf(m_cursor," %i", ev );
     flush();
 
@@ -429,9 +463,11 @@ void WriterAsciiHepMC2::close()
 {
     std::ofstream* ofs = dynamic_cast<std::ofstream*>(m_stream);
     if (ofs && !ofs->is_open()) return;
+    if (m_stream == &m_file && !m_file.is_open()) return;
     forced_flush();
     (*m_stream) << "HepMC::IO_GenEvent-END_EVENT_LISTING" << endl << endl;
     if (ofs) ofs->close();
+    if (m_stream == &m_file) m_file.close();
 }
 
 } // namespace HepMC
@@ -0,0 +1,45 @@
+// -*- C++ -*-
+//
+// This file is part of HepMC
+// Copyright (C) 2014-2015 The HepMC collaboration (see AUTHORS for details)
+//
+///
+/// @file WriterSlimmer.cc
+/// @brief Implementation of \b class WriterSlimmer
+///
+#include "HepMC/WriterSlimmer.h"
+
+namespace HepMC {
+
+
+WriterSlimmer::WriterSlimmer(shared_ptr<Writer> output, const EventSlimmer &slimmer, shared_ptr<GenRunInfo> run)
+    : m_output(output),
+      m_slimmer(slimmer)
+{
+    set_run_info(run);
+    if ( !m_output ) {
+        ERROR( "WriterSlimmer: no output writer" )
+    }
+}
+
+
+void WriterSlimmer::write_event(const GenEvent &evt) {
+    if ( !m_output ) return;
+
+    m_slimmer.slim( evt, m_event );
+    if ( run_info() ) m_event.set_run_info( run_info() );
+
+    m_output->write_event( m_event );
+}
+
+
+bool WriterSlimmer::failed() {
+    return !m_output || m_output->failed();
+}
+
+
+void WriterSlimmer::close() {
+    if ( m_output ) m_output->close();
+}
+
+} // namespace HepMC